@@ -6,18 +6,25 @@
  */
 
 
+#include <new>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
 #include <cassert>
+#include <algorithm>
 #include <omp.h>
 //own classes
 #include <math/ANRandom.h>
 #include <math/ANFunctions.h>
 #include <containers/ANTrainingSet.h>
+#include <containers/ANStreamingSet.h>
 #include <containers/ANConTable.h>
 #include <basic/ANEdge.h>
 #include <basic/ANAbsNeuron.h>
 #include <basic/ANAbsNet.h>
+#include <ANBPNeuron.h>
 #include <ANBPLayer.h>
+#include <ANBPEngine.h>
 
 using namespace ANN;
 
@@ -27,8 +34,10 @@ AbsNet::AbsNet() //: Importer(this),  Exporter(this)
 	m_fLearningRate = 0.0f;
 	m_fMomentum 	= 0.f;
 	m_fWeightDecay 	= 0.f;
+	m_iBatchSize 	= 1;
 	m_pTransfFunction 	= NULL;
 	m_pTrainingData = NULL;
+	m_pTrainingStream = NULL;
 
 	m_pIPLayer 		= NULL;
 	m_pOPLayer 		= NULL;
@@ -54,15 +63,6 @@ void AbsNet::CreateNet(const ConTable &Net) {
 	unsigned int iNmbLayers 	= Net.NrOfLayers;	// zahl der Layer im Netz
 	unsigned int iNmbNeurons	= 0;
 
-	unsigned int iDstNeurID 	= 0;
-	unsigned int iSrcNeurID 	= 0;
-	unsigned int iDstLayerID 	= 0;
-	unsigned int iSrcLayerID 	= 0;
-
-	float fEdgeValue			= 0.f;
-
-	AbsLayer *pDstLayer 		= NULL;
-	AbsLayer *pSrcLayer 		= NULL;
 	AbsNeuron *pDstNeur 		= NULL;
 	AbsNeuron *pSrcNeur 		= NULL;
 
@@ -103,41 +103,98 @@ void AbsNet::CreateNet(const ConTable &Net) {
 	 * Basic information for ~all networks
 	 */
 	std::cout<<"Adding edges ";
-	for(unsigned int i = 0; i < Net.NeurCons.size(); i++) {
-		/*
-		 * Read settings
-		 */
-		iDstNeurID 	= Net.NeurCons.at(i).m_iDstNeurID;
-		iSrcNeurID 	= Net.NeurCons.at(i).m_iSrcNeurID;
-		iDstLayerID = Net.NeurCons.at(i).m_iDstLayerID;
-		iSrcLayerID = Net.NeurCons.at(i).m_iSrcLayerID;
+	int iNmbCons = static_cast<int>(Net.NeurCons.size() );
+
+	/*
+	 * Index the neurons of every layer by their ID once: vNeurons[layer][neuron ID]
+	 * Same result like AbsLayer::GetNeuron():
+	 * the neuron at position ID if it has this ID, otherwise the first one with this ID
+	 */
+	std::vector<std::vector<AbsNeuron*> > vNeurons(m_lLayers.size() );
+	std::vector<unsigned int> vOffsets(m_lLayers.size()+1, 0);	// position of the first neuron of a layer in vNrConsI/vNrConsO
+	for(unsigned int i = 0; i < m_lLayers.size(); i++) {
+		const std::vector<AbsNeuron*> &vLayer = m_lLayers[i]->GetNeurons();
+		std::vector<AbsNeuron*> &vIndex = vNeurons[i];
+		for(int j = static_cast<int>(vLayer.size() )-1; j >= 0; j--) {
+			unsigned int iID = vLayer[j]->GetID();
+			if(iID >= vIndex.size() ) {
+				vIndex.resize(iID+1, NULL);
+			}
+			vIndex[iID] = vLayer[j];
+		}
+		for(unsigned int j = 0; j < vLayer.size(); j++) {
+			if(vLayer[j]->GetID() == j) {
+				vIndex[j] = vLayer[j];
+			}
+		}
+		vOffsets[i+1] = vOffsets[i] + vIndex.size();
+	}
+
+	/*
+	 * Group the connections by neuron:
+	 * count the edges of every neuron and remember the position of each connection in the edge lists.
+	 * The lists get filled in the order of the table, like adding the edges one by one.
+	 */
+	std::vector<unsigned int> vNrConsO(vOffsets.back(), 0);
+	std::vector<unsigned int> vNrConsI(vOffsets.back(), 0);
+	std::vector<unsigned int> vSlotsO(iNmbCons);
+	std::vector<unsigned int> vSlotsI(iNmbCons);
+	for(int i = 0; i < iNmbCons; i++) {
+		const ConDescr &Con = Net.NeurCons[i];
 
 		/*
 		 * Check whether all settings are usable
 		 */
-		assert(iDstNeurID 	>= 0);
-		assert(iSrcNeurID 	>= 0);
-		assert(iDstLayerID 	>= 0);
-		assert(iSrcLayerID 	>= 0);
-		assert(i < Net.NeurCons.size());
+		assert(Con.m_iSrcLayerID >= 0 && Con.m_iSrcLayerID < static_cast<int>(vNeurons.size() ) );
+		assert(Con.m_iDstLayerID >= 0 && Con.m_iDstLayerID < static_cast<int>(vNeurons.size() ) );
+		assert(Con.m_iSrcNeurID >= 0 && Con.m_iSrcNeurID < static_cast<int>(vNeurons[Con.m_iSrcLayerID].size() ) );
+		assert(Con.m_iDstNeurID >= 0 && Con.m_iDstNeurID < static_cast<int>(vNeurons[Con.m_iDstLayerID].size() ) );
 
-		/*
-		 * Create edges and register in neurons
-		 */
-		fEdgeValue 	= Net.NeurCons.at(i).m_fVal;
-		pDstLayer 	= GetLayer(iDstLayerID);
-		pSrcLayer 	= GetLayer(iSrcLayerID);
-		pDstNeur 	= pDstLayer->GetNeuron(iDstNeurID);
-		pSrcNeur 	= pSrcLayer->GetNeuron(iSrcNeurID);
+		pSrcNeur 	= vNeurons[Con.m_iSrcLayerID][Con.m_iSrcNeurID];
+		pDstNeur 	= vNeurons[Con.m_iDstLayerID][Con.m_iDstNeurID];
 
 		// Check for NULL pointers
-		assert(pDstLayer 	!= NULL);
-		assert(pSrcLayer 	!= NULL);
-		assert(pDstNeur 	!= NULL);
-		assert(pSrcNeur 	!= NULL);
+		assert(pSrcNeur != NULL);
+		assert(pDstNeur != NULL);
 
-		//Connect neurons with edge
-		Connect(pSrcNeur, pDstNeur, fEdgeValue, 0.f, true);
+		vSlotsO[i] = pSrcNeur->GetConsO().size() + vNrConsO[vOffsets[Con.m_iSrcLayerID] + Con.m_iSrcNeurID]++;
+		vSlotsI[i] = pDstNeur->GetConsI().size() + vNrConsI[vOffsets[Con.m_iDstLayerID] + Con.m_iDstNeurID]++;
+	}
+
+	/*
+	 * Pre-size the edge lists
+	 */
+	for(unsigned int i = 0; i < vNeurons.size(); i++) {
+		#pragma omp parallel for
+		for(int j = 0; j < static_cast<int>(vNeurons[i].size() ); j++) {
+			AbsNeuron *pNeuron = vNeurons[i][j];
+			unsigned int iID = vOffsets[i] + j;
+			if(pNeuron == NULL) {
+				continue;
+			}
+			if(vNrConsO[iID] > 0) {
+				pNeuron->ResizeConsO(pNeuron->GetConsO().size() + vNrConsO[iID]);
+			}
+			if(vNrConsI[iID] > 0) {
+				pNeuron->ResizeConsI(pNeuron->GetConsI().size() + vNrConsI[iID]);
+			}
+		}
+	}
+
+	/*
+	 * Create edges in one block and register in neurons;
+	 * every connection writes to its own positions of the lists
+	 */
+	Edge *pEdges = m_EdgeArena.Alloc(iNmbCons);
+	#pragma omp parallel for
+	for(int i = 0; i < iNmbCons; i++) {
+		const ConDescr &Con = Net.NeurCons[i];
+		AbsNeuron *pSrc = vNeurons[Con.m_iSrcLayerID][Con.m_iSrcNeurID];
+		AbsNeuron *pDst = vNeurons[Con.m_iDstLayerID][Con.m_iDstNeurID];
+
+		Edge *pEdge = new(&pEdges[i]) Edge(pSrc, pDst, Con.m_fVal, 0.f, true);
+		pSrc->SetConO(pEdge, vSlotsO[i]);
+		pDst->SetConI(pEdge, vSlotsI[i]);
 	}
 	std::cout<<".. finished!"<<std::endl;
 }
@@ -165,12 +222,14 @@ void AbsNet::EraseAll() {
 		m_lLayers.at(i)->EraseAll();
 	}
 	m_lLayers.clear();
+	// no neuron points to the edges anymore
+	m_EdgeArena.Release();
 }
 
 std::vector<float> AbsNet::TrainFromData(const unsigned int &iCycles, const float &fTolerance, const bool &bBreak, float &fProgress) {
 	std::vector<float> pErrors;
 
-	if(m_pTrainingData == NULL)
+	if(m_pTrainingData == NULL && m_pTrainingStream == NULL)
 		return pErrors;
 
 	float fCurError 	= 0.f;
@@ -202,16 +261,53 @@ std::vector<float> AbsNet::TrainFromData(const unsigned int &iCycles, const floa
 		 * Save current error in a std::vector
 		 */
 		fCurError 	= 0.f;
-		for( unsigned int i = 0; i < m_pTrainingData->GetNrElements(); i++ ) {
-			SetInput( m_pTrainingData->GetInput(i) );
-			fCurError += SetOutput( m_pTrainingData->GetOutput(i) );
-			PropagateBW();
+		if(m_pTrainingStream != NULL) {
+			// every chunk is trained like a small training set, the next one gets read meanwhile
+			TrainingSet *pData = m_pTrainingData;
+			m_pTrainingStream->Rewind();
+			while( (m_pTrainingData = m_pTrainingStream->NextChunk() ) != NULL ) {
+				fCurError += TrainSamples();
+			}
+			m_pTrainingData = pData;
+		}
+		else {
+			fCurError = TrainSamples();
 		}
 		pErrors.push_back(fCurError);
 	}
 	return pErrors;
 }
 
+float AbsNet::TrainSamples() {
+	float fError = 0.f;
+	for( unsigned int i = 0; i < m_pTrainingData->GetNrElements(); i += m_iBatchSize ) {
+		unsigned int iSize = std::min(m_iBatchSize, m_pTrainingData->GetNrElements()-i);
+		fError += TrainBatch(i, iSize);
+	}
+	return fError;
+}
+
+float AbsNet::TrainBatch(const unsigned int &iStart, const unsigned int &iSize) {
+	float fError = 0.f;
+	for( unsigned int i = iStart; i < iStart+iSize; i++ ) {
+		const SampleView Input 	= m_pTrainingData->GetInput(i);
+		const SampleView Output = m_pTrainingData->GetOutput(i);
+		SetInput( Input.GetData(), Input.size() );
+		fError += SetOutput( Output.GetData(), Output.size() );
+		PropagateBW();
+	}
+	return fError;
+}
+
+void AbsNet::SetBatchSize(const unsigned int &iSize) {
+	assert( iSize > 0 );
+	m_iBatchSize = iSize;
+}
+
+unsigned int AbsNet::GetBatchSize() const {
+	return m_iBatchSize;
+}
+
 void AbsNet::AddLayer(AbsLayer *pLayer) {
 	m_lLayers.push_back(pLayer);
 	pLayer->SetID( m_lLayers.size()-1 );
@@ -221,6 +317,10 @@ std::vector<AbsLayer*> AbsNet::GetLayers() const {
 	return m_lLayers;
 }
 
+EdgeArena *AbsNet::GetEdgeArena() {
+	return &m_EdgeArena;
+}
+
 AbsLayer* AbsNet::GetLayer(const unsigned int &iID) const {
 	assert( m_lLayers.at(iID) != NULL );
 	assert( iID >= 0 );
@@ -230,8 +330,12 @@ AbsLayer* AbsNet::GetLayer(const unsigned int &iID) const {
 }
 
 void AbsNet::SetInput(const std::vector<float> &inputArray) {
+	SetInput(inputArray.empty() ? NULL : &inputArray[0], inputArray.size() );
+}
+
+void AbsNet::SetInput(const float *inputArray, const unsigned int &size) {
 	assert( m_pIPLayer != NULL );
-	assert( inputArray.size() <= m_pIPLayer->GetNeurons().size() );
+	assert( size <= m_pIPLayer->GetNeurons().size() );
 
 	AbsNeuron *pCurNeuron;
 	for(int i = 0; i < static_cast<int>( m_pIPLayer->GetNeurons().size() ); i++) {
@@ -252,7 +356,7 @@ void AbsNet::SetInput(const std::vector<float> &inputArray, const unsigned int &
 	}
 }
 
-void AbsNet::SetInput(float *inputArray, const unsigned int &size, const unsigned int &layerID) {
+void AbsNet::SetInput(const float *inputArray, const unsigned int &size, const unsigned int &layerID) {
 //	assert( m_lLayers[layerID]->GetFlag() & LayerInput );
 	assert( layerID < m_lLayers.size() );
 	assert( size <= m_lLayers[layerID]->GetNeurons().size() );
@@ -265,8 +369,12 @@ void AbsNet::SetInput(float *inputArray, const unsigned int &size, const unsigne
 }
 
 float AbsNet::SetOutput(const std::vector<float> &outputArray) {
+	return SetOutput(outputArray.empty() ? NULL : &outputArray[0], outputArray.size() );
+}
+
+float AbsNet::SetOutput(const float *outputArray, const unsigned int &size) {
 	assert( m_pOPLayer != NULL );
-	assert( outputArray.size() == m_pOPLayer->GetNeurons().size() );
+	assert( size == m_pOPLayer->GetNeurons().size() );
 
 	PropagateFW();
 
@@ -301,7 +409,7 @@ float AbsNet::SetOutput(const std::vector<float> &outputArray, const unsigned in
 	return fError;
 }
 
-float AbsNet::SetOutput(float *outputArray, const unsigned int &size, const unsigned int &layerID) {
+float AbsNet::SetOutput(const float *outputArray, const unsigned int &size, const unsigned int &layerID) {
 	assert( layerID < m_lLayers.size() );
 	assert( size == m_lLayers[layerID]->GetNeurons().size() );
 
@@ -339,6 +447,16 @@ TrainingSet *AbsNet::GetTrainingSet() const {
 	return m_pTrainingData;
 }
 
+void AbsNet::SetTrainingStream(StreamingSet *pStream) {
+	assert(pStream == NULL || pStream->IsOpen() );
+
+	m_pTrainingStream = pStream;
+}
+
+StreamingSet *AbsNet::GetTrainingStream() const {
+	return m_pTrainingStream;
+}
+
 const AbsLayer *AbsNet::GetIPLayer() const {
 	assert(m_pIPLayer);
 
@@ -377,6 +495,26 @@ std::vector<float> AbsNet::GetOutput() {
 	return vResult;
 }
 
+void AbsNet::PredictBatch(const float *pInput, float *pOutput, const unsigned int &iSamples) {
+	assert( m_pIPLayer != NULL );
+	assert( m_pOPLayer != NULL );
+
+	const std::vector<AbsNeuron *> &vInput 	= m_pIPLayer->GetNeurons();
+	const std::vector<AbsNeuron *> &vOutput = m_pOPLayer->GetNeurons();
+	unsigned int iInput 	= vInput.size();
+	unsigned int iOutput 	= vOutput.size();
+
+	for(unsigned int i = 0; i < iSamples; i++) {
+		for(unsigned int j = 0; j < iInput; j++) {
+			vInput[j]->SetValue(pInput[i*iInput+j]);
+		}
+		PropagateFW();
+		for(unsigned int j = 0; j < iOutput; j++) {
+			pOutput[i*iOutput+j] = vOutput[j]->GetValue();
+		}
+	}
+}
+
 void AbsNet::SetTransfFunction(const TransfFunction *pFunction) {
 	assert( pFunction != 0 );
 
@@ -390,7 +528,12 @@ const TransfFunction *AbsNet::GetTransfFunction() const {
 	return m_pTransfFunction;
 }
 
-void AbsNet::ExpToFS(std::string path) {
+void AbsNet::ExpToFS(std::string path, const FileFormatFlag &fFormat) {
+	if(fFormat & ANFormatRaw) {
+		ExpToRawFS(path);
+		return;
+	}
+
 	int iBZ2Error;
 	NetTypeFlag fNetType 		= GetFlag();
 	unsigned int iNmbOfLayers 	= GetLayers().size();
@@ -423,6 +566,16 @@ void AbsNet::ExpToFS(std::string path) {
 }
 
 void AbsNet::ImpFromFS(std::string path) {
+	if(NetFile::IsRawFile(path) ) {
+		NetFile File;
+		if(!File.Open(path) ) {
+			std::cout<<"return: "<<"LoadNetwork(): corrupt raw file"<<std::endl;
+			return;
+		}
+		ImpFromRawFS(File);
+		return;
+	}
+
 	int iBZ2Error;
 	ConTable Table;
 	NetTypeFlag fNetType 		= 0;
@@ -462,6 +615,284 @@ void AbsNet::ImpFromFS(std::string path) {
 	fclose(fin);
 }
 
+/*
+ * Pads the file with zeros up to iOffset and writes iBytes of pData.
+ */
+static void WriteRaw(FILE *fout, uint64_t &iPos, const uint64_t &iOffset, const void *pData, const uint64_t &iBytes) {
+	static const char cZeros[ANRAW_ALIGN] = {0};
+	assert(iOffset >= iPos);
+	while(iPos < iOffset) {
+		uint64_t iPad = std::min<uint64_t>(iOffset - iPos, ANRAW_ALIGN);
+		fwrite(cZeros, 1, iPad, fout);
+		iPos += iPad;
+	}
+	if(iBytes > 0) {
+		fwrite(pData, 1, iBytes, fout);
+		iPos += iBytes;
+	}
+}
+
+template <class Type>
+static void WriteRaw(FILE *fout, uint64_t &iPos, const uint64_t &iOffset, const std::vector<Type> &vData) {
+	WriteRaw(fout, iPos, iOffset, vData.empty() ? NULL : &vData[0], sizeof(Type) * vData.size() );
+}
+
+/*
+ * Reserves iBytes at the end of the file layout and returns their (aligned) offset.
+ */
+static uint64_t Reserve(uint64_t &iEnd, const uint64_t &iBytes) {
+	uint64_t iOffset = (iEnd + ANRAW_ALIGN-1) / ANRAW_ALIGN * ANRAW_ALIGN;
+	iEnd = iOffset + iBytes;
+	return iOffset;
+}
+
+void AbsNet::ExpToRawFS(std::string path) {
+	unsigned int iNmbOfLayers = m_lLayers.size();
+
+	FILE *fout = fopen(path.c_str(), "wb");
+	if(fout == NULL) {
+		std::cout<<"return: "<<"SaveNetwork()"<<std::endl;
+		return;
+	}
+	std::cout<<"Save network (raw).."<<std::endl;
+
+	/*
+	 * Layout of the file
+	 */
+	RawNetHeader Header;
+	memset(&Header, 0, sizeof(RawNetHeader) );
+	memcpy(Header.m_cMagic, ANRAW_MAGIC, sizeof(Header.m_cMagic) );
+	Header.m_iVersion 		= ANRAW_VERSION;
+	Header.m_iNetType 		= GetFlag();
+	Header.m_iNrOfLayers 	= iNmbOfLayers;
+
+	uint64_t iEnd 			= sizeof(RawNetHeader);
+	Header.m_iLayerTable 	= Reserve(iEnd, sizeof(RawLayerDescr) * iNmbOfLayers);
+
+	// back propagation nets get the dense blocks of the compiled mode in addition, if the topology allows it
+	BPEngine Dense;
+	bool bDense = (GetFlag() & ANNetBP) && iNmbOfLayers >= 2 && m_pIPLayer == m_lLayers.front() && m_pOPLayer == m_lLayers.back()
+			&& Dense.Compile(m_lLayers);
+
+	std::vector<RawLayerDescr> vDescr(iNmbOfLayers);
+	std::vector<AbsNeuron*> vBias(iNmbOfLayers, NULL);
+	for(unsigned int i = 0; i < iNmbOfLayers; i++) {
+		AbsLayer *pLayer = GetLayer(i);
+		const std::vector<AbsNeuron*> &vNeurons = pLayer->GetNeurons();
+		RawLayerDescr &Descr = vDescr[i];
+		memset(&Descr, 0, sizeof(RawLayerDescr) );
+
+		Descr.m_iID 			= pLayer->GetID();
+		Descr.m_iType 			= pLayer->GetFlag();
+		Descr.m_iNrOfNeurons 	= vNeurons.size();
+		Descr.m_iZLayer 		= -1;
+		if(GetFlag() & ANNetBP) {
+			Descr.m_iZLayer 	= ((BPLayer*)pLayer)->GetZLayer();
+			vBias[i] 			= ((BPLayer*)pLayer)->GetBiasNeuron();
+		}
+		Descr.m_iHasBias 		= vBias[i] != NULL;
+		for(unsigned int j = 0; j < vNeurons.size(); j++) {
+			Descr.m_iNrOfDims 	= std::max<uint32_t>(Descr.m_iNrOfDims, vNeurons[j]->GetPosition().size() );
+			Descr.m_iNrOfEdges += vNeurons[j]->GetConsO().size();
+		}
+		if(vBias[i] != NULL) {
+			Descr.m_iNrOfBiasEdges = vBias[i]->GetConsO().size();
+		}
+
+		uint64_t iNeurons 		= Descr.m_iNrOfNeurons;
+		Descr.m_iNeuronIDs 		= Reserve(iEnd, sizeof(int32_t) * iNeurons);
+		Descr.m_iPositions 		= Reserve(iEnd, sizeof(float) * iNeurons * Descr.m_iNrOfDims);
+		Descr.m_iEdgeOffsets 	= Reserve(iEnd, sizeof(uint64_t) * (iNeurons+1) );
+		Descr.m_iDstLayers 		= Reserve(iEnd, sizeof(int32_t) * Descr.m_iNrOfEdges);
+		Descr.m_iDstNeurons 	= Reserve(iEnd, sizeof(int32_t) * Descr.m_iNrOfEdges);
+		Descr.m_iWeights 		= Reserve(iEnd, sizeof(float) * Descr.m_iNrOfEdges);
+		Descr.m_iBiasDstLayers 	= Reserve(iEnd, sizeof(int32_t) * Descr.m_iNrOfBiasEdges);
+		Descr.m_iBiasDstNeurons = Reserve(iEnd, sizeof(int32_t) * Descr.m_iNrOfBiasEdges);
+		Descr.m_iBiasWeights 	= Reserve(iEnd, sizeof(float) * Descr.m_iNrOfBiasEdges);
+
+		if(bDense && i > 0) {
+			const BPDenseLayer &Layer = Dense.GetLayer(i);
+			Descr.m_iDenseInputs 	= Layer.m_iInputs;
+			Descr.m_iDenseWeights 	= Reserve(iEnd, sizeof(float) * iNeurons * Layer.m_iInputs);
+			Descr.m_iDenseBias 		= Reserve(iEnd, sizeof(float) * iNeurons);
+		}
+	}
+
+	RawTrainingSetDescr Set;
+	memset(&Set, 0, sizeof(RawTrainingSetDescr) );
+	std::vector<uint64_t> vInpOffsets;
+	std::vector<uint64_t> vOutOffsets;
+	if(m_pTrainingData) {
+		Set.m_iNrOfInputs 	= m_pTrainingData->GetNrInputs();
+		Set.m_iNrOfOutputs 	= m_pTrainingData->GetNrOutputs();
+		vInpOffsets.resize(Set.m_iNrOfInputs+1, 0);
+		vOutOffsets.resize(Set.m_iNrOfOutputs+1, 0);
+		for(unsigned int i = 0; i < Set.m_iNrOfInputs; i++) {
+			vInpOffsets[i+1] = vInpOffsets[i] + m_pTrainingData->GetInput(i).size();
+		}
+		for(unsigned int i = 0; i < Set.m_iNrOfOutputs; i++) {
+			vOutOffsets[i+1] = vOutOffsets[i] + m_pTrainingData->GetOutput(i).size();
+		}
+
+		Header.m_iTrainingSet 	= Reserve(iEnd, sizeof(RawTrainingSetDescr) );
+		Set.m_iInputOffsets 	= Reserve(iEnd, sizeof(uint64_t) * vInpOffsets.size() );
+		Set.m_iInputs 			= Reserve(iEnd, sizeof(float) * vInpOffsets.back() );
+		Set.m_iOutputOffsets 	= Reserve(iEnd, sizeof(uint64_t) * vOutOffsets.size() );
+		Set.m_iOutputs 			= Reserve(iEnd, sizeof(float) * vOutOffsets.back() );
+	}
+	Header.m_iFileSize = iEnd;
+
+	/*
+	 * Write the arrays of one layer after another
+	 */
+	uint64_t iPos = 0;
+	WriteRaw(fout, iPos, 0, &Header, sizeof(RawNetHeader) );
+	WriteRaw(fout, iPos, Header.m_iLayerTable, vDescr);
+
+	for(unsigned int i = 0; i < iNmbOfLayers; i++) {
+		const std::vector<AbsNeuron*> &vNeurons = GetLayer(i)->GetNeurons();
+		const RawLayerDescr &Descr = vDescr[i];
+
+		std::vector<int32_t> vIDs(Descr.m_iNrOfNeurons);
+		std::vector<float> vPositions(Descr.m_iNrOfNeurons * Descr.m_iNrOfDims, 0.f);
+		std::vector<uint64_t> vOffsets(Descr.m_iNrOfNeurons+1, 0);
+		std::vector<int32_t> vDstLayers(Descr.m_iNrOfEdges);
+		std::vector<int32_t> vDstNeurons(Descr.m_iNrOfEdges);
+		std::vector<float> vWeights(Descr.m_iNrOfEdges);
+
+		for(unsigned int j = 0; j < vNeurons.size(); j++) {
+			AbsNeuron *pNeuron = vNeurons[j];
+			const std::vector<float> &vPos = pNeuron->GetPosition();
+			const std::vector<Edge*> &vConsO = pNeuron->GetConsO();
+
+			vIDs[j] = pNeuron->GetID();
+			std::copy(vPos.begin(), vPos.end(), vPositions.begin() + j*Descr.m_iNrOfDims);
+			vOffsets[j+1] = vOffsets[j] + vConsO.size();
+			for(unsigned int k = 0; k < vConsO.size(); k++) {
+				AbsNeuron *pDst = vConsO[k]->GetDestination(pNeuron);
+				vDstLayers[vOffsets[j]+k] 	= pDst->GetParent()->GetID();
+				vDstNeurons[vOffsets[j]+k] 	= pDst->GetID();
+				vWeights[vOffsets[j]+k] 	= vConsO[k]->GetValue();
+			}
+		}
+		WriteRaw(fout, iPos, Descr.m_iNeuronIDs, vIDs);
+		WriteRaw(fout, iPos, Descr.m_iPositions, vPositions);
+		WriteRaw(fout, iPos, Descr.m_iEdgeOffsets, vOffsets);
+		WriteRaw(fout, iPos, Descr.m_iDstLayers, vDstLayers);
+		WriteRaw(fout, iPos, Descr.m_iDstNeurons, vDstNeurons);
+		WriteRaw(fout, iPos, Descr.m_iWeights, vWeights);
+
+		std::vector<int32_t> vBiasDstLayers(Descr.m_iNrOfBiasEdges);
+		std::vector<int32_t> vBiasDstNeurons(Descr.m_iNrOfBiasEdges);
+		std::vector<float> vBiasWeights(Descr.m_iNrOfBiasEdges);
+		for(unsigned int k = 0; k < Descr.m_iNrOfBiasEdges; k++) {
+			Edge *pEdge = vBias[i]->GetConsO()[k];
+			AbsNeuron *pDst = pEdge->GetDestination(vBias[i]);
+			vBiasDstLayers[k] 	= pDst->GetParent()->GetID();
+			vBiasDstNeurons[k] 	= pDst->GetID();
+			vBiasWeights[k] 	= pEdge->GetValue();
+		}
+		WriteRaw(fout, iPos, Descr.m_iBiasDstLayers, vBiasDstLayers);
+		WriteRaw(fout, iPos, Descr.m_iBiasDstNeurons, vBiasDstNeurons);
+		WriteRaw(fout, iPos, Descr.m_iBiasWeights, vBiasWeights);
+
+		if(Descr.m_iDenseWeights != 0) {
+			WriteRaw(fout, iPos, Descr.m_iDenseWeights, Dense.GetLayer(i).m_vWeights);
+			WriteRaw(fout, iPos, Descr.m_iDenseBias, Dense.GetLayer(i).m_vBias);
+		}
+	}
+
+	if(m_pTrainingData) {
+		WriteRaw(fout, iPos, Header.m_iTrainingSet, &Set, sizeof(RawTrainingSetDescr) );
+		WriteRaw(fout, iPos, Set.m_iInputOffsets, vInpOffsets);
+		// the samples are stored consecutively, like in the file
+		WriteRaw(fout, iPos, Set.m_iInputs, m_pTrainingData->GetInputBuffer(), sizeof(float) * vInpOffsets.back() );
+		WriteRaw(fout, iPos, Set.m_iOutputOffsets, vOutOffsets);
+		WriteRaw(fout, iPos, Set.m_iOutputs, m_pTrainingData->GetOutputBuffer(), sizeof(float) * vOutOffsets.back() );
+	}
+	WriteRaw(fout, iPos, Header.m_iFileSize, NULL, 0);
+
+	fclose(fout);
+}
+
+void AbsNet::ImpFromRawFS(const NetFile &File, const bool &bEdges, const bool &bTrainingSet) {
+	const RawNetHeader &Header = File.GetHeader();
+	ConTable Table;
+
+	std::cout<<"Load network (raw).."<<std::endl;
+	Table.NetType 		= Header.m_iNetType;
+	Table.NrOfLayers 	= Header.m_iNrOfLayers;
+
+	uint64_t iNmbOfEdges = 0;
+	for(unsigned int i = 0; i < Header.m_iNrOfLayers && bEdges; i++) {
+		iNmbOfEdges += File.GetLayer(i).m_iNrOfEdges;
+	}
+	Table.NeurCons.reserve(iNmbOfEdges);
+
+	for(unsigned int i = 0; i < Header.m_iNrOfLayers; i++) {
+		const RawLayerDescr &Descr 	= File.GetLayer(i);
+		const int32_t *pIDs 		= File.GetNeuronIDs(i);
+		const float *pPositions 	= File.GetPositions(i);
+		const uint64_t *pOffsets 	= File.GetEdgeOffsets(i);
+		const int32_t *pDstLayers 	= File.GetDstLayers(i);
+		const int32_t *pDstNeurons 	= File.GetDstNeurons(i);
+		const float *pWeights 		= File.GetWeights(i);
+
+		Table.TypeOfLayer.push_back(Descr.m_iType);
+		Table.SizeOfLayer.push_back(Descr.m_iNrOfNeurons);
+		Table.ZValOfLayer.push_back(Descr.m_iZLayer);
+
+		for(unsigned int j = 0; j < Descr.m_iNrOfNeurons; j++) {
+			NeurDescr cCurNeur;
+			cCurNeur.m_iLayerID = Descr.m_iID;
+			cCurNeur.m_iNeurID 	= pIDs[j];
+			cCurNeur.m_vPos.assign(pPositions + j*Descr.m_iNrOfDims, pPositions + (j+1)*Descr.m_iNrOfDims);
+			Table.Neurons.push_back(cCurNeur);
+
+			for(uint64_t k = pOffsets[j]; k < pOffsets[j+1] && bEdges; k++) {
+				ConDescr cCurCon;
+				cCurCon.m_fVal 			= pWeights[k];
+				cCurCon.m_iSrcNeurID 	= pIDs[j];
+				cCurCon.m_iDstNeurID 	= pDstNeurons[k];
+				cCurCon.m_iSrcLayerID 	= Descr.m_iID;
+				cCurCon.m_iDstLayerID 	= pDstLayers[k];
+				Table.NeurCons.push_back(cCurCon);
+			}
+		}
+
+		const int32_t *pBiasDstLayers 	= File.GetBiasDstLayers(i);
+		const int32_t *pBiasDstNeurons 	= File.GetBiasDstNeurons(i);
+		const float *pBiasWeights 		= File.GetBiasWeights(i);
+		for(uint64_t k = 0; k < Descr.m_iNrOfBiasEdges && bEdges; k++) {
+			ConDescr cCurCon;
+			cCurCon.m_fVal 			= pBiasWeights[k];
+			cCurCon.m_iSrcNeurID 	= -1;
+			cCurCon.m_iDstNeurID 	= pBiasDstNeurons[k];
+			cCurCon.m_iSrcLayerID 	= Descr.m_iID;
+			cCurCon.m_iDstLayerID 	= pBiasDstLayers[k];
+			Table.BiasCons.push_back(cCurCon);
+		}
+	}
+
+	CreateNet( Table );
+
+	const RawTrainingSetDescr *pSet = File.GetTrainingSet();
+	if(pSet && bTrainingSet) {
+		const uint64_t *pInpOffsets = File.GetArray<uint64_t>(pSet->m_iInputOffsets);
+		const uint64_t *pOutOffsets = File.GetArray<uint64_t>(pSet->m_iOutputOffsets);
+		const float *pInputs 		= File.GetArray<float>(pSet->m_iInputs);
+		const float *pOutputs 		= File.GetArray<float>(pSet->m_iOutputs);
+
+		m_pTrainingData = new ANN::TrainingSet;
+		for(unsigned int i = 0; i < pSet->m_iNrOfInputs; i++) {
+			m_pTrainingData->AddInput(pInputs + pInpOffsets[i], pInpOffsets[i+1] - pInpOffsets[i]);
+		}
+		for(unsigned int i = 0; i < pSet->m_iNrOfOutputs; i++) {
+			m_pTrainingData->AddOutput(pOutputs + pOutOffsets[i], pOutOffsets[i+1] - pOutOffsets[i]);
+		}
+	}
+}
+
 /*
  * AUSGABEOPERATOR
  * OSTREAM
@@ -473,7 +904,8 @@ namespace ANN {
 		/* if training data was set give out all samples */
 		if( op.GetTrainingSet() != NULL ) {
 			for( unsigned int i = 0; i < op.GetTrainingSet()->GetNrElements(); i++ ) {
-				op.SetInput( op.GetTrainingSet()->GetInput(i) );
+				const SampleView Input = op.GetTrainingSet()->GetInput(i);
+				op.SetInput( Input.GetData(), Input.size() );
 				op.PropagateFW();
 
 				for(unsigned int j = 0; j < op.GetOPLayer()->GetNeurons().size(); j++) {
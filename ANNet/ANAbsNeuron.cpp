@@ -5,6 +5,7 @@
  *      Author: dgrat
  */
 
+#include <new>
 #include <iostream>
 #include <stdio.h>
 #include <cassert>
@@ -12,6 +13,7 @@
 #include <math/ANFunctions.h>
 #include <math/ANRandom.h>
 #include <basic/ANEdge.h>
+#include <basic/ANEdgeArena.h>
 #include <basic/ANAbsNeuron.h>
 #include <ANBPLayer.h>
 #include <containers/ANTrainingSet.h>
@@ -47,7 +49,7 @@ AbsNeuron::~AbsNeuron() {
 }
 
 void AbsNeuron::EraseAllEdges() {
-	// TODO
+	// edges are shared with other neurons; arena edges get freed with the arena (EdgeArena::Release())
 /*
 	for(int i = 0; i < m_lIncomingConnections.size(); i++) {
 		if(m_lIncomingConnections[i] == NULL)
@@ -86,6 +88,14 @@ void AbsNeuron::SetConI(Edge *Edge, const unsigned int iID) {
 	m_lIncomingConnections[iID] = Edge;
 }
 
+void AbsNeuron::ResizeConsI(const unsigned int &iSize) {
+	m_lIncomingConnections.resize(iSize, NULL);
+}
+
+void AbsNeuron::ResizeConsO(const unsigned int &iSize) {
+	m_lOutgoingConnections.resize(iSize, NULL);
+}
+
 /*
 void AbsNeuron::SetConO(Edge *Edge, const unsigned int iID) {
 	std::list<ANN::Edge*>::iterator it;
@@ -123,10 +133,10 @@ ANN::list<Edge*> AbsNeuron::GetConsO() const{
 }
 */
 
-std::vector<Edge*> AbsNeuron::GetConsI() const{
+const std::vector<Edge*> &AbsNeuron::GetConsI() const{
 	return m_lIncomingConnections;
 }
-std::vector<Edge*> AbsNeuron::GetConsO() const{
+const std::vector<Edge*> &AbsNeuron::GetConsO() const{
 	return m_lOutgoingConnections;
 }
 
@@ -175,7 +185,7 @@ const float &AbsNeuron::GetValue() const {
 	return m_fValue;
 }
 
-const std::vector<float> AbsNeuron::GetPosition() const {
+const std::vector<float> &AbsNeuron::GetPosition() const {
 	return m_vPosition;
 }
 
@@ -312,24 +322,58 @@ namespace ANN {
 
 	/*STATIC:*/
 	void Connect(AbsNeuron *pSrcNeuron, AbsNeuron *pDstNeuron, const bool &bAdaptState) {
-		Edge *pCurEdge = new Edge(pSrcNeuron, pDstNeuron);
+		Connect(pSrcNeuron, pDstNeuron, bAdaptState, NULL);
+	}
+
+	void Connect(AbsNeuron *pSrcNeuron, AbsNeuron *pDstNeuron, const float &fVal, const float &fMomentum, const bool &bAdaptState) {
+		Connect(pSrcNeuron, pDstNeuron, fVal, fMomentum, bAdaptState, NULL);
+	}
+
+	void Connect(AbsNeuron *pSrcNeuron, AbsLayer *pDestLayer, const bool &bAdaptState) {
+		Connect(pSrcNeuron, pDestLayer, bAdaptState, NULL);
+	}
+
+	void Connect(AbsNeuron *pSrcNeuron, AbsLayer *pDestLayer, const std::vector<float> &vValues, const std::vector<float> &vMomentums, const bool &bAdaptState) {
+		Connect(pSrcNeuron, pDestLayer, vValues, vMomentums, bAdaptState, NULL);
+	}
+
+	void Connect(AbsNeuron *pSrcNeuron, AbsNeuron *pDstNeuron, const bool &bAdaptState, EdgeArena *pArena) {
+		Edge *pCurEdge = NULL;
+		if(pArena) {
+			pCurEdge = new(pArena->Alloc(1) ) Edge(pSrcNeuron, pDstNeuron);
+		}
+		else {
+			pCurEdge = new Edge(pSrcNeuron, pDstNeuron);
+		}
 
 		pCurEdge->SetAdaptationState(bAdaptState);
 		pSrcNeuron->AddConO(pCurEdge);				// Edge beiden zuweisen
 		pDstNeuron->AddConI(pCurEdge);
 	}
 
-	void Connect(AbsNeuron *pSrcNeuron, AbsNeuron *pDstNeuron, const float &fVal, const float &fMomentum, const bool &bAdaptState) {
-		Edge *pCurEdge = new Edge(pSrcNeuron, pDstNeuron, fVal, fMomentum, bAdaptState);
+	void Connect(AbsNeuron *pSrcNeuron, AbsNeuron *pDstNeuron, const float &fVal, const float &fMomentum, const bool &bAdaptState, EdgeArena *pArena) {
+		Edge *pCurEdge = NULL;
+		if(pArena) {
+			pCurEdge = new(pArena->Alloc(1) ) Edge(pSrcNeuron, pDstNeuron, fVal, fMomentum, bAdaptState);
+		}
+		else {
+			pCurEdge = new Edge(pSrcNeuron, pDstNeuron, fVal, fMomentum, bAdaptState);
+		}
 
 		pSrcNeuron->AddConO(pCurEdge);				// Edge beiden zuweisen
 		pDstNeuron->AddConI(pCurEdge);
 	}
 
-	void Connect(AbsNeuron *pSrcNeuron, AbsLayer *pDestLayer, const bool &bAdaptState) {
+	void Connect(AbsNeuron *pSrcNeuron, AbsLayer *pDestLayer, const bool &bAdaptState, EdgeArena *pArena) {
 		unsigned int iSize 		= pDestLayer->GetNeurons().size();
 		unsigned int iProgCount = 1;
 
+		Edge *pEdges = NULL;
+		if(pArena) {
+			pEdges = pArena->Alloc(iSize);
+		}
+		pSrcNeuron->m_lOutgoingConnections.reserve(pSrcNeuron->m_lOutgoingConnections.size() + iSize);
+
 		for(int j = 0; j < static_cast<int>(iSize); j++) {
 			// Output
 			if(iSize >= 10) {
@@ -341,14 +385,25 @@ namespace ANN {
 				std::cout<<"Building connections.. Progress: "<<(float)(j+1)/(float)iSize*100.f<<"%/Step="<<j+1<<std::endl;
 			}
 			// Work job
-			Connect(pSrcNeuron, pDestLayer->GetNeuron(j), bAdaptState);
+			AbsNeuron *pDstNeuron = pDestLayer->GetNeuron(j);
+			Edge *pCurEdge = pEdges ? new(&pEdges[j]) Edge(pSrcNeuron, pDstNeuron) : new Edge(pSrcNeuron, pDstNeuron);
+
+			pCurEdge->SetAdaptationState(bAdaptState);
+			pSrcNeuron->AddConO(pCurEdge);
+			pDstNeuron->AddConI(pCurEdge);
 		}
 	}
 
-	void Connect(AbsNeuron *pSrcNeuron, AbsLayer *pDestLayer, const std::vector<float> &vValues, const std::vector<float> &vMomentums, const bool &bAdaptState) {
+	void Connect(AbsNeuron *pSrcNeuron, AbsLayer *pDestLayer, const std::vector<float> &vValues, const std::vector<float> &vMomentums, const bool &bAdaptState, EdgeArena *pArena) {
 		unsigned int iSize 		= pDestLayer->GetNeurons().size();
 		unsigned int iProgCount = 1;
 
+		Edge *pEdges = NULL;
+		if(pArena) {
+			pEdges = pArena->Alloc(iSize);
+		}
+		pSrcNeuron->m_lOutgoingConnections.reserve(pSrcNeuron->m_lOutgoingConnections.size() + iSize);
+
 		for(int j = 0; j < static_cast<int>(iSize); j++) {
 			// Output
 			if(iSize >= 10) {
@@ -360,7 +415,57 @@ namespace ANN {
 				std::cout<<"Building connections.. Progress: "<<(float)(j+1)/(float)iSize*100.f<<"%/Step="<<j+1<<std::endl;
 			}
 			// Work job
-			Connect(pSrcNeuron, pDestLayer->GetNeuron(j), vValues[j], vMomentums[j], bAdaptState);
+			AbsNeuron *pDstNeuron = pDestLayer->GetNeuron(j);
+			Edge *pCurEdge = pEdges ?
+					new(&pEdges[j]) Edge(pSrcNeuron, pDstNeuron, vValues[j], vMomentums[j], bAdaptState) :
+					new Edge(pSrcNeuron, pDstNeuron, vValues[j], vMomentums[j], bAdaptState);
+
+			pSrcNeuron->AddConO(pCurEdge);
+			pDstNeuron->AddConI(pCurEdge);
+		}
+	}
+
+	void Connect(AbsLayer *pSrcLayer, AbsLayer *pDestLayer, const bool &bAdaptState, EdgeArena *pArena) {
+		const std::vector<AbsNeuron*> &vSrc = pSrcLayer->GetNeurons();
+		const std::vector<AbsNeuron*> &vDst = pDestLayer->GetNeurons();
+		unsigned int iSrcSize 	= vSrc.size();
+		unsigned int iDstSize 	= vDst.size();
+		unsigned int iProgCount = 1;
+
+		/*
+		 * One block for the whole layer; the lists of the neurons grow only once
+		 */
+		Edge *pEdges = NULL;
+		if(pArena) {
+			pEdges = pArena->Alloc(iSrcSize * iDstSize);
+		}
+		for(unsigned int i = 0; i < iSrcSize; i++) {
+			vSrc[i]->m_lOutgoingConnections.reserve(vSrc[i]->m_lOutgoingConnections.size() + iDstSize);
+		}
+		for(unsigned int j = 0; j < iDstSize; j++) {
+			vDst[j]->m_lIncomingConnections.reserve(vDst[j]->m_lIncomingConnections.size() + iSrcSize);
+		}
+
+		for(unsigned int i = 0; i < iSrcSize; i++) {
+			// Output
+			if(iSrcSize >= 10) {
+				if(((i+1) / (iSrcSize/10)) == iProgCount && (i+1) % (iSrcSize/10) == 0) {
+					std::cout<<"Building connections.. Progress: "<<iProgCount*10.f<<"%/Step="<<i+1<<std::endl;
+					iProgCount++;
+				}
+			}
+			// Work job
+			AbsNeuron *pSrcNeuron = vSrc[i];
+			for(unsigned int j = 0; j < iDstSize; j++) {
+				AbsNeuron *pDstNeuron = vDst[j];
+				Edge *pCurEdge = pEdges ?
+						new(&pEdges[i*iDstSize+j]) Edge(pSrcNeuron, pDstNeuron) :
+						new Edge(pSrcNeuron, pDstNeuron);
+
+				pCurEdge->SetAdaptationState(bAdaptState);
+				pSrcNeuron->AddConO(pCurEdge);
+				pDstNeuron->AddConI(pCurEdge);
+			}
 		}
 	}
 }
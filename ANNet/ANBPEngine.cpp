@@ -0,0 +1,686 @@
+/*
+ * ANBPEngine.cpp
+ *
+ *  Created on: 17.10.2026
+ */
+
+#include <cassert>
+#include <algorithm>
+#include <omp.h>
+//own classes
+#include <math/ANFunctions.h>
+#include <math/ANKernels.h>
+#include <containers/ANNetFile.h>
+#include <basic/ANEdge.h>
+#include <basic/ANAbsNeuron.h>
+#include <basic/ANAbsNet.h>
+#include <ANBPNeuron.h>
+#include <ANBPLayer.h>
+#include <ANBPEngine.h>
+
+using namespace ANN;
+
+
+BPEngine::BPEngine() {
+	m_pKernels 		= Kernels::GetKernels();
+	m_pFile 		= NULL;
+	m_iBatchSize 	= 0;
+	m_iMaxWidth 	= 0;
+}
+
+BPEngine::~BPEngine() {
+	Clear();
+}
+
+void BPEngine::Clear() {
+	m_vLayers.clear();
+	m_pFile = NULL;
+	m_vErrors.clear();
+	m_vBatchErrors.clear();
+	m_vBatchTargets.clear();
+	m_iBatchSize = 0;
+	m_iMaxWidth 	= 0;
+	m_vWorkspaces.clear();
+}
+
+bool BPEngine::IsEmpty() const {
+	return m_vLayers.empty();
+}
+
+const NetFile *BPEngine::GetFile() const {
+	return m_pFile;
+}
+
+unsigned int BPEngine::GetNrLayers() const {
+	return m_vLayers.size();
+}
+
+BPDenseLayer &BPEngine::GetLayer(const unsigned int &iLayerID) {
+	assert( iLayerID < m_vLayers.size() );
+	return m_vLayers[iLayerID];
+}
+
+const BPDenseLayer &BPEngine::GetLayer(const unsigned int &iLayerID) const {
+	assert( iLayerID < m_vLayers.size() );
+	return m_vLayers[iLayerID];
+}
+
+bool BPEngine::CompileLayer(const BPLayer *pPrevLayer, const BPLayer *pLayer, BPDenseLayer &Dense) {
+	const std::vector<AbsNeuron *> &vPrev 	= pPrevLayer->GetNeurons();
+	const std::vector<AbsNeuron *> &vCur 	= pLayer->GetNeurons();
+	BPNeuron *pBiasNeuron 					= pPrevLayer->GetBiasNeuron();
+
+	unsigned int iWidth 	= vPrev.size();
+	unsigned int iHeight 	= vCur.size();
+
+	Dense.m_iInputs 	= iWidth;
+	Dense.m_iNeurons 	= iHeight;
+
+	Dense.m_vWeights.assign(iWidth*iHeight, 0.f);
+	Dense.m_vMomentums.assign(iWidth*iHeight, 0.f);
+	Dense.m_vAdapt.assign(iWidth*iHeight, 0.f);
+
+	Dense.m_vBias.assign(iHeight, 0.f);
+	Dense.m_vBiasMomentums.assign(iHeight, 0.f);
+	Dense.m_vBiasAdapt.assign(iHeight, 0.f);
+	Dense.m_bBiasIsTheta 	= false;
+	Dense.m_fBiasValue 		= pBiasNeuron ? pBiasNeuron->GetValue() : 0.f;
+
+	/*
+	 * Learning parameters are owned by the neurons of the previous layer
+	 */
+	BPNeuron *pSrcNeuron 	= (BPNeuron*)vPrev.front();
+	Dense.m_fLearningRate 	= pSrcNeuron->GetLearningRate();
+	Dense.m_fWeightDecay 	= pSrcNeuron->GetWeightDecay();
+	Dense.m_fMomentum 		= pSrcNeuron->GetMomentum();
+
+	Dense.m_fBiasLearningRate 	= pBiasNeuron ? pBiasNeuron->GetLearningRate() 	: 0.f;
+	Dense.m_fBiasWeightDecay 	= pBiasNeuron ? pBiasNeuron->GetWeightDecay() 	: 0.f;
+	Dense.m_fBiasMomentum 		= pBiasNeuron ? pBiasNeuron->GetMomentum() 		: 0.f;
+
+	std::vector<bool> vExists(iWidth*iHeight, false);
+	std::vector<bool> vBiasExists(iHeight, false);
+	bool bAllAdapt 	= true;
+	int iTheta 		= -1;	// unknown yet
+
+	for(unsigned int j = 0; j < iHeight; j++) {
+		AbsNeuron *pNeuron = vCur[j];
+		if(pNeuron->GetTransfFunction() != Dense.m_pFunction) {
+			return false;
+		}
+
+		const std::vector<Edge*> &vConsI = pNeuron->GetConsI();
+		for(unsigned int k = 0; k < vConsI.size(); k++) {
+			Edge *pEdge 		= vConsI[k];
+			AbsNeuron *pFrom 	= pEdge->GetDestination(pNeuron);
+
+			// bias term
+			if(pBiasNeuron != NULL && pFrom == pBiasNeuron) {
+				int iIsTheta = (pNeuron->GetBiasEdge() == pEdge) ? 1 : 0;
+				if(vBiasExists[j] || (iTheta >= 0 && iTheta != iIsTheta) ) {
+					return false;
+				}
+				iTheta = iIsTheta;
+				vBiasExists[j] 				= true;
+				Dense.m_vBias[j] 			= pEdge->GetValue();
+				Dense.m_vBiasMomentums[j] 	= pEdge->GetMomentum();
+				Dense.m_vBiasAdapt[j] 		= pEdge->GetAdaptationState() ? 1.f : 0.f;
+				continue;
+			}
+
+			// regular edges must direct from the layer before
+			if(pFrom->GetParent() != pPrevLayer) {
+				return false;
+			}
+			unsigned int iFrom = pFrom->GetID();
+			if(iFrom >= iWidth || vPrev[iFrom] != pFrom || vExists[j*iWidth+iFrom]) {
+				return false;
+			}
+
+			vExists[j*iWidth+iFrom] 			= true;
+			Dense.m_vWeights[j*iWidth+iFrom] 	= pEdge->GetValue();
+			Dense.m_vMomentums[j*iWidth+iFrom] 	= pEdge->GetMomentum();
+			if(pEdge->GetAdaptationState() ) {
+				Dense.m_vAdapt[j*iWidth+iFrom] = 1.f;
+			}
+			else bAllAdapt = false;
+		}
+	}
+	Dense.m_bBiasIsTheta = (iTheta == 1);
+
+	for(unsigned int i = 0; i < vExists.size() && bAllAdapt; i++) {
+		bAllAdapt = vExists[i];
+	}
+	// fully connected and adaptable: no need for a mask
+	if(bAllAdapt) {
+		Dense.m_vAdapt.clear();
+	}
+
+	return true;
+}
+
+bool BPEngine::Compile(const std::vector<AbsLayer*> &vLayers) {
+	Clear();
+
+	if(vLayers.size() < 2) {
+		return false;
+	}
+
+	m_vLayers.resize(vLayers.size() );
+
+	unsigned int iNmbEdges 	= 0;	// edges captured in the dense matrices
+	unsigned int iNmbConsO 	= 0;	// edges of the graph
+	unsigned int iMaxWidth 	= 0;
+	for(unsigned int i = 0; i < vLayers.size(); i++) {
+		BPLayer *pLayer 	= (BPLayer*)vLayers[i];
+		BPDenseLayer &Dense = m_vLayers[i];
+
+		if(pLayer->GetNeurons().empty() ) {
+			Clear();
+			return false;
+		}
+		Dense.m_pFunction 	= pLayer->GetNeurons().front()->GetTransfFunction();
+		Dense.m_pWeights 	= NULL;
+		Dense.m_pBias 		= NULL;
+
+		if(i == 0) {
+			Dense.m_iInputs 	= 0;
+			Dense.m_iNeurons 	= pLayer->GetNeurons().size();
+			Dense.m_bBiasIsTheta 	= false;
+			Dense.m_fBiasValue 		= 0.f;
+			Dense.m_fLearningRate 	= Dense.m_fWeightDecay 		= Dense.m_fMomentum 	= 0.f;
+			Dense.m_fBiasLearningRate = Dense.m_fBiasWeightDecay = Dense.m_fBiasMomentum = 0.f;
+		}
+		else if(!CompileLayer( (BPLayer*)vLayers[i-1], pLayer, Dense) ) {
+			Clear();
+			return false;
+		}
+
+		// input layer can't have incoming edges
+		for(unsigned int j = 0; j < pLayer->GetNeurons().size(); j++) {
+			AbsNeuron *pNeuron = pLayer->GetNeurons()[j];
+			iNmbConsO += pNeuron->GetConsO().size();
+			if(i > 0) {
+				iNmbEdges += pNeuron->GetConsI().size();
+			}
+			else if(pNeuron->GetConsI().size() > 0) {
+				Clear();
+				return false;
+			}
+
+			Dense.m_vValues.push_back(pNeuron->GetValue() );
+			Dense.m_vDeltas.push_back(pNeuron->GetErrorDelta() );
+		}
+		if(pLayer->GetBiasNeuron() != NULL) {
+			iNmbConsO += pLayer->GetBiasNeuron()->GetConsO().size();
+		}
+		if(Dense.m_iNeurons > iMaxWidth) {
+			iMaxWidth = Dense.m_iNeurons;
+		}
+	}
+
+	// there are edges the dense representation doesn't know (e.g. recurrent ones)
+	if(iNmbEdges != iNmbConsO) {
+		Clear();
+		return false;
+	}
+
+	m_vErrors.resize(iMaxWidth);
+	m_iMaxWidth = iMaxWidth;
+	return true;
+}
+
+bool BPEngine::Map(const NetFile &File, const std::vector<AbsLayer*> &vLayers) {
+	Clear();
+
+	// only back propagation nets get their bias edges when imported (BPNet::CreateNet())
+	if(vLayers.size() < 2 || vLayers.size() != File.GetHeader().m_iNrOfLayers || File.GetHeader().m_iNetType != ANNetBP) {
+		return false;
+	}
+
+	m_vLayers.resize(vLayers.size() );
+
+	unsigned int iMaxWidth = 0;
+	for(unsigned int i = 0; i < vLayers.size(); i++) {
+		BPLayer *pLayer 			= (BPLayer*)vLayers[i];
+		const RawLayerDescr &Descr 	= File.GetLayer(i);
+		BPDenseLayer &Dense 		= m_vLayers[i];
+
+		if(pLayer->GetNeurons().empty() || pLayer->GetNeurons().size() != Descr.m_iNrOfNeurons) {
+			Clear();
+			return false;
+		}
+		Dense.m_iNeurons 	= Descr.m_iNrOfNeurons;
+		Dense.m_iInputs 	= 0;
+		Dense.m_pFunction 	= pLayer->GetNeurons().front()->GetTransfFunction();
+		Dense.m_pWeights 	= NULL;
+		Dense.m_pBias 		= NULL;
+		Dense.m_bBiasIsTheta 	= false;
+		Dense.m_fBiasValue 		= 0.f;
+		Dense.m_fLearningRate 	= Dense.m_fWeightDecay 		= Dense.m_fMomentum 	= 0.f;
+		Dense.m_fBiasLearningRate = Dense.m_fBiasWeightDecay = Dense.m_fBiasMomentum = 0.f;
+
+		// Validate() checked the size of the block against the previous layer
+		if(i > 0) {
+			BPNeuron *pBiasNeuron = ( (BPLayer*)vLayers[i-1])->GetBiasNeuron();
+			if(File.GetDenseWeights(i) == NULL) {
+				Clear();
+				return false;
+			}
+			Dense.m_iInputs 		= Descr.m_iDenseInputs;
+			Dense.m_pWeights 		= File.GetDenseWeights(i);
+			Dense.m_pBias 			= File.GetDenseBias(i);
+			// the import registers the bias edges as thresholds (AbsNeuron::SetBiasEdge())
+			Dense.m_bBiasIsTheta 	= true;
+			Dense.m_fBiasValue 		= pBiasNeuron ? pBiasNeuron->GetValue() : 0.f;
+		}
+
+		Dense.m_vValues.resize(Dense.m_iNeurons);
+		Dense.m_vDeltas.assign(Dense.m_iNeurons, 0.f);
+		for(unsigned int j = 0; j < Dense.m_iNeurons; j++) {
+			Dense.m_vValues[j] = pLayer->GetNeurons()[j]->GetValue();
+		}
+		if(Dense.m_iNeurons > iMaxWidth) {
+			iMaxWidth = Dense.m_iNeurons;
+		}
+	}
+
+	m_pFile = &File;
+	m_vErrors.resize(iMaxWidth);
+	m_iMaxWidth = iMaxWidth;
+	return true;
+}
+
+void BPEngine::Sync(const std::vector<AbsLayer*> &vLayers) const {
+	assert(vLayers.size() >= m_vLayers.size() );
+
+	for(unsigned int i = 0; i < m_vLayers.size(); i++) {
+		BPLayer *pLayer 			= (BPLayer*)vLayers[i];
+		const BPDenseLayer &Dense 	= m_vLayers[i];
+
+		#pragma omp parallel for
+		for(int j = 0; j < static_cast<int>(Dense.m_iNeurons); j++) {
+			AbsNeuron *pNeuron = pLayer->GetNeurons()[j];
+			pNeuron->SetValue(Dense.m_vValues[j]);
+			pNeuron->SetErrorDelta(Dense.m_vDeltas[j]);
+
+			// a mapped engine has no weights of its own
+			if(i == 0 || m_pFile != NULL) {
+				continue;
+			}
+
+			BPNeuron *pBiasNeuron = ( (BPLayer*)vLayers[i-1])->GetBiasNeuron();
+			const std::vector<Edge*> &vConsI = pNeuron->GetConsI();
+			for(unsigned int k = 0; k < vConsI.size(); k++) {
+				Edge *pEdge 		= vConsI[k];
+				AbsNeuron *pFrom 	= pEdge->GetDestination(pNeuron);
+
+				if(pBiasNeuron != NULL && pFrom == pBiasNeuron) {
+					pEdge->SetValue(Dense.m_vBias[j]);
+					pEdge->SetMomentum(Dense.m_vBiasMomentums[j]);
+				}
+				else {
+					unsigned int iID = j*Dense.m_iInputs + pFrom->GetID();
+					pEdge->SetValue(Dense.m_vWeights[iID]);
+					pEdge->SetMomentum(Dense.m_vMomentums[iID]);
+				}
+			}
+		}
+	}
+}
+
+void BPEngine::PropagateFW() {
+	for(unsigned int i = 1; i < m_vLayers.size(); i++) {
+		BPDenseLayer &Layer 	= m_vLayers[i];
+		const float *pInput 	= &m_vLayers[i-1].m_vValues[0];
+		unsigned int iWidth 	= Layer.m_iInputs;
+		unsigned int iHeight 	= Layer.m_iNeurons;
+
+		/*
+		 * Each thread calculates a block of rows
+		 */
+		#pragma omp parallel if(iWidth*iHeight > 4096)
+		{
+			int iThreads 	= omp_get_num_threads();
+			int iThread 	= omp_get_thread_num();
+			unsigned int iBegin = (unsigned int)( (unsigned long)iHeight*iThread/iThreads);
+			unsigned int iEnd 	= (unsigned int)( (unsigned long)iHeight*(iThread+1)/iThreads);
+
+			if(iEnd > iBegin) {
+				m_pKernels->gemv(&Layer.GetWeights()[(size_t)iBegin*iWidth], pInput, &Layer.m_vValues[iBegin], iEnd-iBegin, iWidth);
+			}
+
+			const float *pBias = Layer.GetBias();
+			for(unsigned int j = iBegin; j < iEnd; j++) {
+				// bias neuron/term, see BPNeuron::CalcValue()
+				float fTheta = Layer.m_bBiasIsTheta ? pBias[j] : 0.f;
+				float fSum = Layer.m_vValues[j] + pBias[j] * Layer.m_fBiasValue - fTheta;
+
+				Layer.m_vValues[j] = Layer.m_pFunction->normal(fSum, fTheta);
+			}
+		}
+	}
+}
+
+void BPEngine::PropagateBW() {
+	assert( m_pFile == NULL );
+	for(int i = m_vLayers.size()-2; i >= 0; i--) {
+		BPDenseLayer &Layer = m_vLayers[i];
+		BPDenseLayer &Next 	= m_vLayers[i+1];
+
+		unsigned int iWidth 	= Next.m_iInputs;
+		unsigned int iHeight 	= Next.m_iNeurons;
+
+		const float *pValues 	= &Layer.m_vValues[0];
+		const float *pDeltas 	= &Next.m_vDeltas[0];
+		const float *pAdapt 	= Next.m_vAdapt.empty() ? NULL : &Next.m_vAdapt[0];
+		float *pErrors 			= &m_vErrors[0];
+
+		float fLearningRate 	= Next.m_fLearningRate;
+		float fWeightDecay 		= Next.m_fWeightDecay;
+		float fMomentum 		= Next.m_fMomentum;
+
+		/*
+		 * Back propagate the error and adapt the outgoing weights of this layer.
+		 * Each thread owns a block of columns, so no element gets written twice.
+		 */
+		#pragma omp parallel if(iWidth*iHeight > 4096)
+		{
+			int iThreads 	= omp_get_num_threads();
+			int iThread 	= omp_get_thread_num();
+			unsigned int iBegin = (unsigned int)( (unsigned long)iWidth*iThread/iThreads);
+			unsigned int iEnd 	= (unsigned int)( (unsigned long)iWidth*(iThread+1)/iThreads);
+
+			if(iEnd > iBegin) {
+				for(unsigned int x = iBegin; x < iEnd; x++) {
+					pErrors[x] = 0.f;
+				}
+
+				for(unsigned int y = 0; y < iHeight; y++) {
+					unsigned int iRow = y*iWidth+iBegin;
+					m_pKernels->adapt(pDeltas[y], pDeltas[y] * fLearningRate, fWeightDecay, fMomentum,
+							&pValues[iBegin], pAdapt ? &pAdapt[iRow] : NULL,
+							&Next.m_vWeights[iRow], &Next.m_vMomentums[iRow], &pErrors[iBegin],
+							iEnd-iBegin);
+				}
+			}
+		}
+
+		// calc error deltas, see BPNeuron::AdaptEdges()
+		for(unsigned int x = 0; x < iWidth; x++) {
+			Layer.m_vDeltas[x] = (Layer.m_vDeltas[x] + pErrors[x]) * Layer.m_pFunction->derivate(pValues[x], 0.f);
+		}
+
+		// adapt the weights of the bias neuron
+		for(unsigned int y = 0; y < iHeight; y++) {
+			if(Next.m_vBiasAdapt[y] == 0.f) {
+				continue;
+			}
+			float fVal = pDeltas[y] * Next.m_fBiasLearningRate * Next.m_fBiasValue
+			           - Next.m_fBiasWeightDecay * Next.m_vBias[y]
+			           + Next.m_fBiasMomentum * Next.m_vBiasMomentums[y];
+
+			Next.m_vBiasMomentums[y] 	= fVal;
+			Next.m_vBias[y] 			+= fVal;
+		}
+	}
+}
+
+void BPEngine::SetBatchSize(const unsigned int &iSize) {
+	assert( !m_vLayers.empty() );
+	if(iSize == m_iBatchSize) {
+		return;
+	}
+	m_iBatchSize = iSize;
+
+	for(unsigned int i = 0; i < m_vLayers.size(); i++) {
+		BPDenseLayer &Layer = m_vLayers[i];
+		Layer.m_vBatchValues.resize(iSize*Layer.m_iNeurons);
+		Layer.m_vBatchDeltas.resize(iSize*Layer.m_iNeurons);
+		Layer.m_vGradients.resize(Layer.m_iNeurons*Layer.m_iInputs);
+		Layer.m_vBiasGradients.resize(Layer.m_iNeurons);
+	}
+	m_vBatchErrors.resize(iSize*m_vErrors.size() );
+	m_vBatchTargets.resize(iSize*m_vLayers.back().m_iNeurons);
+}
+
+unsigned int BPEngine::GetBatchSize() const {
+	return m_iBatchSize;
+}
+
+float *BPEngine::GetBatchInput(const unsigned int &iSample) {
+	assert( iSample < m_iBatchSize );
+	return &m_vLayers.front().m_vBatchValues[iSample*m_vLayers.front().m_iNeurons];
+}
+
+float *BPEngine::GetBatchTarget(const unsigned int &iSample) {
+	assert( iSample < m_iBatchSize );
+	return &m_vBatchTargets[iSample*m_vLayers.back().m_iNeurons];
+}
+
+void BPEngine::PropagateLayer(const BPDenseLayer &Layer, const float *pInput, float *pOutput,
+		const unsigned int &iSamples, const unsigned int &iBegin, const unsigned int &iEnd) const
+{
+	unsigned int iWidth 	= Layer.m_iInputs;
+	unsigned int iHeight 	= Layer.m_iNeurons;
+
+	if(iEnd <= iBegin) {
+		return;
+	}
+	const float *pBias = Layer.GetBias();
+
+	// bias neuron/term, see BPNeuron::CalcValue()
+	for(unsigned int b = 0; b < iSamples; b++) {
+		for(unsigned int j = iBegin; j < iEnd; j++) {
+			float fTheta = Layer.m_bBiasIsTheta ? pBias[j] : 0.f;
+			pOutput[b*iHeight+j] = pBias[j] * Layer.m_fBiasValue - fTheta;
+		}
+	}
+
+	// Y = X * W^T
+	m_pKernels->gemm_nt(pInput, &Layer.GetWeights()[(size_t)iBegin*iWidth], &pOutput[iBegin],
+			iSamples, iEnd-iBegin, iWidth,
+			iWidth, iWidth, iHeight);
+
+	for(unsigned int b = 0; b < iSamples; b++) {
+		for(unsigned int j = iBegin; j < iEnd; j++) {
+			float fTheta = Layer.m_bBiasIsTheta ? pBias[j] : 0.f;
+			pOutput[b*iHeight+j] = Layer.m_pFunction->normal(pOutput[b*iHeight+j], fTheta);
+		}
+	}
+}
+
+void BPEngine::PropagateBatchFW() {
+	unsigned int iBatch = m_iBatchSize;
+
+	for(unsigned int i = 1; i < m_vLayers.size(); i++) {
+		BPDenseLayer &Layer 	= m_vLayers[i];
+		unsigned int iWidth 	= Layer.m_iInputs;
+		unsigned int iHeight 	= Layer.m_iNeurons;
+
+		/*
+		 * Each thread calculates a block of neurons for all samples
+		 */
+		#pragma omp parallel if(iBatch*iWidth*iHeight > 4096)
+		{
+			int iThreads 	= omp_get_num_threads();
+			int iThread 	= omp_get_thread_num();
+			unsigned int iBegin = (unsigned int)( (unsigned long)iHeight*iThread/iThreads);
+			unsigned int iEnd 	= (unsigned int)( (unsigned long)iHeight*(iThread+1)/iThreads);
+
+			PropagateLayer(Layer, &m_vLayers[i-1].m_vBatchValues[0], &Layer.m_vBatchValues[0],
+					iBatch, iBegin, iEnd);
+		}
+	}
+}
+
+void BPEngine::PredictBatch(const float *pInput, float *pOutput, const unsigned int &iSamples) {
+	assert( m_vLayers.size() >= 2 );
+
+	// samples per block, small enough for the cache
+	const unsigned int iBlock = 64;
+
+	unsigned int iInput 	= m_vLayers.front().m_iNeurons;
+	unsigned int iOutput 	= m_vLayers.back().m_iNeurons;
+	int iBlocks 			= (iSamples+iBlock-1) / iBlock;
+
+	if(m_vWorkspaces.size() < (unsigned int)omp_get_max_threads() ) {
+		m_vWorkspaces.resize(omp_get_max_threads() );
+	}
+
+	#pragma omp parallel for schedule(dynamic) if(iBlocks > 1)
+	for(int i = 0; i < iBlocks; i++) {
+		std::vector<float> &vWorkspace = m_vWorkspaces[omp_get_thread_num()];
+		if(vWorkspace.size() < 2*iBlock*m_iMaxWidth) {
+			vWorkspace.resize(2*iBlock*m_iMaxWidth);
+		}
+
+		unsigned int iFirst 	= i*iBlock;
+		unsigned int iSize 		= std::min(iBlock, iSamples-iFirst);
+
+		// ping-pong between the two halves of the workspace
+		const float *pCurInput = &pInput[iFirst*iInput];
+		for(unsigned int j = 1; j < m_vLayers.size(); j++) {
+			const BPDenseLayer &Layer = m_vLayers[j];
+
+			float *pCurOutput = &vWorkspace[(j%2)*iBlock*m_iMaxWidth];
+			if(j == m_vLayers.size()-1) {
+				pCurOutput = &pOutput[iFirst*iOutput];
+			}
+
+			PropagateLayer(Layer, pCurInput, pCurOutput, iSize, 0, Layer.m_iNeurons);
+			pCurInput = pCurOutput;
+		}
+	}
+}
+
+float BPEngine::PropagateBatchBW() {
+	assert( m_pFile == NULL );
+	unsigned int iBatch = m_iBatchSize;
+
+	/*
+	 * Error deltas of the output layer like in AbsNet::SetOutput()
+	 */
+	BPDenseLayer &OPLayer = m_vLayers.back();
+	float fError = 0.f;
+	for(unsigned int i = 0; i < OPLayer.m_vBatchDeltas.size(); i++) {
+		float fCurError = m_vBatchTargets[i] - OPLayer.m_vBatchValues[i];
+		fError += fCurError * fCurError / 2.f;
+		OPLayer.m_vBatchDeltas[i] = fCurError;
+	}
+
+	for(int i = m_vLayers.size()-2; i >= 0; i--) {
+		BPDenseLayer &Layer = m_vLayers[i];
+		BPDenseLayer &Next 	= m_vLayers[i+1];
+
+		unsigned int iWidth 	= Next.m_iInputs;
+		unsigned int iHeight 	= Next.m_iNeurons;
+
+		const float *pValues 	= &Layer.m_vBatchValues[0];
+		const float *pDeltas 	= &Next.m_vBatchDeltas[0];
+		const float *pAdapt 	= Next.m_vAdapt.empty() ? NULL : &Next.m_vAdapt[0];
+		float *pErrors 			= &m_vBatchErrors[0];
+		float *pGradients 		= &Next.m_vGradients[0];
+
+		// the gradient gets averaged over the batch
+		float fLearningRate 	= Next.m_fLearningRate / (float)iBatch;
+		float fWeightDecay 		= Next.m_fWeightDecay;
+		float fMomentum 		= Next.m_fMomentum;
+
+		/*
+		 * E = D * W (back propagated error), G = D^T * X (gradient), then adapt W.
+		 * Each thread owns a block of columns, so E uses the weights before adaption.
+		 */
+		#pragma omp parallel if(iBatch*iWidth*iHeight > 4096)
+		{
+			int iThreads 	= omp_get_num_threads();
+			int iThread 	= omp_get_thread_num();
+			unsigned int iBegin = (unsigned int)( (unsigned long)iWidth*iThread/iThreads);
+			unsigned int iEnd 	= (unsigned int)( (unsigned long)iWidth*(iThread+1)/iThreads);
+			unsigned int iCols 	= iEnd-iBegin;
+
+			if(iCols > 0) {
+				// no error deltas needed for the input layer
+				if(i > 0) {
+					for(unsigned int b = 0; b < iBatch; b++) {
+						std::fill(&pErrors[b*iWidth+iBegin], &pErrors[b*iWidth+iEnd], 0.f);
+					}
+					m_pKernels->gemm_nn(pDeltas, &Next.m_vWeights[iBegin], &pErrors[iBegin],
+							iBatch, iCols, iHeight,
+							iHeight, iWidth, iWidth);
+				}
+
+				for(unsigned int y = 0; y < iHeight; y++) {
+					std::fill(&pGradients[y*iWidth+iBegin], &pGradients[y*iWidth+iEnd], 0.f);
+				}
+				m_pKernels->gemm_tn(pDeltas, &pValues[iBegin], &pGradients[iBegin],
+						iHeight, iCols, iBatch,
+						iHeight, iWidth, iWidth);
+
+				for(unsigned int y = 0; y < iHeight; y++) {
+					unsigned int iRow = y*iWidth+iBegin;
+					m_pKernels->update(fLearningRate, fWeightDecay, fMomentum,
+							&pGradients[iRow], pAdapt ? &pAdapt[iRow] : NULL,
+							&Next.m_vWeights[iRow], &Next.m_vMomentums[iRow],
+							iCols);
+				}
+
+				// calc error deltas
+				if(i > 0) {
+					for(unsigned int b = 0; b < iBatch; b++) {
+						for(unsigned int x = iBegin; x < iEnd; x++) {
+							unsigned int iID = b*iWidth+x;
+							Layer.m_vBatchDeltas[iID] = pErrors[iID] * Layer.m_pFunction->derivate(pValues[iID], 0.f);
+						}
+					}
+				}
+			}
+		}
+
+		// adapt the weights of the bias neuron
+		for(unsigned int y = 0; y < iHeight; y++) {
+			if(Next.m_vBiasAdapt[y] == 0.f) {
+				continue;
+			}
+			float fGradient = 0.f;
+			for(unsigned int b = 0; b < iBatch; b++) {
+				fGradient += pDeltas[b*iHeight+y];
+			}
+			Next.m_vBiasGradients[y] = fGradient;
+
+			float fVal = fGradient / (float)iBatch * Next.m_fBiasLearningRate * Next.m_fBiasValue
+			           - Next.m_fBiasWeightDecay * Next.m_vBias[y]
+			           + Next.m_fBiasMomentum * Next.m_vBiasMomentums[y];
+
+			Next.m_vBiasMomentums[y] 	= fVal;
+			Next.m_vBias[y] 			+= fVal;
+		}
+	}
+	return fError;
+}
+
+void BPEngine::SetLearningRate(const float &fVal) {
+	for(unsigned int i = 1; i < m_vLayers.size(); i++) {
+		m_vLayers[i].m_fLearningRate = fVal;
+	}
+}
+
+void BPEngine::SetMomentum(const float &fVal) {
+	for(unsigned int i = 1; i < m_vLayers.size(); i++) {
+		m_vLayers[i].m_fMomentum = fVal;
+	}
+}
+
+void BPEngine::SetWeightDecay(const float &fVal) {
+	for(unsigned int i = 1; i < m_vLayers.size(); i++) {
+		m_vLayers[i].m_fWeightDecay = fVal;
+	}
+}
+
+void BPEngine::SetTransfFunction(const TransfFunction *pFunction) {
+	assert( pFunction != 0 );
+
+	for(unsigned int i = 0; i < m_vLayers.size(); i++) {
+		m_vLayers[i].m_pFunction = pFunction;
+	}
+}
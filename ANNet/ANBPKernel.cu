@@ -4,6 +4,7 @@
 #include <math/ANFunctions.h>
 #include <gpgpu/ANKernels.h>
 #include <math/ANFunctions.h>
+#include <thrust/iterator/counting_iterator.h>
 
 
 // Y <- A * X + Y
@@ -31,60 +32,73 @@ struct sax_functor {
 };
 ///////////////////////////////////////////////////////////////////////
 
+/*
+ * Output of neuron x of a layer: transfer function of the weighted sum of all inputs,
+ * the matrix has one row per input neuron: w(y,x) = pEdges[y*iWidth+x]
+ * Neighbouring neurons read neighbouring weights of a row.
+ */
+template<class TransfFcn>
+struct layerFW_functor {
+	const float *pEdges;
+	const float *pInput;
+	const float *pBias;		// bias of each neuron or NULL
+	const unsigned int iWidth;
+	const unsigned int iHeight;
+	const TransfFcn fcn;
+
+	layerFW_functor(const float *_pEdges, const float *_pInput, const float *_pBias,
+			const unsigned int &_iWidth, const unsigned int &_iHeight) :
+		pEdges(_pEdges), pInput(_pInput), pBias(_pBias), iWidth(_iWidth), iHeight(_iHeight), fcn() {}
+
+	__host__ __device__
+	float operator()(const unsigned int &x) const {
+		float fSum = 0.f;
+		for(unsigned int y = 0; y < iHeight; y++) {
+			fSum += pInput[y] * pEdges[y*iWidth+x];
+		}
+		return fcn(fSum, pBias ? pBias[x] : 0.f);
+	}
+};
+
+template<class TransfFcn>
+inline void
+LayerFW(	thrust::device_vector<float> &dvLayer,
+			const thrust::device_vector<float> &dvInput,
+			const ANN::Matrix &mEdges,
+			const float *pBias)
+{
+	thrust::transform(
+			thrust::counting_iterator<unsigned int>(0),
+			thrust::counting_iterator<unsigned int>(dvLayer.size() ),
+			dvLayer.begin(),
+			layerFW_functor<TransfFcn>(
+					thrust::raw_pointer_cast(mEdges.data() ),
+					thrust::raw_pointer_cast(dvInput.data() ),
+					pBias, mEdges.getW(), mEdges.getH() ) );
+}
+
 inline void
-SwitchTransfFunc(	std::vector<thrust::device_vector<float> > &vNeuronValues,
-					thrust::device_vector<float> &dvLayer,
-					thrust::device_vector<float> &dvBias,
-					thrust::device_vector<float> &dvInput,
+SwitchTransfFunc(	thrust::device_vector<float> &dvLayer,
+					const thrust::device_vector<float> &dvInput,
+					const ANN::Matrix &mEdges,
+					const float *pBias,
 					const ANN::TransfFunction &function)
 {
-	// Run values through transfer function
+	// Weighted sums and transfer function in one run
 	if (strcmp(function.name, "tanh") == 0) {
-	    thrust::transform(
-	    		dvLayer.begin(),
-	    		dvLayer.end(),
-	    		dvBias.begin(),
-	    		dvLayer.begin(),
-	    		ANN::tanTransferFcn() );
-		// Now the input of the next layer will be the the previous one
-	    dvInput = dvLayer;
-		vNeuronValues.push_back(dvLayer);
+		LayerFW<ANN::tanTransferFcn>(dvLayer, dvInput, mEdges, pBias);
 		return;
 	}
 	if (strcmp(function.name, "log") == 0) {
-	    thrust::transform(
-	    		dvLayer.begin(),
-	    		dvLayer.end(),
-	    		dvBias.begin(),
-	    		dvLayer.begin(),
-	    		ANN::logTransferFcn() );
-		// Now the input of the next layer will be the the previous one
-	    dvInput = dvLayer;
-		vNeuronValues.push_back(dvLayer);
+		LayerFW<ANN::logTransferFcn>(dvLayer, dvInput, mEdges, pBias);
 		return;
 	}
 	if (strcmp(function.name, "binary") == 0) {
-	    thrust::transform(
-	    		dvLayer.begin(),
-	    		dvLayer.end(),
-	    		dvBias.begin(),
-	    		dvLayer.begin(),
-	    		ANN::binTransferFcn() );
-		// Now the input of the next layer will be the the previous one
-	    dvInput = dvLayer;
-		vNeuronValues.push_back(dvLayer);
+		LayerFW<ANN::binTransferFcn>(dvLayer, dvInput, mEdges, pBias);
 		return;
 	}
 	if (strcmp(function.name, "linear") == 0) {
-	    thrust::transform(
-	    		dvLayer.begin(),
-	    		dvLayer.end(),
-	    		dvBias.begin(),
-	    		dvLayer.begin(),
-	    		ANN::linTransferFcn() );
-		// Now the input of the next layer will be the the previous one
-	    dvInput = dvLayer;
-		vNeuronValues.push_back(dvLayer);
+		LayerFW<ANN::linTransferFcn>(dvLayer, dvInput, mEdges, pBias);
 		return;
 	}
 }
@@ -151,61 +165,37 @@ hostBPCalcDelta(	const thrust::device_vector<float> &dvNeurOut,	// from forward
 }
 ///////////////////////////////////////////////////////////////////////
 
-std::vector<thrust::device_vector<float> >
+void
 hostBPPropagateFW(	const std::vector<ANN::Matrix> &vEdgeMatrices,
 					const std::vector<ANN::Matrix> &vBiasEdgeMatrices,
 					const std::vector<float> &vInput,
-					const ANN::TransfFunction &function)
+					const ANN::TransfFunction &function,
+					std::vector<thrust::device_vector<float> > &vNeuronValues)
 {
-	std::vector<thrust::device_vector<float> > vNeuronValues(1, vInput);
-
-	// Copy Input from vInput in device vector: vOutput
-	thrust::device_vector<float> dvInput(vInput.begin(), vInput.end() ); 	// input
-	thrust::device_vector<float> dvLayer;
-	thrust::device_vector<float> dvBias;
-	
-	unsigned int iWidth 	= 0;
-	unsigned int iHeight 	= 0;
-
-	for(unsigned int i = 0; i < vEdgeMatrices.size(); i++) {	
-		iWidth 		= vEdgeMatrices.at(i).getW();
-		iHeight 	= vEdgeMatrices.at(i).getH();
-		
-		// Alloc memory
-		dvLayer 	= thrust::device_vector<float>(iWidth, 0.f);
-		dvBias 		= thrust::device_vector<float>(iWidth, 0.f);
-	
-		if(vBiasEdgeMatrices.at(i).getW() > 0) {
-			dvLayer = thrust::device_vector<float>(vBiasEdgeMatrices.at(i).getRowBegin(0), vBiasEdgeMatrices.at(i).getRowEnd(0));
-			dvBias 	= thrust::device_vector<float>(vBiasEdgeMatrices.at(i).getRowBegin(0), vBiasEdgeMatrices.at(i).getRowEnd(0));
-
-			// initial bias term
-			thrust::transform(dvBias.begin(),
-				dvBias.end(),
-				dvLayer.begin(),
-				thrust::negate<float>() );
-
-			// bias weights
-		    thrust::transform( dvBias.begin(),
-		    		dvBias.end(),
-		    		dvLayer.begin(),
-		    		dvLayer.begin(),
-		    		saxpy_functor(1) );
+	// One buffer per layer, kept by the caller: the output of a layer is the input of the next one
+	vNeuronValues.resize(vEdgeMatrices.size()+1);
+	if(vNeuronValues[0].size() != vInput.size() ) {
+		vNeuronValues[0].resize(vInput.size() );
+	}
+	thrust::copy(vInput.begin(), vInput.end(), vNeuronValues[0].begin() );
+	for(unsigned int i = 0; i < vEdgeMatrices.size(); i++) {
+		if(vNeuronValues[i+1].size() != vEdgeMatrices.at(i).getW() ) {
+			vNeuronValues[i+1].resize(vEdgeMatrices.at(i).getW() );
 		}
+	}
 
-		// Calculate the result of the current layer
-		for(unsigned int y = 0; y < iHeight; y++) {
-		    // Y <- A * X + Y
-		    thrust::transform( vEdgeMatrices.at(i).getRowBegin(y),
-		    		vEdgeMatrices.at(i).getRowEnd(y),
-		    		dvLayer.begin(),
-		    		dvLayer.begin(),
-		    		saxpy_functor(dvInput[y]) );
+	for(unsigned int i = 0; i < vEdgeMatrices.size(); i++) {
+		assert(vNeuronValues[i].size() == vEdgeMatrices.at(i).getH() );
+
+		const float *pBias = NULL;
+		if(vBiasEdgeMatrices.at(i).getW() > 0) {
+			assert(vBiasEdgeMatrices.at(i).getW() == vEdgeMatrices.at(i).getW() );
+			pBias = thrust::raw_pointer_cast(vBiasEdgeMatrices.at(i).data() );
 		}
 
-		SwitchTransfFunc( vNeuronValues, dvLayer, dvBias, dvInput, function );
+		// Calculate the result of the current layer
+		SwitchTransfFunc( vNeuronValues[i+1], vNeuronValues[i], vEdgeMatrices.at(i), pBias, function );
 	}
-	return vNeuronValues;
 }
 ///////////////////////////////////////////////////////////////////////
 
@@ -69,26 +69,22 @@ void BPLayer::AddNeurons(const unsigned int &iSize) {
 	}
 }
 
-void BPLayer::ConnectLayer(AbsLayer *pDestLayer, const bool &bAllowAdapt) {
-	AbsNeuron *pSrcNeuron;
-
+void BPLayer::ConnectLayer(AbsLayer *pDestLayer, const bool &bAllowAdapt, EdgeArena *pArena) {
 	/*
 	 * Vernetze jedes Neuron dieser Schicht mit jedem Neuron in "destLayer"
 	 */
-	for(unsigned int i = 0; i < m_lNeurons.size(); i++) {
-		pSrcNeuron = m_lNeurons[i];
-		Connect(pSrcNeuron, pDestLayer, bAllowAdapt);
-	}
+	Connect(this, pDestLayer, bAllowAdapt, pArena);
 
 	if(m_pBiasNeuron) {
-		Connect(m_pBiasNeuron, pDestLayer, true);
+		Connect(m_pBiasNeuron, pDestLayer, true, pArena);
 	}
 }
 
 void BPLayer::ConnectLayer(
 		AbsLayer *pDestLayer,
 		std::vector<std::vector<int> > Connections,
-		const bool bAllowAdapt)
+		const bool bAllowAdapt,
+		EdgeArena *pArena)
 {
 	AbsNeuron *pSrcNeuron;
 
@@ -102,12 +98,12 @@ void BPLayer::ConnectLayer(
 			assert( j < pDestLayer->GetNeurons().size() );
 			AbsNeuron *pDestNeuron = pDestLayer->GetNeuron(j);
 			assert( j < pDestNeuron->GetID() );
-			Connect(pSrcNeuron, pDestNeuron, bAllowAdapt);
+			Connect(pSrcNeuron, pDestNeuron, bAllowAdapt, pArena);
 		}
 	}
 
 	if(m_pBiasNeuron) {
-		Connect(m_pBiasNeuron, pDestLayer, true);
+		Connect(m_pBiasNeuron, pDestLayer, true, pArena);
 	}
 }
 
@@ -18,6 +18,7 @@
 #include <ANBPNeuron.h>
 #include <ANBPLayer.h>
 #include <ANBPNet.h>
+#include <ANBPEngine.h>
 #include <containers/ANConTable.h>
 
 using namespace ANN;
@@ -28,6 +29,8 @@ bool smallestFunctor(AbsLayer *i, AbsLayer *j) {
 }
 
 BPNet::BPNet() {
+	m_pEngine 			= NULL;
+	m_bTmpEngine 		= false;
 	m_fTypeFlag 		= ANNetBP;
 	SetTransfFunction(&ANN::Functions::fcn_log); 	// TODO not nice
 }
@@ -38,19 +41,34 @@ BPNet::BPNet(ANN::BPNet *pNet) //: AbsNet(pNet)
 	//*this = *GetSubNet( 0, pNet->GetLayers().size()-1 );
 	//m_fTypeFlag 	= ANNetBP;
 
-	*this = *pNet;
+	// the compiled representation stays with pNet, only its graph gets copied
+	pNet->SyncEdges();
+	AbsNet::operator = (*pNet);
+	m_pEngine 			= NULL;
+	m_bTmpEngine 		= false;
 }
 
 BPNet::~BPNet() {
+	if(m_pEngine != NULL) {
+		delete m_pEngine;
+		m_pEngine = NULL;
+	}
 }
 
 void BPNet::AddLayer(const unsigned int &iSize, const LayerTypeFlag &flType) {
+	Decompile();
 	AbsNet::AddLayer( new BPLayer(iSize, flType) );
 }
 
 void BPNet::CreateNet(const ConTable &Net) {
 	std::cout<<"Create BPNet"<<std::endl;
 
+	// old weights are obsolete
+	if(m_pEngine != NULL) {
+		delete m_pEngine;
+		m_pEngine = NULL;
+	}
+
 	/*
 	 * Init
 	 */
@@ -97,16 +115,15 @@ void BPNet::CreateNet(const ConTable &Net) {
 				pSrcNeur 	= ( (BPLayer*)pSrcLayer)->GetBiasNeuron();
 				pDstNeur 	= pDstLayer->GetNeuron(iDstNeurID);
 
-				ANN:Edge *pEdge = new ANN::Edge(pSrcNeur, pDstNeur, fEdgeValue);
-				pSrcNeur->AddConO(pEdge);
-				pDstNeur->AddConI(pEdge);
-				pDstNeur->SetBiasEdge(pEdge);
+				Connect(pSrcNeur, pDstNeur, fEdgeValue, 0.f, true, &m_EdgeArena);
+				pDstNeur->SetBiasEdge(pDstNeur->GetConsI().back() );
 			}
 		}
 	}
 }
 
 void BPNet::AddLayer(BPLayer *pLayer) {
+	Decompile();
 	AbsNet::AddLayer(pLayer);
 
 	if( ( (BPLayer*)pLayer)->GetFlag() & ANLayerInput ) {
@@ -126,6 +143,8 @@ BPNet *BPNet::GetSubNet(const unsigned int &iStartID, const unsigned int &iStopI
 	assert( iStopID < GetLayers().size() );
 	assert( iStartID >= 0 );
 
+	SyncEdges();
+
 	/*
 	 * Return value
 	 */
@@ -167,7 +186,8 @@ BPNet *BPNet::GetSubNet(const unsigned int &iStartID, const unsigned int &iStopI
 				Connect( pSrcNeuron, pDstNeuron,
 						pCurEdge->GetValue(),
 						pCurEdge->GetMomentum(),
-						pCurEdge->GetAdaptationState() );
+						pCurEdge->GetAdaptationState(),
+						pNet->GetEdgeArena() );
 			}
 		}
 
@@ -190,7 +210,8 @@ BPNet *BPNet::GetSubNet(const unsigned int &iStartID, const unsigned int &iStopI
 				Connect( pBiasNeuron, pDstNeuron,
 						pCurEdge->GetValue(),
 						pCurEdge->GetMomentum(),
-						pCurEdge->GetAdaptationState() );
+						pCurEdge->GetAdaptationState(),
+						pNet->GetEdgeArena() );
 			}
 		}
 	}
@@ -206,7 +227,112 @@ BPNet *BPNet::GetSubNet(const unsigned int &iStartID, const unsigned int &iStopI
 	return pNet;
 }
 
+bool BPNet::Compile() {
+	Decompile();
+
+	if(m_lLayers.size() < 2 || m_pIPLayer != m_lLayers.front() || m_pOPLayer != m_lLayers.back() ) {
+		return false;
+	}
+
+	m_pEngine = new BPEngine;
+	if(!m_pEngine->Compile(m_lLayers) ) {
+		std::cout<<"Net topology not supported by the compiled mode"<<std::endl;
+		delete m_pEngine;
+		m_pEngine = NULL;
+		return false;
+	}
+	return true;
+}
+
+bool BPNet::Compile(const NetFile &File) {
+	Decompile();
+
+	// layers and neurons only, the weights stay in the file
+	ImpFromRawFS(File, false);
+
+	m_pEngine = new BPEngine;
+	if(m_lLayers.size() >= 2 && m_pIPLayer == m_lLayers.front() && m_pOPLayer == m_lLayers.back() && m_pEngine->Map(File, m_lLayers) ) {
+		return true;
+	}
+	std::cout<<"Net file has no dense blocks, importing the edges"<<std::endl;
+	delete m_pEngine;
+	m_pEngine = NULL;
+	ImpFromRawFS(File, true, false);
+	return false;
+}
+
+void BPNet::Decompile() {
+	if(m_pEngine == NULL) {
+		return;
+	}
+	if(m_pEngine->GetFile() != NULL) {
+		BPEngine *pMapped = m_pEngine;
+		m_pEngine = NULL;
+
+		ImpFromRawFS(*pMapped->GetFile(), true, false);
+		// the new neurons continue with the transfer functions, values and error deltas of the mapped net
+		for(unsigned int i = 0; i < m_lLayers.size(); i++) {
+			GetLayer(i)->SetNetFunction(pMapped->GetLayer(i).m_pFunction);
+		}
+		pMapped->Sync(m_lLayers);
+		delete pMapped;
+		return;
+	}
+	SyncEdges();
+	delete m_pEngine;
+	m_pEngine = NULL;
+}
+
+bool BPNet::IsCompiled() const {
+	return m_pEngine != NULL;
+}
+
+bool BPNet::IsMapped() const {
+	return m_pEngine != NULL && m_pEngine->GetFile() != NULL;
+}
+
+void BPNet::SyncEdges() {
+	if(IsMapped() ) {
+		Decompile();
+	}
+	else if(m_pEngine != NULL) {
+		m_pEngine->Sync(m_lLayers);
+	}
+}
+
+void BPNet::PredictBatch(const float *pInput, float *pOutput, const unsigned int &iSamples) {
+	// like the mini-batches of TrainBatch(), a net in graph mode gets compiled for this call only
+	bool bTmpEngine = false;
+	if(m_pEngine == NULL) {
+		bTmpEngine = Compile();
+	}
+	if(m_pEngine == NULL) {
+		AbsNet::PredictBatch(pInput, pOutput, iSamples);
+		return;
+	}
+	m_pEngine->PredictBatch(pInput, pOutput, iSamples);
+	if(bTmpEngine) {
+		Decompile();
+	}
+}
+
 void BPNet::PropagateFW() {
+	if(m_pEngine != NULL) {
+		BPDenseLayer &IPLayer = m_pEngine->GetLayer(0);
+		for(unsigned int i = 0; i < IPLayer.m_iNeurons; i++) {
+			IPLayer.m_vValues[i] = m_pIPLayer->GetNeuron(i)->GetValue();
+		}
+
+		m_pEngine->PropagateFW();
+
+		// output is read from the neurons
+		const BPDenseLayer &OPLayer = m_pEngine->GetLayer(m_pEngine->GetNrLayers()-1);
+		for(unsigned int i = 0; i < OPLayer.m_iNeurons; i++) {
+			m_pOPLayer->GetNeuron(i)->SetValue(OPLayer.m_vValues[i]);
+		}
+		return;
+	}
+
 	for(unsigned int i = 1; i < m_lLayers.size(); i++) {
 		BPLayer *curLayer = ( (BPLayer*)GetLayer(i) );
 		#pragma omp parallel for
@@ -221,6 +347,28 @@ void BPNet::PropagateBW() {
 	/*
 	 * Calc error delta based on the difference of output from wished result
 	 */
+	if(IsMapped() ) {
+		// the weights of the file are read only, the error deltas of SetOutput() have to survive the switch to graph mode
+		std::vector<float> vDeltas(m_pOPLayer->GetNeurons().size() );
+		for(unsigned int i = 0; i < vDeltas.size(); i++) {
+			vDeltas[i] = m_pOPLayer->GetNeuron(i)->GetErrorDelta();
+		}
+		Decompile();
+		for(unsigned int i = 0; i < vDeltas.size(); i++) {
+			m_pOPLayer->GetNeuron(i)->SetErrorDelta(vDeltas[i]);
+		}
+	}
+
+	if(m_pEngine != NULL) {
+		BPDenseLayer &OPLayer = m_pEngine->GetLayer(m_pEngine->GetNrLayers()-1);
+		for(unsigned int i = 0; i < OPLayer.m_iNeurons; i++) {
+			OPLayer.m_vDeltas[i] = m_pOPLayer->GetNeuron(i)->GetErrorDelta();
+		}
+
+		m_pEngine->PropagateBW();
+		return;
+	}
+
 	for(int i = m_lLayers.size()-1; i >= 0; i--) {
 		BPLayer *curLayer = ( (BPLayer*)GetLayer(i) );
 		#pragma omp parallel for
@@ -246,14 +394,57 @@ std::vector<float> BPNet::TrainFromData(const unsigned int &iCycles, const float
 		}
 	}
 	if(bZSort) {
+		bool bCompiled = IsCompiled();
+		Decompile();
+
 		std::sort(m_lLayers.begin(), m_lLayers.end(), smallestFunctor);
 		// The IDs of the layers must be set according to Z-Value
 		for(int i = 0; i < m_lLayers.size(); i++) {
 			m_lLayers.at(i)->SetID(i);
 		}
+
+		if(bCompiled) {
+			Compile();
+		}
 	}
 
-	return AbsNet::TrainFromData(iCycles, fTolerance, bBreak, fProgress);
+	m_bTmpEngine = false;
+	std::vector<float> vErrors = AbsNet::TrainFromData(iCycles, fTolerance, bBreak, fProgress);
+	// switch back to graph mode if the net got compiled for the mini-batches only
+	if(m_bTmpEngine) {
+		Decompile();
+		m_bTmpEngine = false;
+	}
+	return vErrors;
+}
+
+float BPNet::TrainBatch(const unsigned int &iStart, const unsigned int &iSize) {
+	// the weights of a mapped file are read only
+	if(IsMapped() ) {
+		Decompile();
+	}
+	// try once per training run
+	if(iSize > 1 && m_pEngine == NULL && !m_bTmpEngine) {
+		m_bTmpEngine = true;
+		Compile();
+	}
+	if(iSize <= 1 || m_pEngine == NULL) {
+		return AbsNet::TrainBatch(iStart, iSize);
+	}
+
+	m_pEngine->SetBatchSize(iSize);
+	for(unsigned int i = 0; i < iSize; i++) {
+		const SampleView Input 	= m_pTrainingData->GetInput(iStart+i);
+		const SampleView Output = m_pTrainingData->GetOutput(iStart+i);
+		assert( Input.size() <= m_pIPLayer->GetNeurons().size() );
+		assert( Output.size() == m_pOPLayer->GetNeurons().size() );
+
+		std::copy(Input.begin(), Input.end(), m_pEngine->GetBatchInput(i) );
+		std::copy(Output.begin(), Output.end(), m_pEngine->GetBatchTarget(i) );
+	}
+
+	m_pEngine->PropagateBatchFW();
+	return m_pEngine->PropagateBatchBW();
 }
 
 void BPNet::SetLearningRate(const float &fVal)
@@ -263,6 +454,9 @@ void BPNet::SetLearningRate(const float &fVal)
 	for(int i = 0; i < static_cast<int>(m_lLayers.size() ); i++) {
 		( (BPLayer*)GetLayer(i) )->SetLearningRate(fVal);
 	}
+	if(m_pEngine != NULL) {
+		m_pEngine->SetLearningRate(fVal);
+	}
 }
 
 float BPNet::GetLearningRate() const {
@@ -275,6 +469,9 @@ void BPNet::SetMomentum(const float &fVal) {
 	for(int i = 0; i < static_cast<int>(m_lLayers.size() ); i++) {
 		( (BPLayer*)GetLayer(i) )->SetMomentum(fVal);
 	}
+	if(m_pEngine != NULL) {
+		m_pEngine->SetMomentum(fVal);
+	}
 }
 
 float BPNet::GetMomentum() const {
@@ -287,8 +484,31 @@ void BPNet::SetWeightDecay(const float &fVal) {
 	for(int i = 0; i < static_cast<int>(m_lLayers.size() ); i++) {
 		( (BPLayer*)GetLayer(i) )->SetWeightDecay(fVal);
 	}
+	if(m_pEngine != NULL) {
+		m_pEngine->SetWeightDecay(fVal);
+	}
 }
 
 float BPNet::GetWeightDecay() const {
 	return m_fWeightDecay;
 }
+
+void BPNet::SetTransfFunction(const TransfFunction *pFunction) {
+	AbsNet::SetTransfFunction(pFunction);
+	if(m_pEngine != NULL) {
+		m_pEngine->SetTransfFunction(pFunction);
+	}
+}
+
+void BPNet::EraseAll() {
+	if(m_pEngine != NULL) {
+		delete m_pEngine;
+		m_pEngine = NULL;
+	}
+	AbsNet::EraseAll();
+}
+
+void BPNet::ExpToFS(std::string path, const FileFormatFlag &fFormat) {
+	SyncEdges();
+	AbsNet::ExpToFS(path, fFormat);
+}
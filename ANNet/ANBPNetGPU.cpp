@@ -10,6 +10,7 @@
 #include <ANBPNeuron.h>
 #include <ANBPLayer.h>
 #include <math/ANFunctions.h>
+#include <containers/ANTrainingSet.h>
 #include <gpgpu/ANBPNetGPU.h>
 
 
@@ -150,11 +151,13 @@ void BPNetGPU::GetEdgeMatrices() {
 }
 
 void BPNetGPU::PropagateFW() {
-	m_vNeuronVals =	hostBPPropagateFW (
+	// the buffers of the layers are reused from sample to sample
+	hostBPPropagateFW (
 		m_vEdgeMatricesI,
 		m_vBiasEdges,
 		GetCurrentInput(),
-		*GetTransfFunction()
+		*GetTransfFunction(),
+		m_vNeuronVals
 	);
 
 	UpdateNeurons();
@@ -191,6 +194,17 @@ void BPNetGPU::PropagateBW() {
 	);
 }
 
+float BPNetGPU::TrainBatch(const unsigned int &iStart, const unsigned int &iSize) {
+	// SetOutput() of the device takes a std::vector
+	float fError = 0.f;
+	for( unsigned int i = iStart; i < iStart+iSize; i++ ) {
+		SetInput( m_pTrainingData->GetInput(i) );
+		fError += SetOutput( m_pTrainingData->GetOutput(i) );
+		PropagateBW();
+	}
+	return fError;
+}
+
 std::vector<float> BPNetGPU::TrainFromData(const unsigned int &iCycles, const float &fTolerance, const bool &bBreak, float &fProgress) {
 	// Retrive weight matrices
 	GetEdgeMatrices();
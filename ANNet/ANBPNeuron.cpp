@@ -44,31 +44,45 @@ void BPNeuron::SetMomentum(const float &fVal) {
 	m_fMomentum = fVal;
 }
 
+float BPNeuron::GetLearningRate() const {
+	return m_fLearningRate;
+}
+
+float BPNeuron::GetWeightDecay() const {
+	return m_fWeightDecay;
+}
+
+float BPNeuron::GetMomentum() const {
+	return m_fMomentum;
+}
+
 void BPNeuron::CalcValue() {
-	if(GetConsI().size() == 0)
+	const std::vector<Edge*> &vConsI = GetConsI();
+	if(vConsI.size() == 0)
 		return;
 
 	// bias neuron/term
 	float fBias = 0.f;
-	SetValue( 0.f );
+	float fSum 	= 0.f;
 	if(GetBiasEdge() ) {
 		fBias = GetBiasEdge()->GetValue();
-		SetValue(-1.f*fBias);
+		fSum = -1.f*fBias;
 	}
 
 	// sum from product of all incoming neurons with their weights (including bias neurons)
 	AbsNeuron *from;
-	for(unsigned int i = 0; i < GetConsI().size(); i++) {
-		from = GetConI(i)->GetDestination(this);
-		SetValue(GetValue() + (from->GetValue() * GetConI(i)->GetValue()));
+	for(unsigned int i = 0; i < vConsI.size(); i++) {
+		from = vConsI[i]->GetDestination(this);
+		fSum += from->GetValue() * vConsI[i]->GetValue();
 	}
 
-	float fVal = GetTransfFunction()->normal( GetValue(), fBias );
+	float fVal = GetTransfFunction()->normal( fSum, fBias );
 	SetValue(fVal);
 }
 
 void BPNeuron::AdaptEdges() {
-	if(GetConsO().size() == 0)
+	const std::vector<Edge*> &vConsO = GetConsO();
+	if(vConsO.size() == 0)
 		return;
 
 	AbsNeuron 	*pCurNeuron;
@@ -77,8 +91,8 @@ void BPNeuron::AdaptEdges() {
 
 	// calc error deltas
 	fVal = GetErrorDelta();
-	for(unsigned int i = 0; i < GetConsO().size(); i++) {
-		pCurEdge 	= GetConO(i);
+	for(unsigned int i = 0; i < vConsO.size(); i++) {
+		pCurEdge 	= vConsO[i];
 		pCurNeuron 	= pCurEdge->GetDestination(this);
 		fVal += pCurNeuron->GetErrorDelta() * pCurEdge->GetValue();
 	}
@@ -86,8 +100,8 @@ void BPNeuron::AdaptEdges() {
 	SetErrorDelta(fVal);
 
 	// adapt weights
-	for(unsigned int i = 0; i < GetConsO().size(); i++) {
-		pCurEdge = GetConO(i);
+	for(unsigned int i = 0; i < vConsO.size(); i++) {
+		pCurEdge = vConsO[i];
 		if(pCurEdge->GetAdaptationState() == true) {
 			//fVal = 0.f;	// delta for momentum
 			// standard back propagation algorithm
@@ -16,9 +16,12 @@ using namespace ANN;
 
 
 Edge::Edge() {
-	float 	fValue 		= 0.f;
-	float 	fMomentum 	= 0.f;
-	bool 	bAdapt 		= true;
+	m_pNeuronFirst 		= NULL;
+	m_pNeuronSecond 	= NULL;
+
+	m_fWeight 			= 0.f;
+	m_fMomentum 		= 0.f;
+	m_bAllowAdaptation 	= true;
 }
 
 Edge::Edge(Edge *pEdge) {
@@ -0,0 +1,85 @@
+/*
+ * EdgeArena.cpp
+ *
+ *  Created on: 17.10.2026
+ */
+
+#include <new>
+#include <cstddef>
+#include <cassert>
+//own classes
+#include <basic/ANEdge.h>
+#include <basic/ANEdgeArena.h>
+
+using namespace ANN;
+
+
+EdgeArena::EdgeArena(const unsigned int &iBlockSize) {
+	assert(iBlockSize > 0);
+
+	m_iBlockSize 	= iBlockSize;
+	m_pNext 		= NULL;
+	m_iFree 		= 0;
+	m_iSize 		= 0;
+}
+
+EdgeArena::EdgeArena(const EdgeArena &Arena) {
+	m_iBlockSize 	= Arena.m_iBlockSize;
+	m_pNext 		= NULL;
+	m_iFree 		= 0;
+	m_iSize 		= 0;
+}
+
+EdgeArena &EdgeArena::operator = (const EdgeArena &Arena) {
+	m_iBlockSize = Arena.m_iBlockSize;
+	return *this;
+}
+
+EdgeArena::~EdgeArena() {
+	Release();
+}
+
+Edge *EdgeArena::Alloc(const unsigned int &iCount) {
+	m_iSize += iCount;
+
+	/*
+	 * Large arrays (e.g. a fully connected layer) get their own block,
+	 * so the rest of the current block is not wasted
+	 */
+	if(iCount > m_iBlockSize) {
+		Edge *pBlock = static_cast<Edge*>(::operator new(sizeof(Edge) * iCount) );
+		m_vBlocks.push_back(pBlock);
+		return pBlock;
+	}
+
+	if(iCount > m_iFree) {
+		m_pNext = static_cast<Edge*>(::operator new(sizeof(Edge) * m_iBlockSize) );
+		m_iFree = m_iBlockSize;
+		m_vBlocks.push_back(m_pNext);
+	}
+
+	Edge *pEdges = m_pNext;
+	m_pNext += iCount;
+	m_iFree -= iCount;
+	return pEdges;
+}
+
+void EdgeArena::Release() {
+	// edges have a trivial destructor, so no need to call it
+	for(unsigned int i = 0; i < m_vBlocks.size(); i++) {
+		::operator delete(m_vBlocks[i]);
+	}
+	m_vBlocks.clear();
+
+	m_pNext = NULL;
+	m_iFree = 0;
+	m_iSize = 0;
+}
+
+unsigned int EdgeArena::GetNrOfEdges() const {
+	return m_iSize;
+}
+
+unsigned int EdgeArena::GetNrOfBlocks() const {
+	return m_vBlocks.size();
+}
@@ -0,0 +1,289 @@
+/*
+ * ANHFEngine.cpp
+ *
+ *  Created on: 17.10.2026
+ */
+
+#include <cassert>
+#include <algorithm>
+//own classes
+#include <math/ANKernels.h>
+#include <math/ANRandom.h>
+#include <ANHFEngine.h>
+
+using namespace ANN;
+
+
+HFEngine::HFEngine() {
+	m_pKernels 		= Kernels::GetKernels();
+	m_iNeurons 		= 0;
+	m_iWords 		= 0;
+	m_iPatterns 	= 0;
+	m_iCapacity 	= 0;
+}
+
+HFEngine::~HFEngine() {
+}
+
+void HFEngine::Resize(const unsigned int &iNeurons) {
+	Clear();
+	m_iNeurons 	= iNeurons;
+	m_iWords 	= (iNeurons+63)/64;
+}
+
+void HFEngine::Clear() {
+	m_iPatterns 	= 0;
+	m_iCapacity 	= 0;
+	m_vPatterns.clear();
+	m_vNeurons.clear();
+}
+
+void HFEngine::Reserve(const unsigned int &iPatterns) {
+	if(iPatterns <= m_iCapacity) {
+		return;
+	}
+	// grows geometrically, so adding patterns one by one stays cheap
+	const unsigned int iCapacity 	= (std::max(iPatterns, 2*m_iCapacity)+63)/64*64;
+	const unsigned int iOldWords 	= m_iCapacity/64;
+	const unsigned int iNewWords 	= iCapacity/64;
+
+	std::vector<uint64_t> vNeurons((size_t)m_iNeurons*iNewWords, 0);
+	for(unsigned int i = 0; i < m_iNeurons && iOldWords > 0; i++) {
+		std::copy(	m_vNeurons.begin() + (size_t)i*iOldWords, m_vNeurons.begin() + (size_t)(i+1)*iOldWords,
+					vNeurons.begin() + (size_t)i*iNewWords);
+	}
+	m_vNeurons.swap(vNeurons);
+	m_vPatterns.reserve((size_t)iCapacity*m_iWords);
+	m_iCapacity = iCapacity;
+}
+
+void HFEngine::AddPattern(const float *pPattern) {
+	AddPatterns(pPattern, 1);
+}
+
+void HFEngine::AddPatterns(const float *pPatterns, const unsigned int &iPatterns) {
+	assert(pPatterns != NULL);
+	if(iPatterns == 0 || m_iNeurons == 0) {
+		return;
+	}
+	const unsigned int iFirst = m_iPatterns;
+	Reserve(iFirst+iPatterns);
+
+	m_vPatterns.resize((size_t)(iFirst+iPatterns)*m_iWords);
+	#pragma omp parallel for
+	for(int p = 0; p < static_cast<int>(iPatterns); p++) {
+		Pack(pPatterns + (size_t)p*m_iNeurons, m_iNeurons, &m_vPatterns[(size_t)(iFirst+p)*m_iWords]);
+	}
+
+	// transpose the new pattern bits into the neuron-wise bitsets
+	const unsigned int iNeuronWords = m_iCapacity/64;
+	#pragma omp parallel for
+	for(int i = 0; i < static_cast<int>(m_iNeurons); i++) {
+		uint64_t *pBits 			= &m_vNeurons[(size_t)i*iNeuronWords];
+		const unsigned int iWord 	= i/64;
+		const unsigned int iBit 	= i%64;
+		for(unsigned int p = iFirst; p < iFirst+iPatterns; p++) {
+			const uint64_t iVal = (m_vPatterns[(size_t)p*m_iWords + iWord] >> iBit) & 1;
+			pBits[p/64] |= iVal << (p%64);
+		}
+	}
+	m_iPatterns += iPatterns;
+}
+
+void HFEngine::RemovePattern(const unsigned int &iPattern) {
+	assert(iPattern < m_iPatterns);
+	const unsigned int iLast = m_iPatterns-1;
+
+	std::copy(	m_vPatterns.begin() + (size_t)iLast*m_iWords, m_vPatterns.begin() + (size_t)(iLast+1)*m_iWords,
+				m_vPatterns.begin() + (size_t)iPattern*m_iWords);
+	m_vPatterns.resize((size_t)iLast*m_iWords);
+
+	const unsigned int iNeuronWords = m_iCapacity/64;
+	#pragma omp parallel for
+	for(int i = 0; i < static_cast<int>(m_iNeurons); i++) {
+		uint64_t *pBits 		= &m_vNeurons[(size_t)i*iNeuronWords];
+		const uint64_t iVal 	= (pBits[iLast/64] >> (iLast%64) ) & 1;
+		pBits[iLast/64] 		&= ~(1ULL << (iLast%64) );
+		pBits[iPattern/64] 		= (pBits[iPattern/64] & ~(1ULL << (iPattern%64) ) ) | (iVal << (iPattern%64) );
+	}
+	m_iPatterns = iLast;
+}
+
+int HFEngine::FindPattern(const float *pPattern) const {
+	assert(pPattern != NULL);
+	std::vector<uint64_t> vBits(m_iWords);
+	if(m_iWords == 0) {
+		return -1;
+	}
+	Pack(pPattern, m_iNeurons, &vBits[0]);
+	for(unsigned int p = 0; p < m_iPatterns; p++) {
+		if(m_pKernels->hamming(&m_vPatterns[(size_t)p*m_iWords], &vBits[0], m_iWords) == 0) {
+			return static_cast<int>(p);
+		}
+	}
+	return -1;
+}
+
+unsigned int HFEngine::GetNrOfNeurons() const {
+	return m_iNeurons;
+}
+
+unsigned int HFEngine::GetNrOfPatterns() const {
+	return m_iPatterns;
+}
+
+unsigned int HFEngine::GetNrOfWords() const {
+	return m_iWords;
+}
+
+const uint64_t *HFEngine::GetPattern(const unsigned int &iPattern) const {
+	assert(iPattern < m_iPatterns);
+	return &m_vPatterns[(size_t)iPattern*m_iWords];
+}
+
+void HFEngine::Pack(const float *pValues, const unsigned int &iSize, uint64_t *pBits) {
+	for(unsigned int w = 0; w*64 < iSize; w++) {
+		const unsigned int iEnd = std::min<unsigned int>(64, iSize-w*64);
+		uint64_t iWord = 0;
+		for(unsigned int k = 0; k < iEnd; k++) {
+			if(pValues[w*64+k] >= 0.f) {
+				iWord |= 1ULL << k;
+			}
+		}
+		pBits[w] = iWord;
+	}
+}
+
+void HFEngine::Unpack(const uint64_t *pBits, const unsigned int &iSize, float *pValues) {
+	for(unsigned int i = 0; i < iSize; i++) {
+		pValues[i] = ( (pBits[i/64] >> (i%64) ) & 1) ? 1.f : -1.f;
+	}
+}
+
+int64_t HFEngine::CalcOverlaps(const uint64_t *pState, int32_t *pOverlaps) const {
+	int64_t iSum = 0;
+	#pragma omp parallel for reduction(+:iSum)
+	for(int p = 0; p < static_cast<int>(m_iPatterns); p++) {
+		const unsigned int iDiff = m_pKernels->hamming(&m_vPatterns[(size_t)p*m_iWords], pState, m_iWords);
+		pOverlaps[p] = static_cast<int32_t>(m_iNeurons) - 2*static_cast<int32_t>(iDiff);
+		iSum += pOverlaps[p];
+	}
+	return iSum;
+}
+
+int64_t HFEngine::CalcField(const unsigned int &iNeuron, const bool &bState, const int32_t *pOverlaps, const int64_t &iSum) const {
+	assert(iNeuron < m_iNeurons);
+	if(m_iPatterns == 0) {
+		return 0;
+	}
+	// sum_mu xi_mu,i * m_mu = 2 * (sum of the overlaps of the patterns with xi_mu,i = +1) - sum of all overlaps
+	const int64_t iPos = m_pKernels->masked_sum(&m_vNeurons[(size_t)iNeuron*(m_iCapacity/64)], pOverlaps, m_iPatterns);
+	// without the contribution of the neuron itself (w_ii = 0)
+	const int64_t iSelf = bState ? m_iPatterns : -static_cast<int64_t>(m_iPatterns);
+	return 2*iPos - iSum - iSelf;
+}
+
+unsigned int HFEngine::Sweep(uint64_t *pState, int32_t *pOverlaps) const {
+	const int64_t iSum = CalcOverlaps(pState, pOverlaps);
+
+	// every thread writes whole words of the state
+	unsigned int iFlips = 0;
+	#pragma omp parallel for reduction(+:iFlips)
+	for(int w = 0; w < static_cast<int>(m_iWords); w++) {
+		const uint64_t iOld 		= pState[w];
+		const unsigned int iEnd 	= std::min<unsigned int>(64, m_iNeurons-w*64);
+		uint64_t iNew = 0;
+		for(unsigned int k = 0; k < iEnd; k++) {
+			const bool bState = (iOld >> k) & 1;
+			if(CalcField(w*64+k, bState, pOverlaps, iSum) >= 0) {
+				iNew |= 1ULL << k;
+			}
+		}
+		pState[w] = iNew;
+		iFlips += m_pKernels->hamming(&iOld, &iNew, 1);
+	}
+	return iFlips;
+}
+
+void HFEngine::UpdateOverlaps(const unsigned int &iNeuron, const bool &bState, int32_t *pOverlaps, int64_t &iSum) const {
+	assert(iNeuron < m_iNeurons);
+	// m_mu changes by 2 * xi_mu,i * s_i
+	const uint64_t *pBits = &m_vNeurons[(size_t)iNeuron*(m_iCapacity/64)];
+	const uint64_t iState = bState ? 1 : 0;
+	int64_t iDiff = 0;
+	for(unsigned int p = 0; p < m_iPatterns; p++) {
+		const int32_t iVal = ( ( (pBits[p/64] >> (p%64) ) & 1) == iState) ? 2 : -2;
+		pOverlaps[p] 	+= iVal;
+		iDiff 			+= iVal;
+	}
+	iSum += iDiff;
+}
+
+int64_t HFEngine::CalcEnergy(const int32_t *pOverlaps) const {
+	int64_t iSquares = 0;
+	for(unsigned int p = 0; p < m_iPatterns; p++) {
+		iSquares += static_cast<int64_t>(pOverlaps[p]) * pOverlaps[p];
+	}
+	return -(iSquares - static_cast<int64_t>(m_iPatterns)*m_iNeurons) / 2;
+}
+
+unsigned int HFEngine::Recall(	uint64_t *pState, int32_t *pOverlaps, const unsigned int &iMaxIterations,
+								const HFUpdateFlag &flMode, uint32_t &iSeed, int64_t &iEnergy) const
+{
+	assert(iSeed != 0);
+	if(flMode & ANHFSynchronous) {
+		std::vector<uint64_t> vPrev;		// state before the last sweep
+		std::vector<uint64_t> vBefore;
+		unsigned int i = 1;
+		for(; i <= iMaxIterations; i++) {
+			vBefore.assign(pState, pState+m_iWords);
+			// the overlaps belong to the state before the sweep
+			if(Sweep(pState, pOverlaps) == 0) {
+				iEnergy = CalcEnergy(pOverlaps);
+				return i;
+			}
+			// the only other attractor is a cycle of two states
+			if(vPrev.size() == m_iWords && std::equal(pState, pState+m_iWords, vPrev.begin() ) ) {
+				break;
+			}
+			vPrev.swap(vBefore);
+		}
+		CalcOverlaps(pState, pOverlaps);
+		iEnergy = CalcEnergy(pOverlaps);
+		return std::min(i, iMaxIterations);
+	}
+
+	int64_t iSum 	= CalcOverlaps(pState, pOverlaps);
+	iEnergy 		= CalcEnergy(pOverlaps);
+
+	std::vector<unsigned int> vOrder(m_iNeurons);
+	for(unsigned int i = 0; i < m_iNeurons; i++) {
+		vOrder[i] = i;
+	}
+	for(unsigned int i = 1; i <= iMaxIterations; i++) {
+		// Fisher-Yates
+		for(unsigned int j = m_iNeurons; j > 1; j--) {
+			std::swap(vOrder[j-1], vOrder[RandXorShift(iSeed) % j]);
+		}
+
+		unsigned int iFlips = 0;
+		for(unsigned int j = 0; j < m_iNeurons; j++) {
+			const unsigned int iNeuron 	= vOrder[j];
+			const uint64_t iBit 		= 1ULL << (iNeuron%64);
+			const bool bState 			= (pState[iNeuron/64] & iBit) != 0;
+			const int64_t iField 		= CalcField(iNeuron, bState, pOverlaps, iSum);
+			if( (iField >= 0) == bState) {
+				continue;
+			}
+			// E changes by -(s_new - s_old) * h_i
+			iEnergy 				+= bState ? 2*iField : -2*iField;
+			pState[iNeuron/64] 		^= iBit;
+			UpdateOverlaps(iNeuron, !bState, pOverlaps, iSum);
+			iFlips++;
+		}
+		if(iFlips == 0) {
+			return i;
+		}
+	}
+	return iMaxIterations;
+}
@@ -82,7 +82,29 @@ void HFLayer::ClearWeights() {
 	}
 }
 
-void HFLayer::ConnectLayer(const float *pEdges, bool bAllowAdapt) {
+bool HFLayer::SetWeights(const float *pEdges) {
+	const unsigned int iLength = GetNeurons().size();
+	for(unsigned int i = 0; i < iLength; i++) {
+		if(m_lNeurons[i]->GetConsI().size() != iLength-1) {
+			return false;
+		}
+	}
+
+	// every edge is incoming edge of exactly one neuron
+	#pragma omp parallel for
+	for(int i = 0; i < static_cast<int>(iLength); i++) {
+		AbsNeuron *pNeuron = m_lNeurons[i];
+		assert(pNeuron->GetID() < iLength);
+		const float *pRow = pEdges + (size_t)pNeuron->GetID()*iLength;
+		const std::vector<Edge*> &vConsI = pNeuron->GetConsI();
+		for(unsigned int j = 0; j < vConsI.size(); j++) {
+			vConsI[j]->SetValue(pRow[vConsI[j]->GetDestinationID(pNeuron)]);
+		}
+	}
+	return true;
+}
+
+void HFLayer::ConnectLayer(const float *pEdges, bool bAllowAdapt, EdgeArena *pArena) {
 	EraseAllEdges();
 
 	AbsNeuron *pSrcNeuron;
@@ -104,13 +126,13 @@ void HFLayer::ConnectLayer(const float *pEdges, bool bAllowAdapt) {
 			}
 			else {									// .. but if there is no fail continue
 				// pSrcNeuron gets incoming connections from all other neurons
-				Connect(pDstNeuron, pSrcNeuron, pEdges[y*GetNeurons().size()+x], 0.f, bAllowAdapt);
+				Connect(pDstNeuron, pSrcNeuron, pEdges[y*GetNeurons().size()+x], 0.f, bAllowAdapt, pArena);
 			}
 		}
 	}
 }
 
-void HFLayer::ConnectLayer(bool bAllowAdapt) {
+void HFLayer::ConnectLayer(bool bAllowAdapt, EdgeArena *pArena) {
 	EraseAllEdges();
 
 	AbsNeuron *pSrcNeuron;
@@ -131,7 +153,7 @@ void HFLayer::ConnectLayer(bool bAllowAdapt) {
 					assert(pSrcNeuron != NULL);
 					assert(pDstNeuron != NULL);
 					// pSrcNeuron gets incoming connections from all other neurons
-					Connect(pDstNeuron, pSrcNeuron, 0.f, 0.f, bAllowAdapt);
+					Connect(pDstNeuron, pSrcNeuron, 0.f, 0.f, bAllowAdapt, pArena);
 				}
 			}
 		}
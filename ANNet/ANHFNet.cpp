@@ -6,26 +6,150 @@
  */
 
 #include <cassert>
+#include <algorithm>
+#include <cstring>
 
 #include <basic/ANEdge.h>
 
 #include <ANHFNeuron.h>
 #include <ANHFNet.h>
 #include <ANHFLayer.h>
+#include <ANHFEngine.h>
 
 #include <math/ANFunctions.h>
+#include <math/ANKernels.h>
+#include <math/ANRandom.h>
 
 #include <containers/ANTrainingSet.h>
 #include <containers/ANConTable.h>
 
 using namespace ANN;
 
+/*
+ * Edge length of the square tiles of the weight matrix computed by one thread
+ */
+#define ANHF_TILE 64
+/*
+ * Number of patterns of the tile panels, which stay in the cache
+ */
+#define ANHF_PATTERNS 256
+
+
+/*
+ * Local fields h = W * s, distributed over the threads
+ */
+static void
+CalcFields(const CPUKernels *pKernels, const float *pWeights, const unsigned int &iLength, const float *pState, float *pField) {
+	#pragma omp parallel for
+	for(int i = 0; i < static_cast<int>(iLength); i++) {
+		pField[i] = pKernels->dot(pWeights + (size_t)i*iLength, pState, iLength);
+	}
+}
+
+/*
+ * Recall on a dense, symmetric weight matrix (see HFNet::Recall())
+ */
+static unsigned int
+RecallDense(const CPUKernels *pKernels, const float *pWeights, const unsigned int &iLength,
+			float *pState, float *pField, const unsigned int &iMaxIterations,
+			const HFUpdateFlag &flMode, uint32_t &iSeed, double &fEnergy)
+{
+	if(flMode & ANHFSynchronous) {
+		std::vector<float> vPrev;		// state before the last sweep
+		std::vector<float> vBefore;
+		unsigned int iSweeps 	= 0;
+		bool bCycle 			= false;
+		while(true) {
+			// the fields of a sweep give the energy of the state before
+			CalcFields(pKernels, pWeights, iLength, pState, pField);
+			fEnergy = -0.5 * pKernels->dot(pState, pField, iLength);
+			if(bCycle || iSweeps == iMaxIterations) {
+				return iSweeps;
+			}
+			iSweeps++;
+
+			vBefore.assign(pState, pState+iLength);
+			unsigned int iFlips = 0;
+			for(unsigned int i = 0; i < iLength; i++) {
+				const float fVal = fcn_binary_normal(pField[i], 0.f);
+				if(fVal != pState[i]) {
+					pState[i] = fVal;
+					iFlips++;
+				}
+			}
+			if(iFlips == 0) {
+				return iSweeps;
+			}
+			// with symmetric weights the only other attractor is a cycle of two states
+			bCycle = vPrev.size() == iLength && std::equal(pState, pState+iLength, vPrev.begin() );
+			vPrev.swap(vBefore);
+		}
+	}
+
+	CalcFields(pKernels, pWeights, iLength, pState, pField);
+	fEnergy = -0.5 * pKernels->dot(pState, pField, iLength);
+
+	std::vector<unsigned int> vOrder(iLength);
+	for(unsigned int i = 0; i < iLength; i++) {
+		vOrder[i] = i;
+	}
+	for(unsigned int i = 1; i <= iMaxIterations; i++) {
+		// Fisher-Yates
+		for(unsigned int j = iLength; j > 1; j--) {
+			std::swap(vOrder[j-1], vOrder[RandXorShift(iSeed) % j]);
+		}
+
+		unsigned int iFlips = 0;
+		for(unsigned int j = 0; j < iLength; j++) {
+			const unsigned int iNeuron 	= vOrder[j];
+			const float fVal 			= fcn_binary_normal(pField[iNeuron], 0.f);
+			if(fVal == pState[iNeuron]) {
+				continue;
+			}
+			// E changes by -(s_new - s_old) * h_i, the fields of the others by (s_new - s_old) * w_ji (w_ii = 0)
+			const float fDelta 	= fVal - pState[iNeuron];
+			fEnergy 			-= fDelta * pField[iNeuron];
+			pState[iNeuron] 	= fVal;
+			pKernels->axpy(fDelta, pWeights + (size_t)iNeuron*iLength, pField, iLength);
+			iFlips++;
+		}
+		if(iFlips == 0) {
+			return i;
+		}
+	}
+	return iMaxIterations;
+}
+
+
+/*
+ * Index of the pattern in vPatterns with the same signs like pPattern (see HFEngine::Pack()), or -1
+ */
+static int
+FindPattern(const std::vector<float> &vPatterns, const unsigned int &iLength, const float *pPattern) {
+	const unsigned int iPatterns = iLength > 0 ? vPatterns.size() / iLength : 0;
+	for(unsigned int i = 0; i < iPatterns; i++) {
+		const float *pStored = &vPatterns[(size_t)i*iLength];
+		unsigned int j = 0;
+		while(j < iLength && (pStored[j] >= 0.f) == (pPattern[j] >= 0.f) ) {
+			j++;
+		}
+		if(j == iLength) {
+			return i;
+		}
+	}
+	return -1;
+}
+
 
 HFNet::HFNet() {
+	m_pEngine 		= NULL;
+	m_bHebbian 		= true;
 	m_fTypeFlag 	= ANNetHopfield;
 }
 
 HFNet::HFNet(const unsigned int &iW, const unsigned int &iH) {
+	m_pEngine 		= NULL;
+	m_bHebbian 		= true;
 	Resize(iW, iH);
 
 	m_fTypeFlag 	= ANNetHopfield;
@@ -39,7 +163,10 @@ HFNet::HFNet(AbsNet *pNet) : AbsNet(pNet)
 }
 */
 HFNet::~HFNet() {
-
+	if(m_pEngine != NULL) {
+		delete m_pEngine;
+		m_pEngine = NULL;
+	}
 }
 
 void HFNet::AddLayer(const unsigned int &iSize, const LayerTypeFlag &flType) {
@@ -49,10 +176,23 @@ void HFNet::AddLayer(const unsigned int &iSize, const LayerTypeFlag &flType) {
 void HFNet::CreateNet(const ConTable &Net) {
 	std::cout<<"Create HFNet"<<std::endl;
 
+	// the weights of the file are stored in the edges
+	if(m_pEngine != NULL) {
+		delete m_pEngine;
+		m_pEngine = NULL;
+	}
+	m_vWeights.clear();
+	// nothing is known about the imported weights
+	m_vPatterns.clear();
+	m_vStored.clear();
+	m_bHebbian = false;
+
 	/*
 	 * For all nets necessary: Create Connections (Edges)
 	 */
 	AbsNet::CreateNet(Net);
+	// the only layer is input and output layer, AbsNet::CreateNet() only sets the input layer
+	m_pOPLayer = m_pIPLayer;
 }
 
 void HFNet::Resize(const unsigned int &iW, const unsigned int &iH) {
@@ -66,54 +206,544 @@ void HFNet::Resize(const unsigned int &iW, const unsigned int &iH) {
 
 	m_pIPLayer = pIOLayer;
 	m_pOPLayer = pIOLayer;
+	m_vWeights.clear();
+	m_vPatterns.clear();
+	m_vStored.clear();
+	m_bHebbian = true;
 
-	pIOLayer->ConnectLayer(true);
+	if(m_pEngine != NULL) {
+		m_pEngine->Resize(iW*iH);
+		return;
+	}
+	pIOLayer->ConnectLayer(true, &m_EdgeArena);
 }
 
-void HFNet::PropagateFW() {
-	#pragma omp parallel for
-	for(int i = 0; i < static_cast<int>( m_pIPLayer->GetNeurons().size() ); i++) {
-		m_pIPLayer->GetNeuron(i)->CalcValue();
+bool HFNet::CanCompile() {
+	// the engine only knows bipolar patterns
+	for(size_t i = 0; i < m_vPatterns.size(); i++) {
+		if(m_vPatterns[i] != 1.f && m_vPatterns[i] != -1.f) {
+			return false;
+		}
 	}
+	// detects edges which were changed directly
+	UpdateMatrix();
+	return m_bHebbian;
 }
 
-void HFNet::CalculateMatrix() {
-	int iLength 	= (m_iHeight * m_iWidth); // == m_pIPLayer->GetNeurons().size()
-	int iMatSize 	= iLength * iLength;
-	float *pMat 	= new float[iMatSize];
-	memset(pMat, 0, sizeof(float) * iMatSize);
+bool HFNet::Compile() {
+	if(m_pEngine != NULL) {
+		return true;
+	}
+	if(m_pIPLayer == NULL) {
+		m_pEngine = new HFEngine;
+		return true;
+	}
+	if(!CanCompile() ) {
+		std::cout<<"The weights are not made of bipolar patterns, the net stays in graph mode"<<std::endl;
+		return false;
+	}
 
-	// Calculate weight matrix
-	#pragma omp parallel for
-	for(int Y = 0; Y < iLength; Y++) {		// run through every src neuron
+	const unsigned int iLength = m_pIPLayer->GetNeurons().size();
+	m_pEngine = new HFEngine;
+	m_pEngine->Resize(iLength);
+	if(!m_vPatterns.empty() ) {
+		m_pEngine->AddPatterns(&m_vPatterns[0], m_vPatterns.size() / iLength);
+	}
+	else if(m_pTrainingData != NULL || !m_vStored.empty() ) {
+		// no weights yet, so nothing gets lost
+		PropagateBW();
+	}
+	// the patterns replace the edges
+	m_pIPLayer->EraseAllEdges();
+	m_EdgeArena.Release();
+	m_vWeights.clear();
+	m_vPatterns.clear();
+	return true;
+}
+
+void HFNet::Decompile() {
+	if(m_pEngine == NULL) {
+		return;
+	}
+	HFEngine *pEngine = m_pEngine;
+	m_pEngine = NULL;
+
+	if(m_pIPLayer != NULL) {
+		const unsigned int iLength 		= pEngine->GetNrOfNeurons();
+		const unsigned int iPatterns 	= pEngine->GetNrOfPatterns();
+		std::vector<float> vPatterns((size_t)iPatterns*iLength);
+		for(unsigned int i = 0; i < iPatterns; i++) {
+			HFEngine::Unpack(pEngine->GetPattern(i), iLength, &vPatterns[(size_t)i*iLength]);
+		}
+		((HFLayer*)m_pIPLayer)->ConnectLayer(true, &m_EdgeArena);
+		CalculateMatrix(iPatterns > 0 ? &vPatterns[0] : NULL, iPatterns);
+		m_vPatterns.swap(vPatterns);
+		m_bHebbian = true;
+	}
+	delete pEngine;
+}
+
+bool HFNet::IsCompiled() const {
+	return m_pEngine != NULL;
+}
+
+unsigned int HFNet::Recall(const unsigned int &iMaxIterations, const HFUpdateFlag &flMode, float *pEnergy) {
+	assert(m_pIPLayer != NULL);
+
+	const unsigned int iLength = m_pIPLayer->GetNeurons().size();
+	if(iLength == 0) {
+		return 0;
+	}
+	std::vector<float> vValues(iLength);
+	for(unsigned int i = 0; i < iLength; i++) {
+		vValues[i] = m_pIPLayer->GetNeuron(i)->GetValue();
+	}
+
+	// rand() only seeds the generator of the update order
+	uint32_t iSeed 			= static_cast<uint32_t>(rand() ) + 1;
+	unsigned int iSweeps 	= 0;
+	double fEnergy 			= 0.;
+
+	if(m_pEngine != NULL) {
+		assert(m_pEngine->GetNrOfNeurons() == iLength);
+		m_vState.resize(m_pEngine->GetNrOfWords() );
+		m_vOverlaps.resize(m_pEngine->GetNrOfPatterns() );
+		HFEngine::Pack(&vValues[0], iLength, &m_vState[0]);
+
+		int64_t iEnergy = 0;
+		iSweeps = m_pEngine->Recall(&m_vState[0], m_vOverlaps.empty() ? NULL : &m_vOverlaps[0], iMaxIterations, flMode, iSeed, iEnergy);
+		fEnergy = static_cast<double>(iEnergy);
+
+		HFEngine::Unpack(&m_vState[0], iLength, &vValues[0]);
+	}
+	else {
+		if(m_vWeights.size() != (size_t)iLength*iLength) {
+			UpdateMatrix();
+		}
+		std::vector<float> vField(iLength);
+		iSweeps = RecallDense(Kernels::GetKernels(), &m_vWeights[0], iLength, &vValues[0], &vField[0], iMaxIterations, flMode, iSeed, fEnergy);
+	}
+
+	for(unsigned int i = 0; i < iLength; i++) {
+		m_pIPLayer->GetNeuron(i)->SetValue(vValues[i]);
+	}
+	if(pEnergy != NULL) {
+		*pEnergy = static_cast<float>(fEnergy);
+	}
+	return iSweeps;
+}
+
+void HFNet::RecallBatch(	const float *pProbes, float *pResults, const unsigned int &iProbes, unsigned int *pIterations,
+							const unsigned int &iMaxIterations, const HFUpdateFlag &flMode, float *pEnergies)
+{
+	assert(m_pIPLayer != NULL);
+	assert(pProbes != NULL && pResults != NULL);
+
+	const unsigned int iLength = m_pIPLayer->GetNeurons().size();
+	if(iProbes == 0 || iLength == 0) {
+		return;
+	}
+	if(pResults != pProbes) {
+		std::copy(pProbes, pProbes + (size_t)iProbes*iLength, pResults);
+	}
+
+	if(m_pEngine == NULL) {
+		if(m_vWeights.size() != (size_t)iLength*iLength) {
+			UpdateMatrix();
+		}
+		if(flMode & ANHFSynchronous) {
+			RecallBatchSync(pResults, iProbes, pIterations, iMaxIterations, pEnergies);
+			return;
+		}
+	}
+
+	// rand() only seeds the generators of the update order, one per probe
+	std::vector<uint32_t> vSeeds(iProbes);
+	for(unsigned int i = 0; i < iProbes; i++) {
+		vSeeds[i] = static_cast<uint32_t>(rand() ) + 1;
+	}
+	const CPUKernels *pKernels = Kernels::GetKernels();
+
+	#pragma omp parallel
+	{
+	// state buffers of the probes of this thread
+	std::vector<float> vField;
+	std::vector<uint64_t> vState;
+	std::vector<int32_t> vOverlaps;
+
+	#pragma omp for schedule(dynamic)
+	for(int i = 0; i < static_cast<int>(iProbes); i++) {
+		float *pState 			= pResults + (size_t)i*iLength;
+		unsigned int iSweeps 	= 0;
+		double fEnergy 			= 0.;
+
+		if(m_pEngine != NULL) {
+			vState.resize(m_pEngine->GetNrOfWords() );
+			vOverlaps.resize(m_pEngine->GetNrOfPatterns() );
+			HFEngine::Pack(pState, iLength, &vState[0]);
+
+			int64_t iEnergy = 0;
+			iSweeps = m_pEngine->Recall(&vState[0], vOverlaps.empty() ? NULL : &vOverlaps[0], iMaxIterations, flMode, vSeeds[i], iEnergy);
+			fEnergy = static_cast<double>(iEnergy);
+
+			HFEngine::Unpack(&vState[0], iLength, pState);
+		}
+		else {
+			vField.resize(iLength);
+			iSweeps = RecallDense(pKernels, &m_vWeights[0], iLength, pState, &vField[0], iMaxIterations, flMode, vSeeds[i], fEnergy);
+		}
+
+		if(pIterations != NULL) {
+			pIterations[i] = iSweeps;
+		}
+		if(pEnergies != NULL) {
+			pEnergies[i] = static_cast<float>(fEnergy);
+		}
+	}
+	}
+}
+
+void HFNet::RecallBatchSync(float *pStates, const unsigned int &iProbes, unsigned int *pIterations, const unsigned int &iMaxIterations, float *pEnergies) {
+	const unsigned int iLength 	= m_pIPLayer->GetNeurons().size();
+	const CPUKernels *pKernels 	= Kernels::GetKernels();
+	const float *pWeights 		= &m_vWeights[0];
+
+	std::vector<unsigned int> vActive(iProbes);
+	std::vector<unsigned int> vSweeps(iProbes, 0);
+	std::vector<char> vCycle(iProbes, 0);
+	std::vector<float> vPrev((size_t)iProbes*iLength);		// state of each probe before its last sweep
+	for(unsigned int i = 0; i < iProbes; i++) {
+		vActive[i] = i;
+	}
+
+	std::vector<float> vStates;		// states of the active probes, one after another
+	std::vector<float> vFields;
+	std::vector<char> vDone;
+	while(!vActive.empty() ) {
+		const unsigned int iActive = vActive.size();
+		vStates.resize((size_t)iActive*iLength);
+		vFields.assign((size_t)iActive*iLength, 0.f);
+		vDone.assign(iActive, 0);
+		for(unsigned int a = 0; a < iActive; a++) {
+			const float *pState = pStates + (size_t)vActive[a]*iLength;
+			std::copy(pState, pState+iLength, &vStates[(size_t)a*iLength]);
+		}
+
+		// fields of all active probes: F = S * W^T, each thread calculates the fields of a block of neurons
+		const int iBlocks = (iLength + ANHF_TILE - 1) / ANHF_TILE;
 		#pragma omp parallel for
-		for(int X = 0; X < iLength; X++) {	// run through every dst neuron
-			if(Y == X)	{					// skip neuron
-				//pMat[Y*iLength+X] = 0.f;
-				continue;
+		for(int b = 0; b < iBlocks; b++) {
+			const unsigned int iFirst 	= b*ANHF_TILE;
+			const unsigned int iSize 	= std::min<unsigned int>(ANHF_TILE, iLength-iFirst);
+			pKernels->gemm_nt(&vStates[0], pWeights + (size_t)iFirst*iLength, &vFields[iFirst], iActive, iSize, iLength, iLength, iLength, iLength);
+		}
+
+		// same steps like a synchronous Recall(), for each probe
+		#pragma omp parallel for
+		for(int a = 0; a < static_cast<int>(iActive); a++) {
+			const unsigned int iProbe 	= vActive[a];
+			const float *pOld 			= &vStates[(size_t)a*iLength];
+			const float *pField 		= &vFields[(size_t)a*iLength];
+			float *pState 				= pStates + (size_t)iProbe*iLength;
+			float *pPrev 				= &vPrev[(size_t)iProbe*iLength];
+
+			if(vCycle[iProbe] || vSweeps[iProbe] == iMaxIterations) {
+				vDone[a] = 1;
 			}
 			else {
-				float fSum = 0.f;
-				for(unsigned int i = 0; i < m_pTrainingData->GetNrElements(); i++) {
-					fSum += m_pTrainingData->GetInput(i)[X] * m_pTrainingData->GetInput(i)[Y];
+				vSweeps[iProbe]++;
+				unsigned int iFlips = 0;
+				for(unsigned int i = 0; i < iLength; i++) {
+					const float fVal = fcn_binary_normal(pField[i], 0.f);
+					if(fVal != pState[i]) {
+						pState[i] = fVal;
+						iFlips++;
+					}
+				}
+				if(iFlips == 0) {
+					vDone[a] = 1;
+				}
+				else {
+					// with symmetric weights the only other attractor is a cycle of two states
+					vCycle[iProbe] = vSweeps[iProbe] > 1 && std::equal(pState, pState+iLength, pPrev);
+					std::copy(pOld, pOld+iLength, pPrev);
 				}
-				pMat[X*iLength+Y] = fSum;
-				pMat[Y*iLength+X] = fSum;
 			}
+
+			if(vDone[a] && pEnergies != NULL) {
+				pEnergies[iProbe] = static_cast<float>(-0.5 * pKernels->dot(pOld, pField, iLength) );
+			}
+		}
+
+		unsigned int iNext = 0;
+		for(unsigned int a = 0; a < iActive; a++) {
+			if(!vDone[a]) {
+				vActive[iNext++] = vActive[a];
+			}
+		}
+		vActive.resize(iNext);
+	}
+
+	if(pIterations != NULL) {
+		std::copy(vSweeps.begin(), vSweeps.end(), pIterations);
+	}
+}
+
+void HFNet::PredictBatch(const float *pInput, float *pOutput, const unsigned int &iSamples) {
+	RecallBatch(pInput, pOutput, iSamples);
+}
+
+void HFNet::StorePattern(const float *pPattern) {
+	assert(pPattern != NULL && m_pIPLayer != NULL);
+	const unsigned int iLength = m_pIPLayer->GetNeurons().size();
+	m_vStored.insert(m_vStored.end(), pPattern, pPattern + iLength);
+
+	if(m_pEngine != NULL) {
+		m_pEngine->AddPattern(pPattern);
+		return;
+	}
+	AddOuterProduct(pPattern, 1.f);
+	m_vPatterns.insert(m_vPatterns.end(), pPattern, pPattern + iLength);
+}
+
+bool HFNet::ForgetPattern(const float *pPattern) {
+	assert(pPattern != NULL && m_pIPLayer != NULL);
+	const unsigned int iLength 	= m_pIPLayer->GetNeurons().size();
+	const int iStored 			= FindPattern(m_vStored, iLength, pPattern);
+	if(iStored >= 0) {
+		m_vStored.erase(m_vStored.begin() + (size_t)iStored*iLength, m_vStored.begin() + (size_t)(iStored+1)*iLength);
+	}
+
+	if(m_pEngine != NULL) {
+		const int iPattern = m_pEngine->FindPattern(pPattern);
+		if(iPattern < 0) {
+			return false;
 		}
+		m_pEngine->RemovePattern(iPattern);
+		return true;
+	}
+
+	const int iPattern = FindPattern(m_vPatterns, iLength, pPattern);
+	if(iPattern < 0) {
+		// the weights are no sum of patterns any more
+		AddOuterProduct(pPattern, -1.f);
+		m_bHebbian = false;
+		return true;
+	}
+	// subtract the pattern like it was added
+	std::vector<float>::iterator itBegin = m_vPatterns.begin() + (size_t)iPattern*iLength;
+	std::vector<float> vPattern(itBegin, itBegin + iLength);
+	m_vPatterns.erase(itBegin, itBegin + iLength);
+	AddOuterProduct(&vPattern[0], -1.f);
+	return true;
+}
+
+void HFNet::AddOuterProduct(const float *pPattern, const float &fScale) {
+	assert(m_pIPLayer != NULL);
+
+	const std::vector<AbsNeuron*> &vNeurons = m_pIPLayer->GetNeurons();
+	const unsigned int iLength 	= vNeurons.size();
+	const CPUKernels *pKernels 	= Kernels::GetKernels();
+	// the matrix tells Compile() whether the edges still belong to the patterns
+	if(m_vWeights.size() != (size_t)iLength*iLength) {
+		UpdateMatrix();
 	}
 
-	((HFLayer *)m_pIPLayer)->ClearWeights();
-	// Apply matrix
-	((HFLayer*)m_pIPLayer)->ConnectLayer(pMat, true);
+	// each thread changes the incoming edges (and the matrix row) of its neurons
+	#pragma omp parallel for
+	for(int i = 0; i < static_cast<int>(iLength); i++) {
+		AbsNeuron *pNeuron 		= vNeurons[i];
+		const unsigned int iID 	= pNeuron->GetID();
+		assert(iID < iLength);
+		const float fVal 		= fScale * pPattern[iID];
 
-	// free memory
-	delete [] pMat;
+		const std::vector<Edge*> &vConsI = pNeuron->GetConsI();
+		for(unsigned int j = 0; j < vConsI.size(); j++) {
+			Edge *pEdge = vConsI[j];
+			pEdge->SetValue(pEdge->GetValue() + fVal * pPattern[pEdge->GetDestinationID(pNeuron)]);
+		}
 
+		float *pRow = &m_vWeights[(size_t)iID*iLength];
+		const float fDiagonal = pRow[iID];
+		pKernels->axpy(fVal, pPattern, pRow, iLength);
+		pRow[iID] = fDiagonal;
+	}
+}
+
+void HFNet::ExpToFS(std::string path, const FileFormatFlag &fFormat) {
+	// the file format stores the weights in the edges
+	const bool bCompiled = IsCompiled();
+	Decompile();
+	AbsNet::ExpToFS(path, fFormat);
+	if(bCompiled) {
+		Compile();
+	}
+}
+
+void HFNet::UpdateMatrix() {
+	assert(m_pIPLayer != NULL);
+
+	const std::vector<AbsNeuron*> &vNeurons = m_pIPLayer->GetNeurons();
+	const unsigned int iLength = vNeurons.size();
+	std::vector<float> vMat((size_t)iLength*iLength, 0.f);
+
+	#pragma omp parallel for
+	for(int i = 0; i < static_cast<int>(iLength); i++) {
+		AbsNeuron *pNeuron = vNeurons[i];
+		assert(pNeuron->GetID() < iLength);
+		float *pRow = &vMat[(size_t)pNeuron->GetID()*iLength];
+		const std::vector<Edge*> &vConsI = pNeuron->GetConsI();
+		for(unsigned int j = 0; j < vConsI.size(); j++) {
+			pRow[vConsI[j]->GetDestinationID(pNeuron)] = vConsI[j]->GetValue();
+		}
+	}
+
+	// edges changed directly do not belong to the patterns any more
+	if(m_bHebbian) {
+		if(m_vWeights.size() == vMat.size() ) {
+			m_bHebbian = (m_vWeights == vMat);
+		}
+		else {
+			m_bHebbian = m_vPatterns.empty() && std::count(vMat.begin(), vMat.end(), 0.f) == static_cast<std::ptrdiff_t>(vMat.size() );
+		}
+	}
+	m_vWeights.swap(vMat);
+}
+
+void HFNet::PropagateFW() {
+	if(m_pEngine != NULL) {
+		const unsigned int iLength = m_pIPLayer->GetNeurons().size();
+		assert(m_pEngine->GetNrOfNeurons() == iLength);
+
+		std::vector<float> vValues(iLength);
+		for(unsigned int i = 0; i < iLength; i++) {
+			vValues[i] = m_pIPLayer->GetNeuron(i)->GetValue();
+		}
+		m_vState.resize(m_pEngine->GetNrOfWords() );
+		m_vOverlaps.resize(m_pEngine->GetNrOfPatterns() );
+		HFEngine::Pack(&vValues[0], iLength, &m_vState[0]);
+
+		m_pEngine->Sweep(&m_vState[0], m_vOverlaps.empty() ? NULL : &m_vOverlaps[0]);
+
+		HFEngine::Unpack(&m_vState[0], iLength, &vValues[0]);
+		for(unsigned int i = 0; i < iLength; i++) {
+			m_pIPLayer->GetNeuron(i)->SetValue(vValues[i]);
+		}
+		return;
+	}
+
+	#pragma omp parallel for
+	for(int i = 0; i < static_cast<int>( m_pIPLayer->GetNeurons().size() ); i++) {
+		m_pIPLayer->GetNeuron(i)->CalcValue();
+	}
+}
+
+void HFNet::CalculateMatrix(const float *pPatterns, const unsigned int &iPatterns) {
+	assert(m_pIPLayer != NULL);
+
+	const unsigned int iLength = m_pIPLayer->GetNeurons().size(); // == m_iHeight * m_iWidth
+	if(iLength == 0) {
+		return;
+	}
+	std::vector<float> vMat((size_t)iLength*iLength, 0.f);
+
+	if(iPatterns > 0) {
+		// W = X^T * X with the patterns one after another (X: iPatterns * iLength)
+		const float *pX = pPatterns;
+
+		// tiles of the upper triangle, the lower one is a copy
+		std::vector<std::pair<unsigned int, unsigned int> > vTiles;
+		for(unsigned int y = 0; y < iLength; y += ANHF_TILE) {
+			for(unsigned int x = y; x < iLength; x += ANHF_TILE) {
+				vTiles.push_back(std::pair<unsigned int, unsigned int>(y, x) );
+			}
+		}
+
+		const CPUKernels *pKernels = Kernels::GetKernels();
+		float *pMat = &vMat[0];
+
+		#pragma omp parallel
+		{
+		// panels of the pattern block, packed for the kernel (the patterns are iLength floats apart)
+		std::vector<float> vPanelA(ANHF_TILE*ANHF_PATTERNS);	// transposed: neurons * patterns
+		std::vector<float> vPanelB(ANHF_PATTERNS*ANHF_TILE);	// patterns * neurons
+
+		#pragma omp for
+		for(int t = 0; t < static_cast<int>(vTiles.size() ); t++) {
+			const unsigned int iY = vTiles[t].first;
+			const unsigned int iX = vTiles[t].second;
+			const unsigned int iH = std::min<unsigned int>(ANHF_TILE, iLength-iY);
+			const unsigned int iW = std::min<unsigned int>(ANHF_TILE, iLength-iX);
+
+			// W[Y..Y+H][X..X+W] = X[:, Y..Y+H]^T * X[:, X..X+W]
+			for(unsigned int k0 = 0; k0 < iPatterns; k0 += ANHF_PATTERNS) {
+				const unsigned int iK = std::min<unsigned int>(ANHF_PATTERNS, iPatterns-k0);
+				for(unsigned int k = 0; k < iK; k++) {
+					const float *pRow = pX + (size_t)(k0+k)*iLength;
+					for(unsigned int y = 0; y < iH; y++) {
+						vPanelA[y*iK+k] = pRow[iY+y];
+					}
+					memcpy(&vPanelB[k*iW], pRow+iX, iW*sizeof(float) );
+				}
+				pKernels->gemm_nn(&vPanelA[0], &vPanelB[0], pMat + (size_t)iY*iLength+iX, iH, iW, iK, iK, iW, iLength);
+			}
+
+			for(unsigned int y = iY; y < iY+iH; y++) {
+				const unsigned int iBegin = (iX == iY) ? y+1 : iX;
+				for(unsigned int x = iBegin; x < iX+iW; x++) {
+					pMat[(size_t)x*iLength+y] = pMat[(size_t)y*iLength+x];
+				}
+				if(iX == iY) {
+					pMat[(size_t)y*iLength+y] = 0.f;	// no connection of a neuron with itself
+				}
+			}
+		}
+		}
+	}
+
+	// Apply matrix to the existing edges, they are only replaced if the layer is not fully connected
+	if(!((HFLayer*)m_pIPLayer)->SetWeights(&vMat[0]) ) {
+		m_pIPLayer->EraseAllEdges();
+		m_EdgeArena.Release();
+		((HFLayer*)m_pIPLayer)->ConnectLayer(&vMat[0], true, &m_EdgeArena);
+	}
+	// kept for Recall()
+	m_vWeights.swap(vMat);
 }
 
 void HFNet::PropagateBW() {
-	CalculateMatrix();
+	assert(m_pIPLayer != NULL);
+
+	const unsigned int iLength 	= m_pIPLayer->GetNeurons().size();
+	unsigned int iPatterns 		= 0;
+	const float *pPatterns 		= NULL;
+	if(m_pTrainingData != NULL) {
+		iPatterns = m_pTrainingData->GetNrElements();
+		// the patterns have to be one after another
+		pPatterns = m_pTrainingData->GetInputBuffer();
+		if(iPatterns > 0) {
+			assert(m_pTrainingData->GetInput(iPatterns-1).GetData() == pPatterns + (size_t)(iPatterns-1)*iLength);
+			assert(m_pTrainingData->GetInput(iPatterns-1).size() == iLength);
+		}
+	}
+	const unsigned int iStored = iLength > 0 ? m_vStored.size() / iLength : 0;
+
+	if(m_pEngine != NULL) {
+		m_pEngine->Resize(iLength);
+		if(iPatterns > 0) {
+			m_pEngine->AddPatterns(pPatterns, iPatterns);
+		}
+		if(iStored > 0) {
+			m_pEngine->AddPatterns(&m_vStored[0], iStored);
+		}
+	}
+	else {
+		// training set and stored patterns one after another
+		m_vPatterns.assign(pPatterns, pPatterns + (size_t)iPatterns*iLength);
+		m_vPatterns.insert(m_vPatterns.end(), m_vStored.begin(), m_vStored.end() );
+		CalculateMatrix(m_vPatterns.empty() ? NULL : &m_vPatterns[0], iPatterns + iStored);
+		m_bHebbian = true;
+	}
 }
 
 void HFNet::SetInput(float *pInputArray) {
@@ -24,7 +24,8 @@ HFNeuron::~HFNeuron() {
 }
 
 void HFNeuron::CalcValue() {
-	if(GetConsI().size() == 0)
+	const std::vector<Edge*> &vConsI = GetConsI();
+	if(vConsI.size() == 0)
 		return;
 
 	/*
@@ -32,9 +33,9 @@ void HFNeuron::CalcValue() {
 	 */
 	HFNeuron *from 	= NULL;
 	float fVal 			= 0.f;
-	for(unsigned int i = 0; i < GetConsI().size(); i++) {
-		from = (HFNeuron *)GetConI(i)->GetDestination(this);
-		fVal += from->GetValue() * GetConI(i)->GetValue();
+	for(unsigned int i = 0; i < vConsI.size(); i++) {
+		from = (HFNeuron *)vConsI[i]->GetDestination(this);
+		fVal += from->GetValue() * vConsI[i]->GetValue();
 	}
 
 	fVal = GetTransfFunction()->normal( fVal, 0 );
@@ -0,0 +1,834 @@
+/*
+ * ANKernels.cpp
+ *
+ *  Created on: 17.10.2026
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+//own classes
+#include <math/ANKernels.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	#define ANN_X86_DISPATCH
+	#include <immintrin.h>
+#endif
+
+using namespace ANN;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+/*
+ * Scalar fallback
+ */
+//////////////////////////////////////////////////////////////////////////////////////////////
+static float
+scalar_dot(const float *pX, const float *pY, const unsigned int &iSize) {
+	float fSum = 0.f;
+	for(unsigned int i = 0; i < iSize; i++) {
+		fSum += pX[i] * pY[i];
+	}
+	return fSum;
+}
+
+static void
+scalar_gemv(const float *pA, const float *pX, float *pY, const unsigned int &iRows, const unsigned int &iCols) {
+	for(unsigned int j = 0; j < iRows; j++) {
+		pY[j] = scalar_dot(&pA[j*iCols], pX, iCols);
+	}
+}
+
+static void
+scalar_axpy(const float &fAlpha, const float *pX, float *pY, const unsigned int &iSize) {
+	for(unsigned int i = 0; i < iSize; i++) {
+		pY[i] += fAlpha * pX[i];
+	}
+}
+
+static void
+scalar_adapt(const float &fDelta, const float &fRate, const float &fDecay, const float &fMomentum,
+		const float *pX, const float *pMask, float *pW, float *pM, float *pErr, const unsigned int &iSize)
+{
+	for(unsigned int i = 0; i < iSize; i++) {
+		pErr[i] += fDelta * pW[i];
+
+		if(pMask != NULL && pMask[i] == 0.f) {
+			continue;
+		}
+		float fVal = fRate * pX[i] - fDecay * pW[i] + fMomentum * pM[i];
+		pM[i] = fVal;
+		pW[i] += fVal;
+	}
+}
+
+static void
+scalar_update(const float &fRate, const float &fDecay, const float &fMomentum,
+		const float *pG, const float *pMask, float *pW, float *pM, const unsigned int &iSize)
+{
+	for(unsigned int i = 0; i < iSize; i++) {
+		if(pMask != NULL && pMask[i] == 0.f) {
+			continue;
+		}
+		float fVal = fRate * pG[i] - fDecay * pW[i] + fMomentum * pM[i];
+		pM[i] = fVal;
+		pW[i] += fVal;
+	}
+}
+
+static void
+scalar_gemm_nt(const float *pA, const float *pB, float *pC,
+		const unsigned int &iM, const unsigned int &iN, const unsigned int &iK,
+		const unsigned int &iLdA, const unsigned int &iLdB, const unsigned int &iLdC)
+{
+	for(unsigned int i = 0; i < iM; i++) {
+		for(unsigned int j = 0; j < iN; j++) {
+			pC[i*iLdC+j] += scalar_dot(&pA[i*iLdA], &pB[j*iLdB], iK);
+		}
+	}
+}
+
+/*
+ * C = C + A B, whereas A(i,k) is pA[i*iStrideM + k*iStrideK]
+ */
+static void
+scalar_gemm_axpy(const float *pA, const float *pB, float *pC,
+		const unsigned int &iM, const unsigned int &iN, const unsigned int &iK,
+		const unsigned int &iStrideM, const unsigned int &iStrideK, const unsigned int &iLdB, const unsigned int &iLdC)
+{
+	for(unsigned int i = 0; i < iM; i++) {
+		for(unsigned int k = 0; k < iK; k++) {
+			scalar_axpy(pA[i*iStrideM+k*iStrideK], &pB[k*iLdB], &pC[i*iLdC], iN);
+		}
+	}
+}
+
+static void
+scalar_gemm_nn(const float *pA, const float *pB, float *pC,
+		const unsigned int &iM, const unsigned int &iN, const unsigned int &iK,
+		const unsigned int &iLdA, const unsigned int &iLdB, const unsigned int &iLdC)
+{
+	scalar_gemm_axpy(pA, pB, pC, iM, iN, iK, iLdA, 1, iLdB, iLdC);
+}
+
+static void
+scalar_gemm_tn(const float *pA, const float *pB, float *pC,
+		const unsigned int &iM, const unsigned int &iN, const unsigned int &iK,
+		const unsigned int &iLdA, const unsigned int &iLdB, const unsigned int &iLdC)
+{
+	scalar_gemm_axpy(pA, pB, pC, iM, iN, iK, 1, iLdA, iLdB, iLdC);
+}
+
+/*
+ * Counts the set bits in parallel within the word (no popcnt instruction needed)
+ */
+static unsigned int
+scalar_popcount(uint64_t iX) {
+	iX = iX - ((iX >> 1) & 0x5555555555555555ULL);
+	iX = (iX & 0x3333333333333333ULL) + ((iX >> 2) & 0x3333333333333333ULL);
+	iX = (iX + (iX >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+	return static_cast<unsigned int>( (iX * 0x0101010101010101ULL) >> 56);
+}
+
+static unsigned int
+scalar_hamming(const uint64_t *pX, const uint64_t *pY, const unsigned int &iWords) {
+	unsigned int iSum = 0;
+	for(unsigned int i = 0; i < iWords; i++) {
+		iSum += scalar_popcount(pX[i] ^ pY[i]);
+	}
+	return iSum;
+}
+
+static int64_t
+scalar_masked_sum(const uint64_t *pMask, const int32_t *pX, const unsigned int &iSize) {
+	int64_t iSum = 0;
+	for(unsigned int i = 0; i < iSize; i++) {
+		if( (pMask[i/64] >> (i%64) ) & 1) {
+			iSum += pX[i];
+		}
+	}
+	return iSum;
+}
+
+#ifdef ANN_X86_DISPATCH
+//////////////////////////////////////////////////////////////////////////////////////////////
+/*
+ * AVX2 + FMA
+ */
+//////////////////////////////////////////////////////////////////////////////////////////////
+__attribute__((target("avx2,fma"))) static inline float
+avx2_hsum(__m256 vSum) {
+	__m128 vLow 	= _mm256_castps256_ps128(vSum);
+	__m128 vHigh 	= _mm256_extractf128_ps(vSum, 1);
+	vLow 			= _mm_add_ps(vLow, vHigh);
+	vHigh 			= _mm_movehl_ps(vHigh, vLow);
+	vLow 			= _mm_add_ps(vLow, vHigh);
+	vHigh 			= _mm_shuffle_ps(vLow, vLow, 0x1);
+	vLow 			= _mm_add_ss(vLow, vHigh);
+	return _mm_cvtss_f32(vLow);
+}
+
+__attribute__((target("avx2,fma"))) static float
+avx2_dot(const float *pX, const float *pY, const unsigned int &iSize) {
+	__m256 vSum0 = _mm256_setzero_ps();
+	__m256 vSum1 = _mm256_setzero_ps();
+
+	unsigned int i = 0;
+	for(; i+16 <= iSize; i += 16) {
+		vSum0 = _mm256_fmadd_ps(_mm256_loadu_ps(&pX[i]), 	_mm256_loadu_ps(&pY[i]), 	vSum0);
+		vSum1 = _mm256_fmadd_ps(_mm256_loadu_ps(&pX[i+8]), 	_mm256_loadu_ps(&pY[i+8]), 	vSum1);
+	}
+	for(; i+8 <= iSize; i += 8) {
+		vSum0 = _mm256_fmadd_ps(_mm256_loadu_ps(&pX[i]), 	_mm256_loadu_ps(&pY[i]), 	vSum0);
+	}
+
+	float fSum = avx2_hsum(_mm256_add_ps(vSum0, vSum1) );
+	for(; i < iSize; i++) {
+		fSum += pX[i] * pY[i];
+	}
+	return fSum;
+}
+
+__attribute__((target("avx2,fma"))) static void
+avx2_gemv(const float *pA, const float *pX, float *pY, const unsigned int &iRows, const unsigned int &iCols) {
+	for(unsigned int j = 0; j < iRows; j++) {
+		pY[j] = avx2_dot(&pA[j*iCols], pX, iCols);
+	}
+}
+
+__attribute__((target("avx2,fma"))) static void
+avx2_axpy(const float &fAlpha, const float *pX, float *pY, const unsigned int &iSize) {
+	__m256 vAlpha = _mm256_set1_ps(fAlpha);
+
+	unsigned int i = 0;
+	for(; i+8 <= iSize; i += 8) {
+		_mm256_storeu_ps(&pY[i], _mm256_fmadd_ps(vAlpha, _mm256_loadu_ps(&pX[i]), _mm256_loadu_ps(&pY[i]) ) );
+	}
+	for(; i < iSize; i++) {
+		pY[i] += fAlpha * pX[i];
+	}
+}
+
+__attribute__((target("avx2,fma"))) static void
+avx2_adapt(const float &fDelta, const float &fRate, const float &fDecay, const float &fMomentum,
+		const float *pX, const float *pMask, float *pW, float *pM, float *pErr, const unsigned int &iSize)
+{
+	__m256 vDelta 	= _mm256_set1_ps(fDelta);
+	__m256 vRate 	= _mm256_set1_ps(fRate);
+	__m256 vDecay 	= _mm256_set1_ps(-fDecay);
+	__m256 vMom 	= _mm256_set1_ps(fMomentum);
+	__m256 vZero 	= _mm256_setzero_ps();
+
+	unsigned int i = 0;
+	for(; i+8 <= iSize; i += 8) {
+		__m256 vW = _mm256_loadu_ps(&pW[i]);
+		__m256 vM = _mm256_loadu_ps(&pM[i]);
+		_mm256_storeu_ps(&pErr[i], _mm256_fmadd_ps(vDelta, vW, _mm256_loadu_ps(&pErr[i]) ) );
+
+		__m256 vVal = _mm256_mul_ps(vRate, _mm256_loadu_ps(&pX[i]) );
+		vVal = _mm256_fmadd_ps(vDecay, vW, vVal);
+		vVal = _mm256_fmadd_ps(vMom, vM, vVal);
+
+		__m256 vNewW = _mm256_add_ps(vW, vVal);
+		if(pMask != NULL) {
+			// keep the old values where the mask is zero
+			__m256 vSel = _mm256_cmp_ps(_mm256_loadu_ps(&pMask[i]), vZero, _CMP_NEQ_UQ);
+			vVal 	= _mm256_blendv_ps(vM, vVal, vSel);
+			vNewW 	= _mm256_blendv_ps(vW, vNewW, vSel);
+		}
+		_mm256_storeu_ps(&pM[i], vVal);
+		_mm256_storeu_ps(&pW[i], vNewW);
+	}
+	if(i < iSize) {
+		scalar_adapt(fDelta, fRate, fDecay, fMomentum,
+				&pX[i], pMask ? &pMask[i] : NULL, &pW[i], &pM[i], &pErr[i], iSize-i);
+	}
+}
+
+__attribute__((target("avx2,fma"))) static void
+avx2_update(const float &fRate, const float &fDecay, const float &fMomentum,
+		const float *pG, const float *pMask, float *pW, float *pM, const unsigned int &iSize)
+{
+	__m256 vRate 	= _mm256_set1_ps(fRate);
+	__m256 vDecay 	= _mm256_set1_ps(-fDecay);
+	__m256 vMom 	= _mm256_set1_ps(fMomentum);
+	__m256 vZero 	= _mm256_setzero_ps();
+
+	unsigned int i = 0;
+	for(; i+8 <= iSize; i += 8) {
+		__m256 vW = _mm256_loadu_ps(&pW[i]);
+		__m256 vM = _mm256_loadu_ps(&pM[i]);
+
+		__m256 vVal = _mm256_mul_ps(vRate, _mm256_loadu_ps(&pG[i]) );
+		vVal = _mm256_fmadd_ps(vDecay, vW, vVal);
+		vVal = _mm256_fmadd_ps(vMom, vM, vVal);
+
+		__m256 vNewW = _mm256_add_ps(vW, vVal);
+		if(pMask != NULL) {
+			__m256 vSel = _mm256_cmp_ps(_mm256_loadu_ps(&pMask[i]), vZero, _CMP_NEQ_UQ);
+			vVal 	= _mm256_blendv_ps(vM, vVal, vSel);
+			vNewW 	= _mm256_blendv_ps(vW, vNewW, vSel);
+		}
+		_mm256_storeu_ps(&pM[i], vVal);
+		_mm256_storeu_ps(&pW[i], vNewW);
+	}
+	if(i < iSize) {
+		scalar_update(fRate, fDecay, fMomentum, &pG[i], pMask ? &pMask[i] : NULL, &pW[i], &pM[i], iSize-i);
+	}
+}
+
+/*
+ * Four rows of B share each load of a row of A
+ */
+__attribute__((target("avx2,fma"))) static void
+avx2_gemm_nt(const float *pA, const float *pB, float *pC,
+		const unsigned int &iM, const unsigned int &iN, const unsigned int &iK,
+		const unsigned int &iLdA, const unsigned int &iLdB, const unsigned int &iLdC)
+{
+	unsigned int j = 0;
+	for(; j+4 <= iN; j += 4) {
+		const float *pB0 = &pB[j*iLdB];
+		const float *pB1 = pB0 + iLdB;
+		const float *pB2 = pB1 + iLdB;
+		const float *pB3 = pB2 + iLdB;
+
+		for(unsigned int i = 0; i < iM; i++) {
+			const float *pAi = &pA[i*iLdA];
+			__m256 vSum0 = _mm256_setzero_ps();
+			__m256 vSum1 = _mm256_setzero_ps();
+			__m256 vSum2 = _mm256_setzero_ps();
+			__m256 vSum3 = _mm256_setzero_ps();
+
+			unsigned int k = 0;
+			for(; k+8 <= iK; k += 8) {
+				__m256 vA = _mm256_loadu_ps(&pAi[k]);
+				vSum0 = _mm256_fmadd_ps(vA, _mm256_loadu_ps(&pB0[k]), vSum0);
+				vSum1 = _mm256_fmadd_ps(vA, _mm256_loadu_ps(&pB1[k]), vSum1);
+				vSum2 = _mm256_fmadd_ps(vA, _mm256_loadu_ps(&pB2[k]), vSum2);
+				vSum3 = _mm256_fmadd_ps(vA, _mm256_loadu_ps(&pB3[k]), vSum3);
+			}
+			float fSum0 = avx2_hsum(vSum0);
+			float fSum1 = avx2_hsum(vSum1);
+			float fSum2 = avx2_hsum(vSum2);
+			float fSum3 = avx2_hsum(vSum3);
+			for(; k < iK; k++) {
+				fSum0 += pAi[k] * pB0[k];
+				fSum1 += pAi[k] * pB1[k];
+				fSum2 += pAi[k] * pB2[k];
+				fSum3 += pAi[k] * pB3[k];
+			}
+			float *pCi = &pC[i*iLdC+j];
+			pCi[0] += fSum0;
+			pCi[1] += fSum1;
+			pCi[2] += fSum2;
+			pCi[3] += fSum3;
+		}
+	}
+	for(; j < iN; j++) {
+		for(unsigned int i = 0; i < iM; i++) {
+			pC[i*iLdC+j] += avx2_dot(&pA[i*iLdA], &pB[j*iLdB], iK);
+		}
+	}
+}
+
+/*
+ * C = C + A B, whereas A(i,k) is pA[i*iStrideM + k*iStrideK].
+ * Four rows of B get accumulated with each load/store of a row of C.
+ */
+__attribute__((target("avx2,fma"))) static void
+avx2_gemm_axpy(const float *pA, const float *pB, float *pC,
+		const unsigned int &iM, const unsigned int &iN, const unsigned int &iK,
+		const unsigned int &iStrideM, const unsigned int &iStrideK, const unsigned int &iLdB, const unsigned int &iLdC)
+{
+	for(unsigned int i = 0; i < iM; i++) {
+		const float *pAi 	= &pA[i*iStrideM];
+		float *pCi 			= &pC[i*iLdC];
+
+		unsigned int k = 0;
+		for(; k+4 <= iK; k += 4) {
+			float fA0 = pAi[k*iStrideK];
+			float fA1 = pAi[(k+1)*iStrideK];
+			float fA2 = pAi[(k+2)*iStrideK];
+			float fA3 = pAi[(k+3)*iStrideK];
+			__m256 vA0 = _mm256_set1_ps(fA0);
+			__m256 vA1 = _mm256_set1_ps(fA1);
+			__m256 vA2 = _mm256_set1_ps(fA2);
+			__m256 vA3 = _mm256_set1_ps(fA3);
+
+			const float *pB0 = &pB[k*iLdB];
+			const float *pB1 = pB0 + iLdB;
+			const float *pB2 = pB1 + iLdB;
+			const float *pB3 = pB2 + iLdB;
+
+			unsigned int n = 0;
+			for(; n+8 <= iN; n += 8) {
+				__m256 vC = _mm256_loadu_ps(&pCi[n]);
+				vC = _mm256_fmadd_ps(vA0, _mm256_loadu_ps(&pB0[n]), vC);
+				vC = _mm256_fmadd_ps(vA1, _mm256_loadu_ps(&pB1[n]), vC);
+				vC = _mm256_fmadd_ps(vA2, _mm256_loadu_ps(&pB2[n]), vC);
+				vC = _mm256_fmadd_ps(vA3, _mm256_loadu_ps(&pB3[n]), vC);
+				_mm256_storeu_ps(&pCi[n], vC);
+			}
+			for(; n < iN; n++) {
+				pCi[n] += fA0 * pB0[n] + fA1 * pB1[n] + fA2 * pB2[n] + fA3 * pB3[n];
+			}
+		}
+		for(; k < iK; k++) {
+			avx2_axpy(pAi[k*iStrideK], &pB[k*iLdB], pCi, iN);
+		}
+	}
+}
+
+__attribute__((target("avx2,fma"))) static void
+avx2_gemm_nn(const float *pA, const float *pB, float *pC,
+		const unsigned int &iM, const unsigned int &iN, const unsigned int &iK,
+		const unsigned int &iLdA, const unsigned int &iLdB, const unsigned int &iLdC)
+{
+	avx2_gemm_axpy(pA, pB, pC, iM, iN, iK, iLdA, 1, iLdB, iLdC);
+}
+
+__attribute__((target("avx2,fma"))) static void
+avx2_gemm_tn(const float *pA, const float *pB, float *pC,
+		const unsigned int &iM, const unsigned int &iN, const unsigned int &iK,
+		const unsigned int &iLdA, const unsigned int &iLdB, const unsigned int &iLdC)
+{
+	avx2_gemm_axpy(pA, pB, pC, iM, iN, iK, 1, iLdA, iLdB, iLdC);
+}
+
+__attribute__((target("avx2,popcnt"))) static unsigned int
+avx2_hamming(const uint64_t *pX, const uint64_t *pY, const unsigned int &iWords) {
+	uint64_t iSum0 = 0, iSum1 = 0, iSum2 = 0, iSum3 = 0;
+	unsigned int i = 0;
+	for(; i+4 <= iWords; i += 4) {
+		iSum0 += _mm_popcnt_u64(pX[i] ^ pY[i]);
+		iSum1 += _mm_popcnt_u64(pX[i+1] ^ pY[i+1]);
+		iSum2 += _mm_popcnt_u64(pX[i+2] ^ pY[i+2]);
+		iSum3 += _mm_popcnt_u64(pX[i+3] ^ pY[i+3]);
+	}
+	for(; i < iWords; i++) {
+		iSum0 += _mm_popcnt_u64(pX[i] ^ pY[i]);
+	}
+	return static_cast<unsigned int>(iSum0 + iSum1 + iSum2 + iSum3);
+}
+
+/*
+ * Each byte of the mask gets expanded to a lane mask of eight integers.
+ * The 32 bit lanes are widened after every 64 elements, so they can not overflow.
+ */
+__attribute__((target("avx2"))) static int64_t
+avx2_masked_sum(const uint64_t *pMask, const int32_t *pX, const unsigned int &iSize) {
+	const __m256i vBits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+	__m256i vSum64 		= _mm256_setzero_si256();
+
+	unsigned int i = 0;
+	for(; i+64 <= iSize; i += 64) {
+		const uint64_t iWord = pMask[i/64];
+		__m256i vSum = _mm256_setzero_si256();
+		for(unsigned int j = 0; j < 64; j += 8) {
+			__m256i vByte = _mm256_set1_epi32(static_cast<int>( (iWord >> j) & 0xFF) );
+			__m256i vLane = _mm256_cmpeq_epi32(_mm256_and_si256(vByte, vBits), vBits);
+			vSum = _mm256_add_epi32(vSum, _mm256_and_si256(vLane, _mm256_loadu_si256((const __m256i*)&pX[i+j]) ) );
+		}
+		vSum64 = _mm256_add_epi64(vSum64, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(vSum) ) );
+		vSum64 = _mm256_add_epi64(vSum64, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(vSum, 1) ) );
+	}
+
+	int64_t pSum[4];
+	_mm256_storeu_si256((__m256i*)pSum, vSum64);
+	int64_t iSum = pSum[0] + pSum[1] + pSum[2] + pSum[3];
+	for(; i < iSize; i++) {
+		if( (pMask[i/64] >> (i%64) ) & 1) {
+			iSum += pX[i];
+		}
+	}
+	return iSum;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+/*
+ * AVX-512F
+ */
+//////////////////////////////////////////////////////////////////////////////////////////////
+/*
+ * _mm512_reduce_add_ps() extracts the halves with an undefined pass through vector,
+ * which GCC reports as (maybe) uninitialized with -Wall. The lanes get summed from memory instead.
+ */
+__attribute__((target("avx512f"))) static inline float
+avx512_hsum(__m512 vSum) {
+	float pSum[16];
+	_mm512_storeu_ps(pSum, vSum);
+	for(unsigned int i = 8; i > 0; i /= 2) {
+		for(unsigned int j = 0; j < i; j++) {
+			pSum[j] += pSum[j+i];
+		}
+	}
+	return pSum[0];
+}
+
+__attribute__((target("avx512f"))) static float
+avx512_dot(const float *pX, const float *pY, const unsigned int &iSize) {
+	__m512 vSum0 = _mm512_setzero_ps();
+	__m512 vSum1 = _mm512_setzero_ps();
+
+	unsigned int i = 0;
+	for(; i+32 <= iSize; i += 32) {
+		vSum0 = _mm512_fmadd_ps(_mm512_loadu_ps(&pX[i]), 	_mm512_loadu_ps(&pY[i]), 	vSum0);
+		vSum1 = _mm512_fmadd_ps(_mm512_loadu_ps(&pX[i+16]), _mm512_loadu_ps(&pY[i+16]), vSum1);
+	}
+	vSum0 = _mm512_add_ps(vSum0, vSum1);
+	if(i+16 <= iSize) {
+		vSum0 = _mm512_fmadd_ps(_mm512_loadu_ps(&pX[i]), _mm512_loadu_ps(&pY[i]), vSum0);
+		i += 16;
+	}
+	// remainder with a masked load
+	if(i < iSize) {
+		__mmask16 kRest = (__mmask16)((1u << (iSize-i)) - 1u);
+		vSum0 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(kRest, &pX[i]), _mm512_maskz_loadu_ps(kRest, &pY[i]), vSum0);
+	}
+	return avx512_hsum(vSum0);
+}
+
+__attribute__((target("avx512f"))) static void
+avx512_gemv(const float *pA, const float *pX, float *pY, const unsigned int &iRows, const unsigned int &iCols) {
+	for(unsigned int j = 0; j < iRows; j++) {
+		pY[j] = avx512_dot(&pA[j*iCols], pX, iCols);
+	}
+}
+
+__attribute__((target("avx512f"))) static void
+avx512_axpy(const float &fAlpha, const float *pX, float *pY, const unsigned int &iSize) {
+	__m512 vAlpha = _mm512_set1_ps(fAlpha);
+
+	for(unsigned int i = 0; i < iSize; i += 16) {
+		__mmask16 kSel = (iSize-i >= 16) ? (__mmask16)0xFFFF : (__mmask16)((1u << (iSize-i)) - 1u);
+		__m512 vY = _mm512_maskz_loadu_ps(kSel, &pY[i]);
+		vY = _mm512_fmadd_ps(vAlpha, _mm512_maskz_loadu_ps(kSel, &pX[i]), vY);
+		_mm512_mask_storeu_ps(&pY[i], kSel, vY);
+	}
+}
+
+__attribute__((target("avx512f"))) static void
+avx512_adapt(const float &fDelta, const float &fRate, const float &fDecay, const float &fMomentum,
+		const float *pX, const float *pMask, float *pW, float *pM, float *pErr, const unsigned int &iSize)
+{
+	__m512 vDelta 	= _mm512_set1_ps(fDelta);
+	__m512 vRate 	= _mm512_set1_ps(fRate);
+	__m512 vDecay 	= _mm512_set1_ps(-fDecay);
+	__m512 vMom 	= _mm512_set1_ps(fMomentum);
+	__m512 vZero 	= _mm512_setzero_ps();
+
+	for(unsigned int i = 0; i < iSize; i += 16) {
+		__mmask16 kSel = (iSize-i >= 16) ? (__mmask16)0xFFFF : (__mmask16)((1u << (iSize-i)) - 1u);
+
+		__m512 vW = _mm512_maskz_loadu_ps(kSel, &pW[i]);
+		__m512 vM = _mm512_maskz_loadu_ps(kSel, &pM[i]);
+		__m512 vErr = _mm512_fmadd_ps(vDelta, vW, _mm512_maskz_loadu_ps(kSel, &pErr[i]) );
+		_mm512_mask_storeu_ps(&pErr[i], kSel, vErr);
+
+		__m512 vVal = _mm512_mul_ps(vRate, _mm512_maskz_loadu_ps(kSel, &pX[i]) );
+		vVal = _mm512_fmadd_ps(vDecay, vW, vVal);
+		vVal = _mm512_fmadd_ps(vMom, vM, vVal);
+
+		// only adapt where the mask is not zero
+		__mmask16 kAdapt = kSel;
+		if(pMask != NULL) {
+			kAdapt = _mm512_mask_cmp_ps_mask(kSel, _mm512_maskz_loadu_ps(kSel, &pMask[i]), vZero, _CMP_NEQ_UQ);
+		}
+		_mm512_mask_storeu_ps(&pM[i], kAdapt, vVal);
+		_mm512_mask_storeu_ps(&pW[i], kAdapt, _mm512_add_ps(vW, vVal) );
+	}
+}
+
+__attribute__((target("avx512f"))) static void
+avx512_update(const float &fRate, const float &fDecay, const float &fMomentum,
+		const float *pG, const float *pMask, float *pW, float *pM, const unsigned int &iSize)
+{
+	__m512 vRate 	= _mm512_set1_ps(fRate);
+	__m512 vDecay 	= _mm512_set1_ps(-fDecay);
+	__m512 vMom 	= _mm512_set1_ps(fMomentum);
+	__m512 vZero 	= _mm512_setzero_ps();
+
+	for(unsigned int i = 0; i < iSize; i += 16) {
+		__mmask16 kSel = (iSize-i >= 16) ? (__mmask16)0xFFFF : (__mmask16)((1u << (iSize-i)) - 1u);
+
+		__m512 vW = _mm512_maskz_loadu_ps(kSel, &pW[i]);
+		__m512 vM = _mm512_maskz_loadu_ps(kSel, &pM[i]);
+
+		__m512 vVal = _mm512_mul_ps(vRate, _mm512_maskz_loadu_ps(kSel, &pG[i]) );
+		vVal = _mm512_fmadd_ps(vDecay, vW, vVal);
+		vVal = _mm512_fmadd_ps(vMom, vM, vVal);
+
+		__mmask16 kAdapt = kSel;
+		if(pMask != NULL) {
+			kAdapt = _mm512_mask_cmp_ps_mask(kSel, _mm512_maskz_loadu_ps(kSel, &pMask[i]), vZero, _CMP_NEQ_UQ);
+		}
+		_mm512_mask_storeu_ps(&pM[i], kAdapt, vVal);
+		_mm512_mask_storeu_ps(&pW[i], kAdapt, _mm512_add_ps(vW, vVal) );
+	}
+}
+
+/*
+ * Four rows of B share each load of a row of A
+ */
+__attribute__((target("avx512f"))) static void
+avx512_gemm_nt(const float *pA, const float *pB, float *pC,
+		const unsigned int &iM, const unsigned int &iN, const unsigned int &iK,
+		const unsigned int &iLdA, const unsigned int &iLdB, const unsigned int &iLdC)
+{
+	unsigned int j = 0;
+	for(; j+4 <= iN; j += 4) {
+		const float *pB0 = &pB[j*iLdB];
+		const float *pB1 = pB0 + iLdB;
+		const float *pB2 = pB1 + iLdB;
+		const float *pB3 = pB2 + iLdB;
+
+		for(unsigned int i = 0; i < iM; i++) {
+			const float *pAi = &pA[i*iLdA];
+			__m512 vSum0 = _mm512_setzero_ps();
+			__m512 vSum1 = _mm512_setzero_ps();
+			__m512 vSum2 = _mm512_setzero_ps();
+			__m512 vSum3 = _mm512_setzero_ps();
+
+			for(unsigned int k = 0; k < iK; k += 16) {
+				__mmask16 kSel = (iK-k >= 16) ? (__mmask16)0xFFFF : (__mmask16)((1u << (iK-k)) - 1u);
+				__m512 vA = _mm512_maskz_loadu_ps(kSel, &pAi[k]);
+				vSum0 = _mm512_fmadd_ps(vA, _mm512_maskz_loadu_ps(kSel, &pB0[k]), vSum0);
+				vSum1 = _mm512_fmadd_ps(vA, _mm512_maskz_loadu_ps(kSel, &pB1[k]), vSum1);
+				vSum2 = _mm512_fmadd_ps(vA, _mm512_maskz_loadu_ps(kSel, &pB2[k]), vSum2);
+				vSum3 = _mm512_fmadd_ps(vA, _mm512_maskz_loadu_ps(kSel, &pB3[k]), vSum3);
+			}
+			float *pCi = &pC[i*iLdC+j];
+			pCi[0] += avx512_hsum(vSum0);
+			pCi[1] += avx512_hsum(vSum1);
+			pCi[2] += avx512_hsum(vSum2);
+			pCi[3] += avx512_hsum(vSum3);
+		}
+	}
+	for(; j < iN; j++) {
+		for(unsigned int i = 0; i < iM; i++) {
+			pC[i*iLdC+j] += avx512_dot(&pA[i*iLdA], &pB[j*iLdB], iK);
+		}
+	}
+}
+
+/*
+ * C = C + A B, whereas A(i,k) is pA[i*iStrideM + k*iStrideK].
+ * Four rows of B get accumulated with each load/store of a row of C.
+ */
+__attribute__((target("avx512f"))) static void
+avx512_gemm_axpy(const float *pA, const float *pB, float *pC,
+		const unsigned int &iM, const unsigned int &iN, const unsigned int &iK,
+		const unsigned int &iStrideM, const unsigned int &iStrideK, const unsigned int &iLdB, const unsigned int &iLdC)
+{
+	for(unsigned int i = 0; i < iM; i++) {
+		const float *pAi 	= &pA[i*iStrideM];
+		float *pCi 			= &pC[i*iLdC];
+
+		unsigned int k = 0;
+		for(; k+4 <= iK; k += 4) {
+			__m512 vA0 = _mm512_set1_ps(pAi[k*iStrideK]);
+			__m512 vA1 = _mm512_set1_ps(pAi[(k+1)*iStrideK]);
+			__m512 vA2 = _mm512_set1_ps(pAi[(k+2)*iStrideK]);
+			__m512 vA3 = _mm512_set1_ps(pAi[(k+3)*iStrideK]);
+
+			const float *pB0 = &pB[k*iLdB];
+			const float *pB1 = pB0 + iLdB;
+			const float *pB2 = pB1 + iLdB;
+			const float *pB3 = pB2 + iLdB;
+
+			for(unsigned int n = 0; n < iN; n += 16) {
+				__mmask16 kSel = (iN-n >= 16) ? (__mmask16)0xFFFF : (__mmask16)((1u << (iN-n)) - 1u);
+				__m512 vC = _mm512_maskz_loadu_ps(kSel, &pCi[n]);
+				vC = _mm512_fmadd_ps(vA0, _mm512_maskz_loadu_ps(kSel, &pB0[n]), vC);
+				vC = _mm512_fmadd_ps(vA1, _mm512_maskz_loadu_ps(kSel, &pB1[n]), vC);
+				vC = _mm512_fmadd_ps(vA2, _mm512_maskz_loadu_ps(kSel, &pB2[n]), vC);
+				vC = _mm512_fmadd_ps(vA3, _mm512_maskz_loadu_ps(kSel, &pB3[n]), vC);
+				_mm512_mask_storeu_ps(&pCi[n], kSel, vC);
+			}
+		}
+		for(; k < iK; k++) {
+			avx512_axpy(pAi[k*iStrideK], &pB[k*iLdB], pCi, iN);
+		}
+	}
+}
+
+__attribute__((target("avx512f"))) static void
+avx512_gemm_nn(const float *pA, const float *pB, float *pC,
+		const unsigned int &iM, const unsigned int &iN, const unsigned int &iK,
+		const unsigned int &iLdA, const unsigned int &iLdB, const unsigned int &iLdC)
+{
+	avx512_gemm_axpy(pA, pB, pC, iM, iN, iK, iLdA, 1, iLdB, iLdC);
+}
+
+__attribute__((target("avx512f"))) static void
+avx512_gemm_tn(const float *pA, const float *pB, float *pC,
+		const unsigned int &iM, const unsigned int &iN, const unsigned int &iK,
+		const unsigned int &iLdA, const unsigned int &iLdB, const unsigned int &iLdC)
+{
+	avx512_gemm_axpy(pA, pB, pC, iM, iN, iK, 1, iLdA, iLdB, iLdC);
+}
+
+/*
+ * Without AVX512_VPOPCNTDQ the scalar popcnt instruction is the fastest option
+ */
+__attribute__((target("avx512f,popcnt"))) static unsigned int
+avx512_hamming(const uint64_t *pX, const uint64_t *pY, const unsigned int &iWords) {
+	uint64_t iSum0 = 0, iSum1 = 0, iSum2 = 0, iSum3 = 0;
+	unsigned int i = 0;
+	for(; i+4 <= iWords; i += 4) {
+		iSum0 += _mm_popcnt_u64(pX[i] ^ pY[i]);
+		iSum1 += _mm_popcnt_u64(pX[i+1] ^ pY[i+1]);
+		iSum2 += _mm_popcnt_u64(pX[i+2] ^ pY[i+2]);
+		iSum3 += _mm_popcnt_u64(pX[i+3] ^ pY[i+3]);
+	}
+	for(; i < iWords; i++) {
+		iSum0 += _mm_popcnt_u64(pX[i] ^ pY[i]);
+	}
+	return static_cast<unsigned int>(iSum0 + iSum1 + iSum2 + iSum3);
+}
+
+/*
+ * The mask bits are used directly as load masks (masked loads do not fault beyond iSize).
+ */
+__attribute__((target("avx512f"))) static int64_t
+avx512_masked_sum(const uint64_t *pMask, const int32_t *pX, const unsigned int &iSize) {
+	__m512i vSum64 = _mm512_setzero_si512();
+
+	for(unsigned int i = 0; i < iSize; i += 64) {
+		uint64_t iWord = pMask[i/64];
+		if(iSize-i < 64) {
+			iWord &= (1ULL << (iSize-i) ) - 1;
+		}
+		__m512i vSum = _mm512_setzero_si512();
+		for(unsigned int j = 0; j < 64; j += 16) {
+			const __mmask16 iLanes = static_cast<__mmask16>(iWord >> j);
+			vSum = _mm512_add_epi32(vSum, _mm512_maskz_loadu_epi32(iLanes, &pX[i+j]) );
+		}
+		// the zero masked forms, the plain ones use undefined pass through vectors (-Wmaybe-uninitialized)
+		vSum64 = _mm512_add_epi64(vSum64, _mm512_maskz_cvtepi32_epi64(0xFF, _mm512_maskz_extracti64x4_epi64(0xFF, vSum, 0) ) );
+		vSum64 = _mm512_add_epi64(vSum64, _mm512_maskz_cvtepi32_epi64(0xFF, _mm512_maskz_extracti64x4_epi64(0xFF, vSum, 1) ) );
+	}
+
+	int64_t pSum[8];
+	_mm512_storeu_si512(pSum, vSum64);
+	return (pSum[0] + pSum[1]) + (pSum[2] + pSum[3]) + (pSum[4] + pSum[5]) + (pSum[6] + pSum[7]);
+}
+#endif
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+/*
+ * Kernel sets
+ */
+//////////////////////////////////////////////////////////////////////////////////////////////
+const CPUKernels
+Kernels::fcn_scalar = {
+	(char*)"scalar",
+	scalar_dot,
+	scalar_gemv,
+	scalar_axpy,
+	scalar_adapt,
+	scalar_update,
+	scalar_gemm_nt,
+	scalar_gemm_nn,
+	scalar_gemm_tn,
+	scalar_hamming,
+	scalar_masked_sum
+};
+
+#ifdef ANN_X86_DISPATCH
+const CPUKernels
+Kernels::fcn_avx2 = {
+	(char*)"avx2",
+	avx2_dot,
+	avx2_gemv,
+	avx2_axpy,
+	avx2_adapt,
+	avx2_update,
+	avx2_gemm_nt,
+	avx2_gemm_nn,
+	avx2_gemm_tn,
+	avx2_hamming,
+	avx2_masked_sum
+};
+
+const CPUKernels
+Kernels::fcn_avx512 = {
+	(char*)"avx512",
+	avx512_dot,
+	avx512_gemv,
+	avx512_axpy,
+	avx512_adapt,
+	avx512_update,
+	avx512_gemm_nt,
+	avx512_gemm_nn,
+	avx512_gemm_tn,
+	avx512_hamming,
+	avx512_masked_sum
+};
+#else
+// no runtime dispatch for this platform/compiler
+const CPUKernels Kernels::fcn_avx2 	= Kernels::fcn_scalar;
+const CPUKernels Kernels::fcn_avx512 = Kernels::fcn_scalar;
+#endif
+
+static bool
+IsSupported(const CPUKernels *pKernels) {
+#ifdef ANN_X86_DISPATCH
+	__builtin_cpu_init();
+	if(pKernels == &Kernels::fcn_avx512) {
+		return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("popcnt");
+	}
+	if(pKernels == &Kernels::fcn_avx2) {
+		return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") && __builtin_cpu_supports("popcnt");
+	}
+	return true;
+#else
+	return pKernels == &Kernels::fcn_scalar;
+#endif
+}
+
+const CPUKernels*
+Kernels::ResolveKernelsByName(const char *name) {
+	const CPUKernels *pKernels = NULL;
+	if (strcmp (name, "scalar") == 0) {
+		pKernels = &fcn_scalar;
+	}
+	else if (strcmp (name, "avx2") == 0) {
+		pKernels = &fcn_avx2;
+	}
+	else if (strcmp (name, "avx512") == 0) {
+		pKernels = &fcn_avx512;
+	}
+
+	if(pKernels != NULL && IsSupported(pKernels) ) {
+		return pKernels;
+	}
+	return (NULL);
+}
+
+static const CPUKernels*
+DetectKernels() {
+	const char *pEnv = getenv("ANNET_KERNELS");
+	if(pEnv != NULL) {
+		const CPUKernels *pKernels = Kernels::ResolveKernelsByName(pEnv);
+		if(pKernels != NULL) {
+			return pKernels;
+		}
+		std::cout<<"Kernels \""<<pEnv<<"\" not supported, using auto detection"<<std::endl;
+	}
+
+	if(IsSupported(&Kernels::fcn_avx512) ) {
+		return &Kernels::fcn_avx512;
+	}
+	if(IsSupported(&Kernels::fcn_avx2) ) {
+		return &Kernels::fcn_avx2;
+	}
+	return &Kernels::fcn_scalar;
+}
+
+const CPUKernels*
+Kernels::GetKernels() {
+	// CPUID gets checked only at the first call
+	static const CPUKernels *pKernels = DetectKernels();
+	return pKernels;
+}
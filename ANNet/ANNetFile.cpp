@@ -0,0 +1,314 @@
+/*
+ * NetFile.cpp
+ *
+ *  Created on: 17.10.2026
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <cassert>
+#ifndef WIN32
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+#endif /*WIN32*/
+//own classes
+#include <containers/ANNetFile.h>
+
+using namespace ANN;
+
+
+NetFile::NetFile() {
+	m_pData 	= NULL;
+	m_iSize 	= 0;
+	m_bMapped 	= false;
+}
+
+NetFile::~NetFile() {
+	Close();
+}
+
+bool NetFile::IsRawFile(const std::string &sPath) {
+	char cMagic[8];
+	FILE *fin = fopen(sPath.c_str(), "rb");
+	if(fin == NULL) {
+		return false;
+	}
+	bool bRes = fread(cMagic, 1, sizeof(cMagic), fin) == sizeof(cMagic) && memcmp(cMagic, ANRAW_MAGIC, sizeof(cMagic) ) == 0;
+	fclose(fin);
+	return bRes;
+}
+
+bool NetFile::Open(const std::string &sPath) {
+	Close();
+
+#ifndef WIN32
+	int iFile = open(sPath.c_str(), O_RDONLY);
+	if(iFile < 0) {
+		return false;
+	}
+	struct stat FileStat;
+	if(fstat(iFile, &FileStat) != 0 || FileStat.st_size < static_cast<off_t>(sizeof(RawNetHeader) ) ) {
+		close(iFile);
+		return false;
+	}
+	void *pMap = mmap(NULL, FileStat.st_size, PROT_READ, MAP_PRIVATE, iFile, 0);
+	close(iFile);	// the mapping stays valid
+	if(pMap == MAP_FAILED) {
+		return false;
+	}
+	m_pData 	= static_cast<const char*>(pMap);
+	m_iSize 	= FileStat.st_size;
+	m_bMapped 	= true;
+#else
+	FILE *fin = fopen(sPath.c_str(), "rb");
+	if(fin == NULL) {
+		return false;
+	}
+	fseek(fin, 0, SEEK_END);
+	long iSize = ftell(fin);
+	fseek(fin, 0, SEEK_SET);
+	if(iSize < static_cast<long>(sizeof(RawNetHeader) ) ) {
+		fclose(fin);
+		return false;
+	}
+	char *pData = new char[iSize];
+	if(fread(pData, 1, iSize, fin) != static_cast<size_t>(iSize) ) {
+		delete [] pData;
+		fclose(fin);
+		return false;
+	}
+	fclose(fin);
+	m_pData 	= pData;
+	m_iSize 	= iSize;
+	m_bMapped 	= false;
+#endif /*WIN32*/
+
+	if(!Validate() ) {
+		Close();
+		return false;
+	}
+	return true;
+}
+
+void NetFile::Close() {
+	if(m_pData == NULL) {
+		return;
+	}
+#ifndef WIN32
+	if(m_bMapped) {
+		munmap(const_cast<char*>(m_pData), m_iSize);
+	}
+	else {
+		delete [] m_pData;
+	}
+#else
+	delete [] m_pData;
+#endif /*WIN32*/
+	m_pData 	= NULL;
+	m_iSize 	= 0;
+	m_bMapped 	= false;
+}
+
+bool NetFile::IsOpen() const {
+	return m_pData != NULL;
+}
+
+bool NetFile::InRange(const uint64_t &iOffset, const uint64_t &iBytes) const {
+	return iOffset <= m_iSize && iBytes <= m_iSize - iOffset;
+}
+
+/*
+ * Layers and neurons get created in the order of the file (AbsNet::CreateNet()),
+ * so a destination is valid if the layer ID is an index of the layer table and the neuron ID is smaller than the size of this layer.
+ */
+bool NetFile::ValidDestinations(const uint64_t &iLayers, const uint64_t &iNeurons, const uint64_t &iEdges) const {
+	const RawNetHeader &Header 	= GetHeader();
+	const int32_t *pLayers 		= GetArray<int32_t>(iLayers);
+	const int32_t *pNeurons 	= GetArray<int32_t>(iNeurons);
+	for(uint64_t j = 0; j < iEdges; j++) {
+		if(pLayers[j] < 0 || static_cast<uint32_t>(pLayers[j]) >= Header.m_iNrOfLayers) {
+			return false;
+		}
+		if(pNeurons[j] < 0 || static_cast<uint32_t>(pNeurons[j]) >= GetLayer(pLayers[j]).m_iNrOfNeurons) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool NetFile::Validate() const {
+	const RawNetHeader &Header = GetHeader();
+	if(memcmp(Header.m_cMagic, ANRAW_MAGIC, sizeof(Header.m_cMagic) ) != 0) {
+		return false;
+	}
+	if(Header.m_iVersion != ANRAW_VERSION) {
+		std::cout<<"NetFile: unsupported version "<<Header.m_iVersion<<std::endl;
+		return false;
+	}
+	if(Header.m_iFileSize != m_iSize) {
+		return false;
+	}
+	if(!InRange(Header.m_iLayerTable, sizeof(RawLayerDescr) * (uint64_t)Header.m_iNrOfLayers) ) {
+		return false;
+	}
+
+	for(unsigned int i = 0; i < Header.m_iNrOfLayers; i++) {
+		const RawLayerDescr &Layer = GetLayer(i);
+		uint64_t iNeurons 	= Layer.m_iNrOfNeurons;
+		uint64_t iEdges 	= Layer.m_iNrOfEdges;
+		uint64_t iBias 		= Layer.m_iNrOfBiasEdges;
+
+		if(	!InRange(Layer.m_iNeuronIDs, 	sizeof(int32_t) * iNeurons) ||
+			!InRange(Layer.m_iPositions, 	sizeof(float) * iNeurons * Layer.m_iNrOfDims) ||
+			!InRange(Layer.m_iEdgeOffsets, 	sizeof(uint64_t) * (iNeurons+1) ) ||
+			!InRange(Layer.m_iDstLayers, 	sizeof(int32_t) * iEdges) ||
+			!InRange(Layer.m_iDstNeurons, 	sizeof(int32_t) * iEdges) ||
+			!InRange(Layer.m_iWeights, 		sizeof(float) * iEdges) ||
+			!InRange(Layer.m_iBiasDstLayers, 	sizeof(int32_t) * iBias) ||
+			!InRange(Layer.m_iBiasDstNeurons, 	sizeof(int32_t) * iBias) ||
+			!InRange(Layer.m_iBiasWeights, 		sizeof(float) * iBias) )
+		{
+			return false;
+		}
+		// the dense block gets handed to the kernels as it is
+		if(Layer.m_iDenseWeights != 0) {
+			if(	i == 0 || Layer.m_iDenseInputs != GetLayer(i-1).m_iNrOfNeurons ||
+				Layer.m_iDenseWeights % ANRAW_ALIGN != 0 || Layer.m_iDenseBias % ANRAW_ALIGN != 0 ||
+				!InRange(Layer.m_iDenseWeights, sizeof(float) * iNeurons * Layer.m_iDenseInputs) ||
+				!InRange(Layer.m_iDenseBias, 	sizeof(float) * iNeurons) )
+			{
+				return false;
+			}
+		}
+		// the edges of the neurons must be consecutive
+		const uint64_t *pOffsets = GetArray<uint64_t>(Layer.m_iEdgeOffsets);
+		if(pOffsets[0] != 0 || pOffsets[iNeurons] != iEdges) {
+			return false;
+		}
+		for(uint64_t j = 0; j < iNeurons; j++) {
+			if(pOffsets[j] > pOffsets[j+1]) {
+				return false;
+			}
+		}
+	}
+
+	// all layer descriptions are in range now, check the IDs against them
+	for(unsigned int i = 0; i < Header.m_iNrOfLayers; i++) {
+		const RawLayerDescr &Layer = GetLayer(i);
+		if(Layer.m_iID < 0 || static_cast<uint32_t>(Layer.m_iID) >= Header.m_iNrOfLayers) {
+			return false;
+		}
+		const int32_t *pIDs = GetArray<int32_t>(Layer.m_iNeuronIDs);
+		for(uint64_t j = 0; j < Layer.m_iNrOfNeurons; j++) {
+			if(pIDs[j] < 0 || static_cast<uint32_t>(pIDs[j]) >= Layer.m_iNrOfNeurons) {
+				return false;
+			}
+		}
+		if(	!ValidDestinations(Layer.m_iDstLayers, Layer.m_iDstNeurons, Layer.m_iNrOfEdges) ||
+			!ValidDestinations(Layer.m_iBiasDstLayers, Layer.m_iBiasDstNeurons, Layer.m_iNrOfBiasEdges) )
+		{
+			std::cout<<"NetFile: layer "<<i<<" has edges to neurons which do not exist"<<std::endl;
+			return false;
+		}
+	}
+
+	if(Header.m_iTrainingSet != 0) {
+		if(!InRange(Header.m_iTrainingSet, sizeof(RawTrainingSetDescr) ) ) {
+			return false;
+		}
+		const RawTrainingSetDescr &Set = *GetTrainingSet();
+		if(	!InRange(Set.m_iInputOffsets, 	sizeof(uint64_t) * ((uint64_t)Set.m_iNrOfInputs+1) ) ||
+			!InRange(Set.m_iOutputOffsets, 	sizeof(uint64_t) * ((uint64_t)Set.m_iNrOfOutputs+1) ) )
+		{
+			return false;
+		}
+		const uint64_t *pInpOffsets = GetArray<uint64_t>(Set.m_iInputOffsets);
+		const uint64_t *pOutOffsets = GetArray<uint64_t>(Set.m_iOutputOffsets);
+		for(uint64_t j = 0; j < Set.m_iNrOfInputs; j++) {
+			if(pInpOffsets[j] > pInpOffsets[j+1]) {
+				return false;
+			}
+		}
+		for(uint64_t j = 0; j < Set.m_iNrOfOutputs; j++) {
+			if(pOutOffsets[j] > pOutOffsets[j+1]) {
+				return false;
+			}
+		}
+		if(	!InRange(Set.m_iInputs, 	sizeof(float) * pInpOffsets[Set.m_iNrOfInputs]) ||
+			!InRange(Set.m_iOutputs, 	sizeof(float) * pOutOffsets[Set.m_iNrOfOutputs]) )
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+const RawNetHeader &NetFile::GetHeader() const {
+	assert(m_pData != NULL);
+	return *GetArray<RawNetHeader>(0);
+}
+
+const RawLayerDescr &NetFile::GetLayer(const unsigned int &iLayer) const {
+	assert(iLayer < GetHeader().m_iNrOfLayers);
+	return GetArray<RawLayerDescr>(GetHeader().m_iLayerTable)[iLayer];
+}
+
+const RawTrainingSetDescr *NetFile::GetTrainingSet() const {
+	if(GetHeader().m_iTrainingSet == 0) {
+		return NULL;
+	}
+	return GetArray<RawTrainingSetDescr>(GetHeader().m_iTrainingSet);
+}
+
+const int32_t *NetFile::GetNeuronIDs(const unsigned int &iLayer) const {
+	return GetArray<int32_t>(GetLayer(iLayer).m_iNeuronIDs);
+}
+
+const float *NetFile::GetPositions(const unsigned int &iLayer) const {
+	return GetArray<float>(GetLayer(iLayer).m_iPositions);
+}
+
+const uint64_t *NetFile::GetEdgeOffsets(const unsigned int &iLayer) const {
+	return GetArray<uint64_t>(GetLayer(iLayer).m_iEdgeOffsets);
+}
+
+const int32_t *NetFile::GetDstLayers(const unsigned int &iLayer) const {
+	return GetArray<int32_t>(GetLayer(iLayer).m_iDstLayers);
+}
+
+const int32_t *NetFile::GetDstNeurons(const unsigned int &iLayer) const {
+	return GetArray<int32_t>(GetLayer(iLayer).m_iDstNeurons);
+}
+
+const float *NetFile::GetWeights(const unsigned int &iLayer) const {
+	return GetArray<float>(GetLayer(iLayer).m_iWeights);
+}
+
+const int32_t *NetFile::GetBiasDstLayers(const unsigned int &iLayer) const {
+	return GetArray<int32_t>(GetLayer(iLayer).m_iBiasDstLayers);
+}
+
+const int32_t *NetFile::GetBiasDstNeurons(const unsigned int &iLayer) const {
+	return GetArray<int32_t>(GetLayer(iLayer).m_iBiasDstNeurons);
+}
+
+const float *NetFile::GetBiasWeights(const unsigned int &iLayer) const {
+	return GetArray<float>(GetLayer(iLayer).m_iBiasWeights);
+}
+
+const float *NetFile::GetDenseWeights(const unsigned int &iLayer) const {
+	if(GetLayer(iLayer).m_iDenseWeights == 0) {
+		return NULL;
+	}
+	return GetArray<float>(GetLayer(iLayer).m_iDenseWeights);
+}
+
+const float *NetFile::GetDenseBias(const unsigned int &iLayer) const {
+	if(GetLayer(iLayer).m_iDenseWeights == 0) {
+		return NULL;
+	}
+	return GetArray<float>(GetLayer(iLayer).m_iDenseBias);
+}
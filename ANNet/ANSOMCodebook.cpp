@@ -0,0 +1,249 @@
+/*
+ * SOMCodebook.cpp
+ *
+ *  Created on: 17.10.2026
+ */
+
+#include <cassert>
+#include <limits>
+#include <algorithm>
+#include <omp.h>
+//own classes
+#include <math/ANKernels.h>
+#include <basic/ANEdge.h>
+#include <basic/ANAbsNeuron.h>
+#include <basic/ANAbsLayer.h>
+#include <ANSOMCodebook.h>
+
+using namespace ANN;
+
+
+SOMCodebook::SOMCodebook() {
+	m_pKernels 	= Kernels::GetKernels();
+	m_iNeurons 	= 0;
+	m_iInputs 	= 0;
+}
+
+SOMCodebook::~SOMCodebook() {
+	Clear();
+}
+
+void SOMCodebook::Clear() {
+	m_vWeights.clear();
+	m_vNorms.clear();
+	m_vDots.clear();
+	m_vWorkspaces.clear();
+	m_iNeurons 	= 0;
+	m_iInputs 	= 0;
+}
+
+void SOMCodebook::Resize(const unsigned int &iNeurons, const unsigned int &iInputs) {
+	m_iNeurons 	= iNeurons;
+	m_iInputs 	= iInputs;
+
+	m_vWeights.assign((size_t)m_iNeurons*m_iInputs, 0.f);
+	m_vNorms.assign(m_iNeurons, 0.f);
+	m_vDots.resize(m_iNeurons);
+}
+
+void SOMCodebook::Import(const AbsLayer *pLayer) {
+	assert(pLayer != NULL && pLayer->GetNeurons().size() > 0);
+
+	m_iNeurons 	= pLayer->GetNeurons().size();
+	m_iInputs 	= pLayer->GetNeurons().front()->GetConsI().size();
+
+	m_vWeights.resize((size_t)m_iNeurons*m_iInputs);
+	m_vNorms.resize(m_iNeurons);
+	m_vDots.resize(m_iNeurons);
+
+	#pragma omp parallel for
+	for(int j = 0; j < static_cast<int>(m_iNeurons); j++) {
+		const std::vector<Edge*> &vConsI = pLayer->GetNeurons()[j]->GetConsI();
+		assert(vConsI.size() == m_iInputs);
+
+		float *pRow = &m_vWeights[(size_t)j*m_iInputs];
+		for(unsigned int i = 0; i < m_iInputs; i++) {
+			pRow[i] = vConsI[i]->GetValue();
+		}
+		m_vNorms[j] = m_pKernels->dot(pRow, pRow, m_iInputs);
+	}
+}
+
+void SOMCodebook::Export(AbsLayer *pLayer) const {
+	assert(pLayer != NULL && pLayer->GetNeurons().size() == m_iNeurons);
+
+	#pragma omp parallel for
+	for(int j = 0; j < static_cast<int>(m_iNeurons); j++) {
+		const std::vector<Edge*> &vConsI = pLayer->GetNeurons()[j]->GetConsI();
+		assert(vConsI.size() == m_iInputs);
+
+		const float *pRow = &m_vWeights[(size_t)j*m_iInputs];
+		for(unsigned int i = 0; i < m_iInputs; i++) {
+			vConsI[i]->SetValue(pRow[i]);
+		}
+	}
+}
+
+unsigned int SOMCodebook::GetNrOfNeurons() const {
+	return m_iNeurons;
+}
+
+unsigned int SOMCodebook::GetNrOfInputs() const {
+	return m_iInputs;
+}
+
+const float *SOMCodebook::GetRow(const unsigned int &iNeuron) const {
+	assert(iNeuron < m_iNeurons);
+	return &m_vWeights[(size_t)iNeuron*m_iInputs];
+}
+
+const float *SOMCodebook::GetWeights() const {
+	return m_vWeights.empty() ? NULL : &m_vWeights[0];
+}
+
+const float *SOMCodebook::GetNorms() const {
+	return m_vNorms.empty() ? NULL : &m_vNorms[0];
+}
+
+void SOMCodebook::SetRow(const unsigned int &iNeuron, const float *pWeights) {
+	assert(iNeuron < m_iNeurons);
+
+	float *pRow = &m_vWeights[(size_t)iNeuron*m_iInputs];
+	std::copy(pWeights, pWeights + m_iInputs, pRow);
+	m_vNorms[iNeuron] = m_pKernels->dot(pRow, pRow, m_iInputs);
+}
+
+void SOMCodebook::Adapt(const unsigned int &iNeuron, const float *pInput, const float &fRate) {
+	assert(iNeuron < m_iNeurons);
+
+	float *pRow = &m_vWeights[(size_t)iNeuron*m_iInputs];
+	for(unsigned int i = 0; i < m_iInputs; i++) {
+		pRow[i] += fRate * (pInput[i] - pRow[i]);
+	}
+	m_vNorms[iNeuron] = m_pKernels->dot(pRow, pRow, m_iInputs);
+}
+
+unsigned int SOMCodebook::FindBMU(const float *pInput, float *pDistances, const float *pConscience) {
+	assert(m_iNeurons > 0);
+
+	const float fInputNorm 	= pDistances != NULL ? m_pKernels->dot(pInput, pInput, m_iInputs) : 0.f;
+	const float fBias 		= 1.f/(float)m_iNeurons;
+
+	float fBest 		= std::numeric_limits<float>::max();
+	unsigned int iBest 	= 0;
+
+	/*
+	 * Each thread calculates the distances of a block of rows and keeps its own minimum
+	 */
+	#pragma omp parallel if((size_t)m_iNeurons*m_iInputs > 4096)
+	{
+		int iThreads 	= omp_get_num_threads();
+		int iThread 	= omp_get_thread_num();
+		unsigned int iBegin = (unsigned int)( (unsigned long)m_iNeurons*iThread/iThreads);
+		unsigned int iEnd 	= (unsigned int)( (unsigned long)m_iNeurons*(iThread+1)/iThreads);
+
+		if(iEnd > iBegin) {
+			m_pKernels->gemv(&m_vWeights[(size_t)iBegin*m_iInputs], pInput, &m_vDots[iBegin], iEnd-iBegin, m_iInputs);
+		}
+
+		float fMin 			= std::numeric_limits<float>::max();
+		unsigned int iMin 	= iBegin;
+		for(unsigned int j = iBegin; j < iEnd; j++) {
+			// ||x||^2 is the same for all neurons and not needed for the comparison
+			float fDist = m_vNorms[j] - 2.f*m_vDots[j];
+			if(pDistances != NULL) {
+				pDistances[j] = std::max(fDist + fInputNorm, 0.f);
+			}
+			if(pConscience != NULL) {
+				fDist -= fBias - pConscience[j];
+			}
+			if(fDist < fMin) {
+				fMin = fDist;
+				iMin = j;
+			}
+		}
+
+		// the blocks are ordered, so ties are broken in favor of the smaller index
+		#pragma omp critical
+		{
+			if(iEnd > iBegin && (fMin < fBest || (fMin == fBest && iMin < iBest) ) ) {
+				fBest = fMin;
+				iBest = iMin;
+			}
+		}
+	}
+	return iBest;
+}
+
+void SOMCodebook::FindBMUs(const float *pInputs, const unsigned int &iSamples, unsigned int *pBMUs, float *pDistances, const unsigned int &iK) {
+	assert(m_iNeurons > 0);
+	assert(iK > 0 && iK <= m_iNeurons && iK <= ANSOM_MAX_K);
+
+	// a block of dot products should stay in the cache
+	const unsigned int iBlock 	= std::max(1u, std::min(64u, 16384u/m_iNeurons) );
+	const int iBlocks 			= (iSamples + iBlock-1) / iBlock;
+
+	if(m_vWorkspaces.size() < (unsigned int)omp_get_max_threads() ) {
+		m_vWorkspaces.resize(omp_get_max_threads() );
+	}
+
+	#pragma omp parallel for if(iBlocks > 1)
+	for(int b = 0; b < iBlocks; b++) {
+		std::vector<float> &vDots = m_vWorkspaces[omp_get_thread_num()];
+		if(vDots.size() < iBlock*m_iNeurons) {
+			vDots.resize(iBlock*m_iNeurons);
+		}
+
+		unsigned int iFirst = b*iBlock;
+		unsigned int iCount = std::min(iBlock, iSamples-iFirst);
+		const float *pBlock = &pInputs[(size_t)iFirst*m_iInputs];
+
+		std::fill(vDots.begin(), vDots.begin() + iCount*m_iNeurons, 0.f);
+		m_pKernels->gemm_nt(pBlock, &m_vWeights[0], &vDots[0], iCount, m_iNeurons, m_iInputs, m_iInputs, m_iInputs, m_iNeurons);
+
+		for(unsigned int s = 0; s < iCount; s++) {
+			const float *pDots 	= &vDots[s*m_iNeurons];
+			unsigned int *pBest = &pBMUs[(size_t)(iFirst+s)*iK];
+
+			if(iK == 1) {
+				float fMin 			= std::numeric_limits<float>::max();
+				unsigned int iMin 	= 0;
+				for(unsigned int j = 0; j < m_iNeurons; j++) {
+					float fDist = m_vNorms[j] - 2.f*pDots[j];
+					if(fDist < fMin) {
+						fMin = fDist;
+						iMin = j;
+					}
+				}
+				pBest[0] = iMin;
+			}
+			else {
+				// sorted list of the iK best neurons so far, a neuron only gets in front of worse ones
+				float fBest[ANSOM_MAX_K];
+				unsigned int iFound = 0;
+				for(unsigned int j = 0; j < m_iNeurons; j++) {
+					float fDist = m_vNorms[j] - 2.f*pDots[j];
+					if(iFound == iK && fDist >= fBest[iK-1]) {
+						continue;
+					}
+					unsigned int iPos = iFound < iK ? iFound++ : iK-1;
+					for(; iPos > 0 && fBest[iPos-1] > fDist; iPos--) {
+						fBest[iPos] = fBest[iPos-1];
+						pBest[iPos] = pBest[iPos-1];
+					}
+					fBest[iPos] = fDist;
+					pBest[iPos] = j;
+				}
+			}
+
+			if(pDistances != NULL) {
+				const float *pInput = &pBlock[(size_t)s*m_iInputs];
+				const float fInputNorm = m_pKernels->dot(pInput, pInput, m_iInputs);
+				for(unsigned int k = 0; k < iK; k++) {
+					unsigned int j = pBest[k];
+					pDistances[(size_t)(iFirst+s)*iK+k] = std::max(m_vNorms[j] - 2.f*pDots[j] + fInputNorm, 0.f);
+				}
+			}
+		}
+	}
+}
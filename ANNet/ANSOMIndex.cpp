@@ -0,0 +1,199 @@
+/*
+ * SOMIndex.cpp
+ *
+ *  Created on: 17.10.2026
+ */
+
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <omp.h>
+//own classes
+#include <math/ANKernels.h>
+#include <ANSOMIndex.h>
+
+using namespace ANN;
+
+
+SOMIndex::SOMIndex(const unsigned int &iClusters, const unsigned int &iProbes) {
+	m_iClusters 	= iClusters;
+	m_iProbes 		= iProbes;
+	assert(m_iProbes > 0 && m_iProbes <= ANSOM_MAX_K);
+
+	m_iNeurons 		= 0;
+	m_fRecall 		= 0.f;
+	m_fSpeedup 		= 0.f;
+}
+
+SOMIndex::~SOMIndex() {
+	Clear();
+}
+
+void SOMIndex::Clear() {
+	m_Centroids.Clear();
+	m_vMembers.clear();
+	m_vOffsets.clear();
+	m_vAssign.clear();
+	m_vProbes.clear();
+
+	m_iNeurons 		= 0;
+	m_fRecall 		= 0.f;
+	m_fSpeedup 		= 0.f;
+}
+
+void SOMIndex::SetNrOfClusters(const unsigned int &iClusters) {
+	m_iClusters = iClusters;
+}
+
+unsigned int SOMIndex::GetNrOfClusters() const {
+	return m_iClusters;
+}
+
+void SOMIndex::SetNrOfProbes(const unsigned int &iProbes) {
+	assert(iProbes > 0 && iProbes <= ANSOM_MAX_K);
+	m_iProbes = iProbes;
+}
+
+unsigned int SOMIndex::GetNrOfProbes() const {
+	return m_iProbes;
+}
+
+bool SOMIndex::IsBuilt(const SOMCodebook &Codebook) const {
+	return m_iNeurons > 0 && m_iNeurons == Codebook.GetNrOfNeurons() && m_Centroids.GetNrOfInputs() == Codebook.GetNrOfInputs();
+}
+
+void SOMIndex::Build(const SOMCodebook &Codebook, const unsigned int &iIterations) {
+	assert(iIterations > 0);
+
+	const unsigned int iNeurons = Codebook.GetNrOfNeurons();
+	const unsigned int iInputs 	= Codebook.GetNrOfInputs();
+	assert(iNeurons > 0);
+
+	unsigned int iClusters = m_iClusters > 0 ? m_iClusters : (unsigned int)sqrt( (float)iNeurons);
+	iClusters = std::max(1u, std::min(iClusters, iNeurons) );
+
+	// start from scratch or continue with the centroids of the last build
+	if(!IsBuilt(Codebook) || m_Centroids.GetNrOfNeurons() != iClusters) {
+		m_Centroids.Resize(iClusters, iInputs);
+		for(unsigned int c = 0; c < iClusters; c++) {
+			m_Centroids.SetRow(c, Codebook.GetRow( (unsigned int)( (unsigned long)c*iNeurons/iClusters) ) );
+		}
+	}
+	m_iNeurons = iNeurons;
+	m_vAssign.resize(iNeurons);
+
+	const CPUKernels *pKernels = Kernels::GetKernels();
+	for(unsigned int i = 0; i < iIterations; i++) {
+		m_Centroids.FindBMUs(Codebook.GetWeights(), iNeurons, &m_vAssign[0]);
+
+		/*
+		 * Each thread averages its own block of clusters, so the result does not depend on the number of threads.
+		 * Empty clusters keep their centroid.
+		 */
+		#pragma omp parallel
+		{
+			int iThreads 	= omp_get_num_threads();
+			int iThread 	= omp_get_thread_num();
+			unsigned int iBegin = (unsigned int)( (unsigned long)iClusters*iThread/iThreads);
+			unsigned int iEnd 	= (unsigned int)( (unsigned long)iClusters*(iThread+1)/iThreads);
+
+			std::vector<float> vSums( (iEnd-iBegin)*iInputs, 0.f);
+			std::vector<unsigned int> vCounts(iEnd-iBegin, 0);
+			for(unsigned int j = 0; j < iNeurons; j++) {
+				unsigned int c = m_vAssign[j];
+				if(c >= iBegin && c < iEnd) {
+					pKernels->axpy(1.f, Codebook.GetRow(j), &vSums[(c-iBegin)*iInputs], iInputs);
+					vCounts[c-iBegin]++;
+				}
+			}
+			for(unsigned int c = iBegin; c < iEnd; c++) {
+				if(vCounts[c-iBegin] == 0) {
+					continue;
+				}
+				float *pSum = &vSums[(c-iBegin)*iInputs];
+				for(unsigned int k = 0; k < iInputs; k++) {
+					pSum[k] /= (float)vCounts[c-iBegin];
+				}
+				m_Centroids.SetRow(c, pSum);
+			}
+		}
+	}
+
+	// the centroids are the means of these lists
+	m_vOffsets.assign(iClusters+1, 0);
+	for(unsigned int j = 0; j < iNeurons; j++) {
+		m_vOffsets[m_vAssign[j]+1]++;
+	}
+	for(unsigned int c = 0; c < iClusters; c++) {
+		m_vOffsets[c+1] += m_vOffsets[c];
+	}
+	m_vMembers.resize(iNeurons);
+	std::vector<unsigned int> vFill(m_vOffsets.begin(), m_vOffsets.end()-1);
+	for(unsigned int j = 0; j < iNeurons; j++) {
+		m_vMembers[vFill[m_vAssign[j]]++] = j;
+	}
+}
+
+unsigned int SOMIndex::FindBMU(const SOMCodebook &Codebook, const float *pInput) {
+	assert(IsBuilt(Codebook) );
+
+	const CPUKernels *pKernels 	= Kernels::GetKernels();
+	const unsigned int iInputs 	= Codebook.GetNrOfInputs();
+	const unsigned int iProbes 	= std::min(m_iProbes, m_Centroids.GetNrOfNeurons() );
+	const float *pNorms 		= Codebook.GetNorms();
+
+	m_vProbes.resize(iProbes);
+	m_Centroids.FindBMUs(pInput, 1, &m_vProbes[0], NULL, iProbes);
+
+	float fBest 		= std::numeric_limits<float>::max();
+	unsigned int iBest 	= 0;
+	for(unsigned int p = 0; p < iProbes; p++) {
+		unsigned int c = m_vProbes[p];
+		for(unsigned int m = m_vOffsets[c]; m < m_vOffsets[c+1]; m++) {
+			unsigned int j = m_vMembers[m];
+			// ||x||^2 is the same for all neurons
+			float fDist = pNorms[j] - 2.f*pKernels->dot(Codebook.GetRow(j), pInput, iInputs);
+			if(fDist < fBest || (fDist == fBest && j < iBest) ) {
+				fBest = fDist;
+				iBest = j;
+			}
+		}
+	}
+	return iBest;
+}
+
+float SOMIndex::MeasureRecall(SOMCodebook &Codebook, const float *pInputs, const unsigned int &iSamples) {
+	if(iSamples == 0) {
+		return m_fRecall;
+	}
+	const unsigned int iInputs = Codebook.GetNrOfInputs();
+
+	std::vector<unsigned int> vExact(iSamples);
+	double fExact = omp_get_wtime();
+	for(unsigned int i = 0; i < iSamples; i++) {
+		vExact[i] = Codebook.FindBMU(&pInputs[(size_t)i*iInputs]);
+	}
+	fExact = omp_get_wtime() - fExact;
+
+	unsigned int iFound = 0;
+	double fApprox = omp_get_wtime();
+	for(unsigned int i = 0; i < iSamples; i++) {
+		if(FindBMU(Codebook, &pInputs[(size_t)i*iInputs]) == vExact[i]) {
+			iFound++;
+		}
+	}
+	fApprox = omp_get_wtime() - fApprox;
+
+	m_fRecall 	= (float)iFound / (float)iSamples;
+	m_fSpeedup 	= fApprox > 0.0 ? (float)(fExact / fApprox) : 0.f;
+	return m_fRecall;
+}
+
+float SOMIndex::GetRecall() const {
+	return m_fRecall;
+}
+
+float SOMIndex::GetSpeedup() const {
+	return m_fSpeedup;
+}
@@ -7,18 +7,10 @@
 
 #include <cassert>
 #include <cmath>
-
-
-struct saxmy_functor {
-	const float a;
-
-	saxmy_functor(float _a) : a(_a) {}
-
-	__host__ __device__
-	float operator()(const float& x, const float& y) const { 
-		return a * (x - y);
-	}
-};
+#include <iostream>
+#include <thrust/for_each.h>
+#include <thrust/extrema.h>
+#include <thrust/iterator/counting_iterator.h>
 
 
 // return the biggest of two tuples
@@ -78,23 +70,72 @@ float hostGetMin(const thrust::device_vector<float>& vec, unsigned int &ID) {
 }
 //////////////////////////////////////////////////////////////////////////////////////////////
 
-/**
- * 
- */
-struct minus_pow_functor {
-    const float fVal;
-    minus_pow_functor(float val) : fVal(val) {}
+namespace ANN {
 
-    __host__ __device__
-	float operator()(const float& val) const { 
-		return pow(fVal-val, 2);
+SOMWorkspace::SOMWorkspace() : m_iInputs(0), m_iInputSize(0) {
+
+}
+
+void SOMWorkspace::SetInputs(const ANN::TrainingSet &InputSet, const unsigned int &iInputSize) {
+	m_iInputs 		= InputSet.GetNrElements();
+	m_iInputSize 	= iInputSize;
+
+	for(unsigned int i = 0; i < m_iInputs; i++) {
+		assert(InputSet.GetInput(i).size() == m_iInputSize);
 	}
-};
 
-struct sqrt_functor {
-    __host__ __device__
-	float operator()(const float& val) const { 
-		return sqrt(val);
+	// the inputs are stored one after another, so one copy uploads the whole set
+	const float *pInputs = InputSet.GetInputBuffer();
+	m_dvInputs.assign(pInputs, pInputs + static_cast<size_t>(m_iInputs)*m_iInputSize);
+}
+
+void SOMWorkspace::Resize(const unsigned int &iNeurons) {
+	if(m_dvDist.size() != iNeurons) {
+		m_dvDist.resize(iNeurons);
+	}
+}
+
+const float *SOMWorkspace::GetInput(const unsigned int &iID) const {
+	assert(iID < m_iInputs);
+	return thrust::raw_pointer_cast(m_dvInputs.data() ) + static_cast<size_t>(iID)*m_iInputSize;
+}
+
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Squared distance of neuron x to the input, corrected by the conscience mechanism.
+ * The conscience of the neuron gets updated in the same run.
+ */
+struct bmu_functor {
+	const float *pEdges;
+	const float *pInput;
+	float *pDist;
+	float *pConscience;
+	const unsigned int iWidth;
+	const unsigned int iHeight;
+	const float fConscienceRate;
+
+	bmu_functor(const float *_pEdges, const float *_pInput, float *_pDist, float *_pConscience,
+			const unsigned int &_iWidth, const unsigned int &_iHeight, const float &_fConscienceRate) :
+		pEdges(_pEdges), pInput(_pInput), pDist(_pDist), pConscience(_pConscience),
+		iWidth(_iWidth), iHeight(_iHeight), fConscienceRate(_fConscienceRate) {}
+
+	__host__ __device__
+	void operator()(const unsigned int &x) const {
+		float fDist = 0.f;
+		for(unsigned int y = 0; y < iHeight; y++) {
+			float fDiff = pInput[y] - pEdges[y*iWidth+x];
+			fDist += fDiff*fDiff;
+		}
+
+		float fRes = fDist;
+		if(fConscienceRate > 0.f) {
+			fRes = fDist - (1.f / (float)iWidth - pConscience[x]);
+		}
+		pConscience[x] = fConscienceRate * (fDist - pConscience[x]);
+		pDist[x] = fRes;
 	}
 };
 
@@ -106,78 +147,34 @@ struct sqrt_functor {
  * ROW3		toNeur3	toNeur3	toNeur3	..
  * ROW(n+1)	..		..		..
  */
-unsigned int hostSOMFindBMNeuronID( thrust::device_vector<float> &ConscienceVector,
+unsigned int hostSOMFindBMNeuronID( ANN::SOMWorkspace &Workspace,
+		thrust::device_vector<float> &ConscienceVector,
 		const ANN::Matrix &SOMEdgeMatrix, 
-		const thrust::device_vector<float> &InputVector,
+		const unsigned int &iInput,
 		const float &fConscienceRate) 
 {
-	unsigned int BMUID 		= 0;
 	unsigned int iWidth 	= SOMEdgeMatrix.getW();
 	unsigned int iHeight 	= SOMEdgeMatrix.getH();
 	
 	assert(iWidth > 0);
 	assert(iHeight > 0);
-	
-	thrust::device_vector<float> dvRes(iWidth, 0.f);
-	thrust::device_vector<float> dvTmp(iWidth, 0.f); // temporary
-	
-	for(unsigned int y = 0; y < iHeight; y++) {
-		thrust::transform(
-			SOMEdgeMatrix.getRowBegin(y),		// input
-			SOMEdgeMatrix.getRowEnd(y), 		// input
-			dvTmp.begin(), 						// result
-			minus_pow_functor(InputVector[y]) ); // functor
-
-		thrust::transform(
-			dvRes.begin(), 						// input
-			dvRes.end(), 						// input
-			dvTmp.begin(),						// input
-			dvRes.begin(), 						// result
-			thrust::plus<float>() );			// functor
-	}
-
-	dvTmp = dvRes;
-
-	// implementation of conscience mechanism
-	if(fConscienceRate > 0.f) {
-		thrust::device_vector<float> dvConscience(iWidth, 1.f / (float)iWidth);
-
-		thrust::transform(
-			dvConscience.begin(),
-			dvConscience.end(),
-			ConscienceVector.begin(),
-			dvConscience.begin(),
-			thrust::minus<float>() );
-
-		thrust::transform(
-			dvRes.begin(),
-			dvRes.end(),
-			dvConscience.begin(),
-			dvRes.begin(),
-			thrust::minus<float>() );
-	}
-
-	thrust::transform(
-		dvTmp.begin(),
-		dvTmp.end(),
-		ConscienceVector.begin(),
-		ConscienceVector.begin(),
-		saxmy_functor(fConscienceRate) );
-	// end of implementation of conscience mechanism
-
-/*
-	thrust::transform(
-		dvRes.begin(),							// input
-		dvRes.end(), 							// input
-		dvRes.begin(), 							// result
-		sqrt_functor() );						// functor
-*/
-	hostGetMin(dvRes, BMUID);
-	
-//	dvRes.clear();									// cleanup
-//	dvTmp.clear();									// cleanup
-	
-	return BMUID;
+	assert(iHeight == Workspace.m_iInputSize);
+	assert(Workspace.m_dvDist.size() == iWidth);
+	assert(ConscienceVector.size() == iWidth);
+
+	// distances of all neurons in one run
+	thrust::for_each(
+		thrust::counting_iterator<unsigned int>(0),
+		thrust::counting_iterator<unsigned int>(iWidth),
+		bmu_functor(
+			thrust::raw_pointer_cast(SOMEdgeMatrix.data() ),
+			Workspace.GetInput(iInput),
+			thrust::raw_pointer_cast(Workspace.m_dvDist.data() ),
+			thrust::raw_pointer_cast(ConscienceVector.data() ),
+			iWidth, iHeight, fConscienceRate) );
+
+	// the first neuron with the smallest distance, only its index comes back to the host
+	return thrust::min_element(Workspace.m_dvDist.begin(), Workspace.m_dvDist.end() ) - Workspace.m_dvDist.begin();
 }
 
 /* // TODO fucking need better GRAKA
@@ -193,26 +190,48 @@ struct dist_functor {
 };
 */ // TODO fucking need better GRAKA
 
-struct gaussian_bell_functor {
-	float fSigmaT;
-	gaussian_bell_functor(const float &sigmaT) : fSigmaT(sigmaT)	{}
-	
-    __host__ __device__
-	float operator()(const float& dist) const { 
-    	return ANN::fcn_gaussian_bell(dist, fSigmaT);
-	}
-};
-
+/*
+ * Moves the edges of neuron x towards the input,
+ * if the neuron is inside the radius fSigmaT around the BMU.
+ */
 struct hebbian_functor {
-	float fLearningRate;
-	float fInput;
-	
-	hebbian_functor(const float &learning_rate, const float &input) : 
-		fLearningRate(learning_rate), fInput(input) {}
-	
-    __host__ __device__
-	float operator()(const float& fWeight, const float& fInfluence) const { 
-    	return fWeight + (fInfluence*fLearningRate*(fInput-fWeight) );
+	float *pEdges;
+	const float *pPositions;
+	const float *pInput;
+	const unsigned int iWidth;
+	const unsigned int iEdgeHeight;
+	const unsigned int iPosHeight;
+	const unsigned int iBMUID;
+	const float fSigmaT;
+	const float fLearningRate;
+
+	hebbian_functor(float *_pEdges, const float *_pPositions, const float *_pInput,
+			const unsigned int &_iWidth, const unsigned int &_iEdgeHeight, const unsigned int &_iPosHeight,
+			const unsigned int &_iBMUID, const float &_fSigmaT, const float &_fLearningRate) :
+		pEdges(_pEdges), pPositions(_pPositions), pInput(_pInput),
+		iWidth(_iWidth), iEdgeHeight(_iEdgeHeight), iPosHeight(_iPosHeight),
+		iBMUID(_iBMUID), fSigmaT(_fSigmaT), fLearningRate(_fLearningRate) {}
+
+	__host__ __device__
+	void operator()(const unsigned int &x) const {
+		// Distance = sqrt(pow(x,2)+pow(y,2)+pow(z,2)+pow(n+1,2) );
+		float fDist = 0.f;
+		for(unsigned int y = 0; y < iPosHeight; y++) {
+			float fDiff = pPositions[y*iWidth+iBMUID] - pPositions[y*iWidth+x];
+			fDist += fDiff*fDiff;
+		}
+		fDist = sqrt(fDist);
+
+		// Only handle neurons in radius
+		if(fDist > fSigmaT) {
+			return;
+		}
+
+		float fInfluence = ANN::fcn_gaussian_bell(fDist, fSigmaT);
+		for(unsigned int y = 0; y < iEdgeHeight; y++) {
+			float fWeight = pEdges[y*iWidth+x];
+			pEdges[y*iWidth+x] = fWeight + (fInfluence*fLearningRate*(pInput[y]-fWeight) );
+		}
 	}
 };
 
@@ -226,103 +245,55 @@ struct hebbian_functor {
  */
 void hostSOMPropagateBW( ANN::Matrix &SOMEdgeMatrix,
 		const ANN::Matrix &SOMPositionMatrix, 
-		const thrust::device_vector<float> &dvInputVector,
+		const ANN::SOMWorkspace &Workspace,
+		const unsigned int &iInput,
 		const unsigned int BMUID, 
 		const float &fSigmaT, 
 		const float &fLearningRate
 		) 
 {
 	unsigned int iWidth 	= SOMPositionMatrix.getW();
-	unsigned int iHeight 	= SOMPositionMatrix.getH();
-	
-	// TODO PUT this in the TRAINING function the increase performance
-	thrust::device_vector<float> dvBMUPos = SOMPositionMatrix.getCol(BMUID);
-	thrust::device_vector<float> dvTmp(iWidth, 0.f); // temporary
-	thrust::device_vector<float> dvInfluence(iWidth, 0.f); 
-	thrust::device_vector<float> dvDist(iWidth, 0.f);
-	
-	// 1. Calc distances for all neurons to BMNeuron
-	// Distance = sqrt(pow(x,2)+pow(y,2)+pow(z,2)+pow(n+1,2) );
-	for(unsigned int y = 0; y < iHeight; y++) { 	// for each coordinate position of the neuron
-		thrust::transform(
-			SOMPositionMatrix.getRowBegin(y),	// input
-			SOMPositionMatrix.getRowEnd(y), 	// input
-			dvTmp.begin(), 						// result
-			minus_pow_functor(dvBMUPos[y]) ); 	// functor
-		
-		thrust::transform(
-			dvDist.begin(), 					// input
-			dvDist.end(), 						// input
-			dvTmp.begin(),						// input
-			dvDist.begin(), 					// result
-			thrust::plus<float>() );			// functor
-	}
-	thrust::transform(
-		dvDist.begin(),							// input
-		dvDist.end(), 							// input
-		dvDist.begin(), 						// result
-		sqrt_functor() );						// functor
-	
-	// 2. Calculate the influence for each neuron
-	thrust::transform(
-		dvDist.begin(),							// input
-		dvDist.end(), 							// input
-		dvInfluence.begin(), 					// result
-		gaussian_bell_functor(fSigmaT) );		// functor
-	
-	// 3. Only handle neurons in radius:
-	// 3a. Make stencil
-	dvTmp.assign(iWidth, fSigmaT);
-	thrust::transform(
-		dvDist.begin(), 						// input 1
-		dvDist.end(),							// input 1
-		dvTmp.begin(),							// input 1
-		dvTmp.begin(), 							// result
-		thrust::less_equal<float>() 			// functor
-	);
-	
-	// 3b. Use stencil to modify only neurons inside the radius
-	// Save result in the ANN::Matrix
-	iWidth 	= SOMEdgeMatrix.getW();
-	iHeight = SOMEdgeMatrix.getH();
-
-	for(unsigned int y = 0; y < iHeight; y++) {		// for each edge of the neuron   	
-		thrust::transform_if(
-			SOMEdgeMatrix.getRowBegin(y),		// input 1
-			SOMEdgeMatrix.getRowEnd(y), 		// input 1
-			dvInfluence.begin(),				// input 2
-			dvTmp.begin(),						// stencil
-			SOMEdgeMatrix.getRowBegin(y), 		// result
-			hebbian_functor(fLearningRate, dvInputVector[y]), // functor
-			thrust::identity<int>() ); 			// predicate
-	}
-	
-	// 4. Clean!
-//	dvBMUPos.clear();
-//	dvTmp.clear(); 									// cleanup
-//	dvInfluence.clear(); 							// cleanup
-//	dvDist.clear(); 								// cleanup
+
+	assert(SOMEdgeMatrix.getW() == iWidth);
+	assert(SOMEdgeMatrix.getH() == Workspace.m_iInputSize);
+	assert(BMUID < iWidth);
+
+	// distance to the BMU, influence and update of the edges in one run per neuron
+	thrust::for_each(
+		thrust::counting_iterator<unsigned int>(0),
+		thrust::counting_iterator<unsigned int>(iWidth),
+		hebbian_functor(
+			thrust::raw_pointer_cast(SOMEdgeMatrix.data() ),
+			thrust::raw_pointer_cast(SOMPositionMatrix.data() ),
+			Workspace.GetInput(iInput),
+			iWidth, SOMEdgeMatrix.getH(), SOMPositionMatrix.getH(),
+			BMUID, fSigmaT, fLearningRate) );
 }
 
-void hostSOMTraining( thrust::device_vector<float> &ConscienceVector,
+void hostSOMTraining( ANN::SOMWorkspace &Workspace,
+		thrust::device_vector<float> &ConscienceVector,
 		ANN::Matrix &SOMEdgeMatrix,
 		const ANN::Matrix &SOMPositionMatrix, 
-		const ANN::TrainingSet &InputSet,
 		const unsigned int &iCycles,
 		const float &fSigma0, 
 		const float &fLearningRate0,
 		const float &fConscienceRate,
 		float (*pfnDecay)(const float &, const float &, const float &) )
 {
+	assert(Workspace.m_iInputs > 0);
+
 	float fLambda 	= iCycles / log(fSigma0);
 	
 	int iMin 		= 0;
-	int iMax 		= InputSet.GetNrElements()-1;
+	int iMax 		= Workspace.m_iInputs-1;
 	unsigned int iProgCount = 1;
 	
 	// use 8 proximal neurons as standard
 	float fSigmaT = sqrt(2.f);
 
+	// buffers of the cycles
+	Workspace.Resize(SOMEdgeMatrix.getW() );
+
 	for(unsigned int i = 0; i < iCycles; i++) {
 		if(iCycles >= 10) {
 			if(((i+1) / (iCycles/10)) == iProgCount && (i+1) % (iCycles/10) == 0) {
@@ -333,13 +304,11 @@ void hostSOMTraining( thrust::device_vector<float> &ConscienceVector,
 		else {
 			std::cout<<"Current training progress calculated by the CPU is: "<<(float)(i+1.f)/(float)iCycles*100.f<<"%/Step="<<i+1<<std::endl;
 		}
-		// Set input
-		std::vector<float> vCurInput = InputSet.GetInput(ANN::RandInt(iMin, iMax) );
-		thrust::device_vector<float> dvInputVector(vCurInput.size() );
-		thrust::copy(vCurInput.begin(), vCurInput.end(), dvInputVector.begin() );
+		// Set input, the training set is on the device already
+		unsigned int iInput = ANN::RandInt(iMin, iMax);
 		
 		// Find BMNeuron
-		unsigned int BMUID = hostSOMFindBMNeuronID(ConscienceVector, SOMEdgeMatrix, dvInputVector, fConscienceRate);
+		unsigned int BMUID = hostSOMFindBMNeuronID(Workspace, ConscienceVector, SOMEdgeMatrix, iInput, fConscienceRate);
 
 		// Calc m_fSigmaT if conscience is _not_ used
 		if(fConscienceRate <= 0.f)
@@ -349,7 +318,8 @@ void hostSOMTraining( thrust::device_vector<float> &ConscienceVector,
 		// Propagate BW
 		hostSOMPropagateBW( SOMEdgeMatrix,
 				SOMPositionMatrix, 	// const
-				dvInputVector,		// const
+				Workspace,		// const
+				iInput,			// const
 				BMUID,			// const
 				fSigmaT,		// const
 				fLearningRate ); 	// const
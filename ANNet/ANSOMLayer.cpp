@@ -97,35 +97,37 @@ void SOMLayer::Resize(const std::vector<unsigned int> &vDim) {
 
 	assert(vDim.size() > 0);
 
-	m_vDim = vDim;
-
 	unsigned int iSize = 1;
 	for(unsigned int i = 0; i < vDim.size(); i++) {
 		iSize *= vDim[i];
 	}
 	Resize(iSize);
 
+	m_vDim = vDim;
+
 	/*
-	 * TODO implement position handling of the neurons
+	 * Cartesian coordinates, the first dimension runs fastest (like Resize(iWidth, iHeight))
 	 */
+	std::vector<float> vPos(vDim.size() );
+	for(unsigned int i = 0; i < iSize; i++) {
+		unsigned int iRest = i;
+		for(unsigned int j = 0; j < vDim.size(); j++) {
+			vPos[j] = iRest % vDim[j];
+			iRest /= vDim[j];
+		}
+		m_lNeurons[i]->SetPosition(vPos);
+	}
 }
 
-void SOMLayer::ConnectLayer(AbsLayer *pDestLayer, const bool &bAllowAdapt) {
-	AbsNeuron *pSrcNeuron = NULL;
-
+void SOMLayer::ConnectLayer(AbsLayer *pDestLayer, const bool &bAllowAdapt, EdgeArena *pArena) {
 	/*
 	 * Vernetze jedes Neuron dieser Schicht mit jedem Neuron in "pDestLayer"
 	 */
-	for(int i = 0; i < static_cast<int>(m_lNeurons.size() ); i++) {
-		std::cout<<"Connect input neuron " << i << " to output layer. Progress: "<<i+1<<"/"<<m_lNeurons.size()<<std::endl;
-		pSrcNeuron = m_lNeurons[i];
-		if(pSrcNeuron != NULL) {
-			Connect(pSrcNeuron, pDestLayer, bAllowAdapt);
-		}
-	}
+	std::cout<<"Connect "<<m_lNeurons.size()<<" input neurons to output layer"<<std::endl;
+	Connect(this, pDestLayer, bAllowAdapt, pArena);
 }
 
-void SOMLayer::ConnectLayer(AbsLayer *pDestLayer, const F2DArray &f2dEdgeMat, const bool &bAllowAdapt) {
+void SOMLayer::ConnectLayer(AbsLayer *pDestLayer, const F2DArray &f2dEdgeMat, const bool &bAllowAdapt, EdgeArena *pArena) {
 	AbsNeuron *pSrcNeuron = NULL;
 
 	/*
@@ -140,7 +142,7 @@ void SOMLayer::ConnectLayer(AbsLayer *pDestLayer, const F2DArray &f2dEdgeMat, co
 
 		fVals = f2dEdgeMat.GetSubArrayX(i);
 		if(pSrcNeuron != NULL) {
-			Connect(pSrcNeuron, pDestLayer, fVals, fMoms, bAllowAdapt);
+			Connect(pSrcNeuron, pDestLayer, fVals, fMoms, bAllowAdapt, pArena);
 		}
 	}
 }
@@ -10,6 +10,7 @@
 #include <cassert>
 #include <limits>
 #include <cmath>
+#include <cstdlib>
 
 #include <omp.h>
 
@@ -21,16 +22,22 @@
 
 #include <math/ANFunctions.h>
 #include <math/ANRandom.h>
+#include <math/ANKernels.h>
 
 #include <containers/ANTrainingSet.h>
+#include <containers/ANStreamingSet.h>
 #include <containers/ANConTable.h>
 
 namespace ANN {
 
+/* FindNeighbors() keeps the coordinates on the stack */
+#define ANSOM_MAX_LATTICE_DIMS 16
+
 SOMNet::SOMNet() {
 	m_pIPLayer 		= NULL;
 	m_pOPLayer 		= NULL;
 	m_pBMNeuron 	= NULL;
+	m_iBMNeuron 	= 0;
 
 	m_iCycle 		= 0;
 	m_fSigma0 		= 0.f;
@@ -45,6 +52,14 @@ SOMNet::SOMNet() {
 	// Conscience mechanism
 	m_fConscienceRate 	= 0.f;
 
+	m_fTrainingMode = ANSOMOnline;
+	m_iPosDim 		= 0;
+	m_fTableSigma 	= -1.f;
+
+	m_bApproximate 	= false;
+	m_iIndexRebuild = 1000;
+	m_fResolutionFactor = 2.f;
+
 	// mexican hat shaped function for this SOM
 	SetDistFunction(&Functions::fcn_gaussian);
 
@@ -67,6 +82,15 @@ SOMNet::SOMNet(AbsNet *pNet) {
 	// Copy training set
 	SetTrainingSet(pNet->GetTrainingSet() );
 
+	m_fConscienceRate 	= 0.f;
+	m_fTrainingMode 	= ANSOMOnline;
+	m_iPosDim 			= 0;
+	m_fTableSigma 		= -1.f;
+	m_bApproximate 		= false;
+	m_iIndexRebuild 	= 1000;
+	m_fResolutionFactor = 2.f;
+	SetDistFunction(&Functions::fcn_gaussian);
+
 	m_fTypeFlag 	= ANNetSOM;
 }
 
@@ -91,6 +115,8 @@ void SOMNet::CreateNet(const ConTable &Net) {
 		std::vector<float> vPos = Net.Neurons.at(i).m_vPos;
 		GetLayer(iLayerID)->GetNeuron(iNeurID)->SetPosition(vPos);
 	}
+	m_Codebook.Clear();
+	m_Index.Clear();
 }
 
 SOMNet::~SOMNet() {
@@ -194,10 +220,12 @@ void SOMNet::CreateSOM(const std::vector<unsigned int> &vDimI, const std::vector
 	AbsNet::AddLayer(m_pOPLayer);
 
 	std::cout<< "Connect layer .." <<std::endl;
-	((SOMLayer*)m_pIPLayer)->ConnectLayer(m_pOPLayer);
+	((SOMLayer*)m_pIPLayer)->ConnectLayer(m_pOPLayer, true, &m_EdgeArena);
 
 	// find sigma0
 	FindSigma0();
+	m_Codebook.Clear();
+	m_Index.Clear();
 }
 
 void SOMNet::CreateSOM(const std::vector<unsigned int> &vDimI, const std::vector<unsigned int> &vDimO,
@@ -217,12 +245,14 @@ void SOMNet::CreateSOM(const std::vector<unsigned int> &vDimI, const std::vector
 	AbsNet::AddLayer(m_pOPLayer);
 
 	std::cout<< "Connect layer .." <<std::endl;
-	((SOMLayer*)m_pIPLayer)->ConnectLayer(m_pOPLayer, f2dEdgeMat);
+	((SOMLayer*)m_pIPLayer)->ConnectLayer(m_pOPLayer, f2dEdgeMat, true, &m_EdgeArena);
 
 	m_pOPLayer->ImpPositions(f2dNeurPos);
 
 	// find sigma0
 	FindSigma0();
+	m_Codebook.Clear();
+	m_Index.Clear();
 }
 
 void SOMNet::CreateSOM(	const unsigned int &iWidthI, const unsigned int &iHeightI,
@@ -248,16 +278,27 @@ void SOMNet::CreateSOM(	const unsigned int &iWidthI, const unsigned int &iHeight
 	AbsNet::AddLayer(m_pOPLayer);
 
 	std::cout<< "Connect layer .." <<std::endl;
-	((SOMLayer*)m_pIPLayer)->ConnectLayer(m_pOPLayer);
+	((SOMLayer*)m_pIPLayer)->ConnectLayer(m_pOPLayer, true, &m_EdgeArena);
 
 	// find sigma0
 	FindSigma0();
+	m_Codebook.Clear();
+	m_Index.Clear();
 }
 
 void SOMNet::Training(const unsigned int &iCycles) {
+	if(m_vResolutionShares.size() > 1) {
+		TrainMultiRes(iCycles);
+	}
+	else {
+		TrainMap(iCycles);
+	}
+}
+
+void SOMNet::TrainMap(const unsigned int &iCycles) {
 	assert(iCycles > 0);
 	assert(m_fSigma0 > 0.f);
-	if(GetTrainingSet() == NULL) {
+	if(m_pTrainingData == NULL && m_pTrainingStream == NULL) {
 		std::cout<<"No training set available!"<<std::endl;
 		return;
 	}
@@ -266,9 +307,34 @@ void SOMNet::Training(const unsigned int &iCycles) {
 	m_fLambda 	= m_iCycles / log(m_fSigma0);
 
 	int iMin 	= 0;
-	int iMax 	= GetTrainingSet()->GetNrElements()-1;
+	int iMax 	= m_pTrainingData != NULL ? m_pTrainingData->GetNrElements()-1 : 0;
 	unsigned int iProgCount = 1;
 
+	// a stream is presented chunk by chunk, in the order of the stream (shuffled if set in the stream)
+	TrainingSet *pChunk 	= NULL;
+	unsigned int iSample 	= 0;
+	if(m_pTrainingStream != NULL) {
+		m_pTrainingStream->Rewind();
+	}
+
+	// the training works on the dense codebook, the edges get updated at the end
+	m_Codebook.Import(m_pOPLayer);
+	if(m_fConscienceRate > 0.f) {
+		unsigned int iSize = m_pOPLayer->GetNeurons().size();
+		m_vConscience.resize(iSize);
+		m_vDistances.resize(iSize);
+		for(unsigned int i = 0; i < iSize; i++) {
+			m_vConscience[i] = ((SOMNeuron*)m_pOPLayer->GetNeuron(i))->GetConscience();
+		}
+	}
+	BuildLattice();
+
+	// a new map or a changed size starts from scratch, otherwise the last index is the starting point
+	const bool bIndex = m_bApproximate && m_fConscienceRate <= 0.f && !(m_fTrainingMode & ANSOMBatch);
+	if(bIndex) {
+		m_Index.Build(m_Codebook);
+	}
+
 	std::cout<< "Process the SOM now" <<std::endl;
 	for(m_iCycle = 0; m_iCycle < static_cast<unsigned int>(m_iCycles); m_iCycle++) {
 		if(m_iCycles >= 10) {
@@ -280,11 +346,44 @@ void SOMNet::Training(const unsigned int &iCycles) {
 			std::cout<<"Current training progress calculated by the CPU is: "<<(float)(m_iCycle+1.f)/(float)m_iCycles*100.f<<"%/Step="<<m_iCycle+1<<std::endl;
 		}
 
+		// Batch SOM: the whole training set in every cycle
+		if(m_fTrainingMode & ANSOMBatch) {
+			m_fSigmaT 			= m_DistFunction->decay(m_fSigma0, m_iCycle, m_fLambda);
+			m_fLearningRateT 	= m_DistFunction->decay(m_fLearningRate, m_iCycle, m_iCycles);
+			TrainEpoch();
+			continue;
+		}
+
 	    // The input vectors are presented to the network at random
-	    SetInput( GetTrainingSet()->GetInput(RandInt(iMin, iMax) ) );
+	    SampleView Input;
+	    if(m_pTrainingStream != NULL) {
+	    	if(pChunk == NULL || iSample == pChunk->GetNrElements() ) {
+	    		pChunk = m_pTrainingStream->NextChunk();
+	    		if(pChunk == NULL) {	// end of the file: next epoch
+	    			m_pTrainingStream->Rewind();
+	    			pChunk = m_pTrainingStream->NextChunk();
+	    		}
+	    		if(pChunk == NULL) {
+	    			std::cout<<"Training stream delivers no samples!"<<std::endl;
+	    			return;
+	    		}
+	    		iSample = 0;
+	    	}
+	    	Input = pChunk->GetInput(iSample++);
+	    }
+	    else {
+	    	Input = m_pTrainingData->GetInput(RandInt(iMin, iMax) );
+	    }
+	    assert(Input.size() == m_Codebook.GetNrOfInputs() );
+
+	    // the weights drift away from the clusters of the index
+	    if(bIndex && m_iCycle > 0 && m_iCycle % m_iIndexRebuild == 0) {
+	    	ReportIndex(m_pTrainingStream != NULL ? pChunk : m_pTrainingData);
+	    	m_Index.Build(m_Codebook, 1);
+	    }
 
 		// Present the input vector to each node and determine the BMU
-		FindBMNeuron();
+		FindBMNeuron(Input.GetData() );
 
 		// Calculate the width of the neighborhood for this time step
 		if(m_fConscienceRate <= 0.f)	// without conscience mechanism
@@ -293,12 +392,79 @@ void SOMNet::Training(const unsigned int &iCycles) {
 		m_fLearningRateT = m_DistFunction->decay(m_fLearningRate, m_iCycle, m_iCycles);
 
 		// Adjust the weight vector of the BMU and its neighbors
-		PropagateBW();
+		PropagateBW(Input.GetData() );
+	}
+
+	if(bIndex) {
+		ReportIndex(m_pTrainingStream != NULL ? pChunk : m_pTrainingData);
+	}
+
+	m_Codebook.Export(m_pOPLayer);
+	for(unsigned int i = 0; i < m_pOPLayer->GetNeurons().size(); i++) {
+		SOMNeuron *pNeuron = (SOMNeuron*)m_pOPLayer->GetNeuron(i);
+		pNeuron->SetLearningRate(m_fLearningRateT);
+		if(m_fConscienceRate > 0.f) {
+			pNeuron->SetConscience(m_vConscience[i]);
+		}
 	}
 }
 
 void SOMNet::PropagateFW() {
-	// TODO
+	assert(m_pIPLayer != NULL && m_pOPLayer != NULL);
+
+	if(m_Codebook.GetNrOfNeurons() != m_pOPLayer->GetNeurons().size() ) {
+		UpdateCodebook();
+	}
+	const unsigned int iSize = m_Codebook.GetNrOfNeurons();
+
+	std::vector<float> vInput(m_pIPLayer->GetNeurons().size() );
+	for(unsigned int i = 0; i < vInput.size(); i++) {
+		vInput[i] = m_pIPLayer->GetNeuron(i)->GetValue();
+	}
+	assert(vInput.size() == m_Codebook.GetNrOfInputs() );
+
+	m_vDistances.resize(iSize);
+	m_iBMNeuron = m_Codebook.FindBMU(&vInput[0], &m_vDistances[0]);
+	m_pBMNeuron = (SOMNeuron*)m_pOPLayer->GetNeuron(m_iBMNeuron);
+
+	#pragma omp parallel for
+	for(int i = 0; i < static_cast<int>(iSize); i++) {
+		m_pOPLayer->GetNeuron(i)->SetValue(sqrt(m_vDistances[i]) );
+	}
+}
+
+void SOMNet::UpdateCodebook() {
+	assert(m_pOPLayer != NULL);
+	m_Codebook.Import(m_pOPLayer);
+}
+
+void SOMNet::MapBatch(	const float *pInput, const unsigned int &iSamples, unsigned int *pBMUs,
+						float *pErrors, const unsigned int &iK, uint64_t *pHits)
+{
+	assert(m_pOPLayer != NULL);
+	assert(pInput != NULL && pBMUs != NULL);
+	if(iSamples == 0) {
+		return;
+	}
+
+	if(m_Codebook.GetNrOfNeurons() != m_pOPLayer->GetNeurons().size() ) {
+		UpdateCodebook();
+	}
+
+	m_Codebook.FindBMUs(pInput, iSamples, pBMUs, pErrors, iK);
+
+	if(pErrors != NULL) {
+		const int iValues = iSamples*iK;
+		#pragma omp parallel for
+		for(int i = 0; i < iValues; i++) {
+			pErrors[i] = sqrt(pErrors[i]);
+		}
+	}
+	if(pHits != NULL) {
+		for(unsigned int i = 0; i < iSamples; i++) {
+			pHits[pBMUs[(size_t)i*iK]]++;
+		}
+	}
 }
 
 void SOMNet::PropagateBW() {
@@ -322,57 +488,772 @@ void SOMNet::PropagateBW() {
 	}
 }
 
-void SOMNet::SetLearningRate(const float &fVal) {
-	m_fLearningRate = fVal;
+void SOMNet::PropagateBW(const float *pInput) {
+	const float fRate = m_fLearningRateT;
+
+	// only the neurons within the radius get visited
+	if(!m_vLattice.empty() ) {
+		UpdateLatticeWeights();
+		FindNeighbors(m_iBMNeuron, m_vNeighbors, m_vNeighborWeights);
+
+		const int iNeighbors = m_vNeighbors.size();
+		#pragma omp parallel for if(iNeighbors*m_Codebook.GetNrOfInputs() > 4096)
+		for(int i = 0; i < iNeighbors; i++) {
+			m_Codebook.Adapt(m_vNeighbors[i], pInput, m_vNeighborWeights[i]*fRate);
+		}
+		return;
+	}
+
+	const float *pBMU 		= &m_vPositions[m_iBMNeuron*m_iPosDim];
+	const float fSigma2 	= m_fSigmaT*m_fSigmaT;
+
 	#pragma omp parallel for
-	for(int i = 0; i < static_cast<int>(m_lLayers.size() ); i++) {
-		( (SOMLayer*)GetLayer(i) )->SetLearningRate(fVal);
+	for(int i = 0; i < static_cast<int>(m_Codebook.GetNrOfNeurons() ); i++) {
+		const float *pPos = &m_vPositions[i*m_iPosDim];
+		float fDist2 = 0.f;
+		for(unsigned int k = 0; k < m_iPosDim; k++) {
+			fDist2 += (pBMU[k]-pPos[k]) * (pBMU[k]-pPos[k]);
+		}
+
+		if(fDist2 <= fSigma2) {
+			//calculate by how much weights get adjusted ..
+			float fInfluence = m_DistFunction->distance(sqrt(fDist2), m_fSigmaT);
+			// .. and adjust them
+			m_Codebook.Adapt(i, pInput, fInfluence*fRate);
+		}
 	}
 }
 
-float SOMNet::GetLearningRate() const {
-	return m_fLearningRate;
+void SOMNet::BuildLattice() {
+	const unsigned int iSize = m_pOPLayer->GetNeurons().size();
+
+	m_iPosDim = m_pOPLayer->GetNeuron(0)->GetPosition().size();
+	m_vPositions.resize(iSize*m_iPosDim);
+	for(unsigned int i = 0; i < iSize; i++) {
+		const std::vector<float> &vPos = m_pOPLayer->GetNeuron(i)->GetPosition();
+		assert(vPos.size() == m_iPosDim);
+		std::copy(vPos.begin(), vPos.end(), &m_vPositions[i*m_iPosDim]);
+	}
+
+	m_vLattice = ((SOMLayer*)m_pOPLayer)->GetDim();
+	if(m_vLattice.empty() ) {	// SOMLayer::Resize(iSize)
+		m_vLattice.push_back(iSize);
+	}
+	m_vLatticeStrides.resize(m_vLattice.size() );
+	unsigned int iStride = 1;
+	for(unsigned int k = 0; k < m_vLattice.size(); k++) {
+		m_vLatticeStrides[k] = iStride;
+		iStride *= m_vLattice[k];
+	}
+
+	// positions may be imported (CreateSOM() with f2dNeurPos), so they must match the grid exactly
+	bool bLattice = iStride == iSize && m_vLattice.size() == m_iPosDim && m_iPosDim <= ANSOM_MAX_LATTICE_DIMS;
+	for(unsigned int i = 0; i < iSize && bLattice; i++) {
+		for(unsigned int k = 0; k < m_iPosDim; k++) {
+			if(m_vPositions[i*m_iPosDim+k] != (float)( (i / m_vLatticeStrides[k]) % m_vLattice[k]) ) {
+				bLattice = false;
+				break;
+			}
+		}
+	}
+	if(!bLattice) {
+		m_vLattice.clear();
+		m_vLatticeStrides.clear();
+		m_vLatticeDist.clear();
+		m_vLatticeWeights.clear();
+		return;
+	}
+
+	// the offset (|dx|, |dy|, ..) has the same index as the neuron at these coordinates
+	m_vLatticeDist.resize(iSize);
+	for(unsigned int i = 0; i < iSize; i++) {
+		float fDist2 = 0.f;
+		for(unsigned int k = 0; k < m_vLattice.size(); k++) {
+			float fOffset = (i / m_vLatticeStrides[k]) % m_vLattice[k];
+			fDist2 += fOffset*fOffset;
+		}
+		m_vLatticeDist[i] = sqrt(fDist2);
+	}
+	m_vLatticeWeights.assign(iSize, 0.f);
+	m_fTableSigma = -1.f;
+}
+
+void SOMNet::UpdateLatticeWeights() {
+	if(m_fTableSigma == m_fSigmaT) {
+		return;
+	}
+	m_fTableSigma = m_fSigmaT;
+
+	// only the offsets within the radius are needed
+	std::vector<unsigned int> vExtent(m_vLattice.size() );
+	unsigned int iBox = 1;
+	for(unsigned int k = 0; k < m_vLattice.size(); k++) {
+		vExtent[k] = std::min<unsigned int>(m_vLattice[k], (unsigned int)m_fSigmaT + 1);
+		iBox *= vExtent[k];
+	}
+	for(unsigned int b = 0; b < iBox; b++) {
+		unsigned int iRest = b, iOffset = 0;
+		for(unsigned int k = 0; k < m_vLattice.size(); k++) {
+			iOffset += (iRest % vExtent[k]) * m_vLatticeStrides[k];
+			iRest /= vExtent[k];
+		}
+		float fDist = m_vLatticeDist[iOffset];
+		m_vLatticeWeights[iOffset] = fDist <= m_fSigmaT ? m_DistFunction->distance(fDist, m_fSigmaT) : 0.f;
+	}
+}
+
+void SOMNet::FindNeighbors(const unsigned int &iCenter, std::vector<unsigned int> &vNeurons, std::vector<float> &vWeights) const {
+	const unsigned int iDims 	= m_vLattice.size();
+	const int iRadius 			= (int)m_fSigmaT;
+
+	vNeurons.clear();
+	vWeights.clear();
+
+	// bounding box of the radius around the center, clipped at the borders of the lattice
+	int iLow[ANSOM_MAX_LATTICE_DIMS], iHigh[ANSOM_MAX_LATTICE_DIMS], iCenterPos[ANSOM_MAX_LATTICE_DIMS], iPos[ANSOM_MAX_LATTICE_DIMS];
+	assert(iDims <= ANSOM_MAX_LATTICE_DIMS);
+	for(unsigned int k = 0; k < iDims; k++) {
+		iCenterPos[k] 	= (iCenter / m_vLatticeStrides[k]) % m_vLattice[k];
+		iLow[k] 		= std::max(0, iCenterPos[k]-iRadius);
+		iHigh[k] 		= std::min( (int)m_vLattice[k]-1, iCenterPos[k]+iRadius);
+		iPos[k] 		= iLow[k];
+	}
+
+	for(;;) {
+		// offset of all but the first coordinate
+		unsigned int iRow = 0, iRowOffset = 0;
+		for(unsigned int k = 1; k < iDims; k++) {
+			iRow 		+= iPos[k] * m_vLatticeStrides[k];
+			iRowOffset 	+= abs(iPos[k]-iCenterPos[k]) * m_vLatticeStrides[k];
+		}
+		// the first coordinate is contiguous
+		for(int x = iLow[0]; x <= iHigh[0]; x++) {
+			unsigned int iOffset = iRowOffset + abs(x-iCenterPos[0]);
+			if(m_vLatticeDist[iOffset] <= m_fSigmaT) {
+				vNeurons.push_back(iRow + x);
+				vWeights.push_back(m_vLatticeWeights[iOffset]);
+			}
+		}
+
+		// next row of the box
+		unsigned int k = 1;
+		for(; k < iDims; k++) {
+			if(++iPos[k] <= iHigh[k]) {
+				break;
+			}
+			iPos[k] = iLow[k];
+		}
+		if(k >= iDims) {
+			break;
+		}
+	}
+}
+
+void SOMNet::TrainEpoch() {
+	const unsigned int iSize = m_Codebook.GetNrOfNeurons();
+	m_vSums.assign((size_t)iSize*m_Codebook.GetNrOfInputs(), 0.0);
+	m_vHits.assign(iSize, 0);
+
+	if(m_pTrainingStream != NULL) {
+		m_pTrainingStream->Rewind();
+		for(TrainingSet *pChunk = m_pTrainingStream->NextChunk(); pChunk != NULL; pChunk = m_pTrainingStream->NextChunk() ) {
+			AccumulateBatch(pChunk);
+		}
+	}
+	else {
+		AccumulateBatch(m_pTrainingData);
+	}
+	UpdateBatch();
+}
+
+void SOMNet::AccumulateBatch(const TrainingSet *pSet) {
+	const unsigned int iSamples = pSet->GetNrElements();
+	const unsigned int iInputs 	= m_Codebook.GetNrOfInputs();
+	const unsigned int iSize 	= m_Codebook.GetNrOfNeurons();
+	if(iSamples == 0) {
+		return;
+	}
+	// FindBMUs() needs the samples one after another
+	const float *pInputs = pSet->GetInputBuffer();
+	assert(pSet->GetInput(iSamples-1).GetData() == pInputs + (size_t)(iSamples-1)*iInputs);
+	assert(pSet->GetInput(iSamples-1).size() == iInputs);
+
+	m_vBMUs.resize(iSamples);
+	m_Codebook.FindBMUs(pInputs, iSamples, &m_vBMUs[0]);
+
+	/*
+	 * Each thread sums up the samples of its own block of neurons.
+	 * No locks are needed and the order of the additions does not depend on the number of threads.
+	 */
+	#pragma omp parallel
+	{
+		int iThreads 	= omp_get_num_threads();
+		int iThread 	= omp_get_thread_num();
+		unsigned int iBegin = (unsigned int)( (unsigned long)iSize*iThread/iThreads);
+		unsigned int iEnd 	= (unsigned int)( (unsigned long)iSize*(iThread+1)/iThreads);
+
+		for(unsigned int s = 0; s < iSamples; s++) {
+			unsigned int iBMU = m_vBMUs[s];
+			if(iBMU >= iBegin && iBMU < iEnd) {
+				const float *pInput = &pInputs[(size_t)s*iInputs];
+				double *pSum 		= &m_vSums[(size_t)iBMU*iInputs];
+				for(unsigned int k = 0; k < iInputs; k++) {
+					pSum[k] += pInput[k];
+				}
+				m_vHits[iBMU]++;
+			}
+		}
+	}
+}
+
+void SOMNet::UpdateBatch() {
+	const unsigned int iInputs 	= m_Codebook.GetNrOfInputs();
+	const unsigned int iSize 	= m_Codebook.GetNrOfNeurons();
+
+	/*
+	 * On a lattice only the winners within the radius of each neuron get visited.
+	 * The neighborhood is symmetric, so the neighbors of neuron i are the winners which have i in their neighborhood.
+	 */
+	if(!m_vLattice.empty() ) {
+		UpdateLatticeWeights();
+
+		#pragma omp parallel
+		{
+			std::vector<double> vNumerator(iInputs);
+			std::vector<float> vRow(iInputs);
+			std::vector<unsigned int> vNeighbors;
+			std::vector<float> vWeights;
+
+			#pragma omp for
+			for(int i = 0; i < static_cast<int>(iSize); i++) {
+				FindNeighbors(i, vNeighbors, vWeights);
+				std::fill(vNumerator.begin(), vNumerator.end(), 0.0);
+				double fDenominator = 0.0;
+
+				for(unsigned int n = 0; n < vNeighbors.size(); n++) {
+					unsigned int iBMU = vNeighbors[n];
+					if(m_vHits[iBMU] > 0) {
+						const double *pSum = &m_vSums[(size_t)iBMU*iInputs];
+						for(unsigned int k = 0; k < iInputs; k++) {
+							vNumerator[k] += vWeights[n] * pSum[k];
+						}
+						fDenominator += vWeights[n] * (double)m_vHits[iBMU];
+					}
+				}
+				if(fDenominator > 0.0) {
+					for(unsigned int k = 0; k < iInputs; k++) {
+						vRow[k] = (float)(vNumerator[k] / fDenominator);
+					}
+					m_Codebook.SetRow(i, &vRow[0]);
+				}
+			}
+		}
+		return;
+	}
+
+	// only neurons which won at least one sample contribute
+	std::vector<unsigned int> vWinners;
+	for(unsigned int i = 0; i < iSize; i++) {
+		if(m_vHits[i] > 0) {
+			vWinners.push_back(i);
+		}
+	}
+
+	#pragma omp parallel
+	{
+		std::vector<double> vNumerator(iInputs);
+		std::vector<float> vRow(iInputs);
+
+		#pragma omp for
+		for(int i = 0; i < static_cast<int>(iSize); i++) {
+			const float *pPos = &m_vPositions[i*m_iPosDim];
+			std::fill(vNumerator.begin(), vNumerator.end(), 0.0);
+			double fDenominator = 0.0;
+
+			for(unsigned int w = 0; w < vWinners.size(); w++) {
+				unsigned int iBMU 	= vWinners[w];
+				const float *pBMU 	= &m_vPositions[iBMU*m_iPosDim];
+				float fDist = 0.f;
+				for(unsigned int k = 0; k < m_iPosDim; k++) {
+					fDist += (pBMU[k]-pPos[k]) * (pBMU[k]-pPos[k]);
+				}
+				fDist = sqrt(fDist);
+
+				// same neighborhood as in the online training
+				if(fDist <= m_fSigmaT) {
+					float fInfluence = m_DistFunction->distance(fDist, m_fSigmaT);
+					const double *pSum = &m_vSums[(size_t)iBMU*iInputs];
+					for(unsigned int k = 0; k < iInputs; k++) {
+						vNumerator[k] += fInfluence * pSum[k];
+					}
+					fDenominator += fInfluence * (double)m_vHits[iBMU];
+				}
+			}
+
+			// neurons without (positively weighted) samples in their neighborhood keep their weights
+			if(fDenominator > 0.0) {
+				for(unsigned int k = 0; k < iInputs; k++) {
+					vRow[k] = (float)(vNumerator[k] / fDenominator);
+				}
+				m_Codebook.SetRow(i, &vRow[0]);
+			}
+		}
+	}
+}
+
+void SOMNet::AccumulateMoments(const TrainingSet *pSet, std::vector<float> &vShift, std::vector<double> &vSum, std::vector<double> &vProducts, double &fCount) {
+	const unsigned int iInputs 	= m_Codebook.GetNrOfInputs();
+	const unsigned int iSamples = pSet->GetNrElements();
+	if(iSamples == 0) {
+		return;
+	}
+	const float *pInputs = pSet->GetInputBuffer();
+	assert(pSet->GetInput(iSamples-1).GetData() == pInputs + (size_t)(iSamples-1)*iInputs);
+	assert(pSet->GetInput(iSamples-1).size() == iInputs);
+
+	if(vShift.empty() ) {
+		vShift.assign(pInputs, pInputs + iInputs);
+	}
+
+	const unsigned int iBlock 	= 256;
+	const CPUKernels *pKernels 	= Kernels::GetKernels();
+
+	// one pair of sums per thread, added up in the order of the threads
+	std::vector<std::vector<double> > vThreadSums(omp_get_max_threads() );
+	std::vector<std::vector<double> > vThreadProducts(omp_get_max_threads() );
+
+	#pragma omp parallel
+	{
+		int iThreads 	= omp_get_num_threads();
+		int iThread 	= omp_get_thread_num();
+		unsigned int iBegin = (unsigned int)( (unsigned long)iSamples*iThread/iThreads);
+		unsigned int iEnd 	= (unsigned int)( (unsigned long)iSamples*(iThread+1)/iThreads);
+
+		std::vector<double> &vTSum 		= vThreadSums[iThread];
+		std::vector<double> &vTProducts = vThreadProducts[iThread];
+		vTSum.assign(iInputs, 0.0);
+		vTProducts.assign(iInputs*iInputs, 0.0);
+
+		std::vector<float> vBlock(iBlock*iInputs);
+		std::vector<float> vBlockProducts(iInputs*iInputs);
+		for(unsigned int s = iBegin; s < iEnd; s += iBlock) {
+			unsigned int iCount = std::min(iBlock, iEnd-s);
+			for(unsigned int i = 0; i < iCount; i++) {
+				const float *pInput = &pInputs[(size_t)(s+i)*iInputs];
+				float *pRow = &vBlock[i*iInputs];
+				for(unsigned int k = 0; k < iInputs; k++) {
+					pRow[k] = pInput[k] - vShift[k];
+					vTSum[k] += pRow[k];
+				}
+			}
+			// X^T X of the block in float, the sums over the blocks in double
+			std::fill(vBlockProducts.begin(), vBlockProducts.end(), 0.f);
+			pKernels->gemm_tn(&vBlock[0], &vBlock[0], &vBlockProducts[0], iInputs, iInputs, iCount, iInputs, iInputs, iInputs);
+			for(unsigned int k = 0; k < iInputs*iInputs; k++) {
+				vTProducts[k] += vBlockProducts[k];
+			}
+		}
+	}
+
+	for(unsigned int t = 0; t < vThreadSums.size(); t++) {
+		if(vThreadSums[t].empty() ) {
+			continue;
+		}
+		for(unsigned int k = 0; k < iInputs; k++) {
+			vSum[k] += vThreadSums[t][k];
+		}
+		for(unsigned int k = 0; k < iInputs*iInputs; k++) {
+			vProducts[k] += vThreadProducts[t][k];
+		}
+	}
+	fCount += iSamples;
+}
+
+bool SOMNet::InitPCA() {
+	assert(m_pOPLayer != NULL);
+	if(m_pTrainingData == NULL && m_pTrainingStream == NULL) {
+		std::cout<<"No training set available!"<<std::endl;
+		return false;
+	}
+
+	m_Codebook.Import(m_pOPLayer);
+	m_Index.Clear();
+	BuildLattice();
+
+	const unsigned int iInputs 	= m_Codebook.GetNrOfInputs();
+	const unsigned int iSize 	= m_Codebook.GetNrOfNeurons();
+
+	/*
+	 * Mean and covariance matrix in one pass
+	 */
+	std::vector<float> vShift;
+	std::vector<double> vSum(iInputs, 0.0);
+	std::vector<double> vCov(iInputs*iInputs, 0.0);
+	double fCount = 0.0;
+	if(m_pTrainingStream != NULL) {
+		m_pTrainingStream->Rewind();
+		for(TrainingSet *pChunk = m_pTrainingStream->NextChunk(); pChunk != NULL; pChunk = m_pTrainingStream->NextChunk() ) {
+			AccumulateMoments(pChunk, vShift, vSum, vCov, fCount);
+		}
+	}
+	else {
+		AccumulateMoments(m_pTrainingData, vShift, vSum, vCov, fCount);
+	}
+	if(fCount == 0.0) {
+		std::cout<<"No training set available!"<<std::endl;
+		return false;
+	}
+
+	std::vector<double> vMean(iInputs);
+	for(unsigned int k = 0; k < iInputs; k++) {
+		vMean[k] = vSum[k] / fCount;
+	}
+	for(unsigned int k = 0; k < iInputs; k++) {
+		for(unsigned int l = 0; l < iInputs; l++) {
+			vCov[k*iInputs+l] = vCov[k*iInputs+l] / fCount - vMean[k]*vMean[l];
+		}
+	}
+	for(unsigned int k = 0; k < iInputs; k++) {
+		vMean[k] += vShift[k];
+	}
+
+	/*
+	 * Extent of the positions, the largest dimension gets the first component
+	 */
+	std::vector<float> vMin(m_iPosDim, std::numeric_limits<float>::max() );
+	std::vector<float> vMax(m_iPosDim, -std::numeric_limits<float>::max() );
+	for(unsigned int i = 0; i < iSize; i++) {
+		for(unsigned int d = 0; d < m_iPosDim; d++) {
+			vMin[d] = std::min(vMin[d], m_vPositions[i*m_iPosDim+d]);
+			vMax[d] = std::max(vMax[d], m_vPositions[i*m_iPosDim+d]);
+		}
+	}
+	std::vector<std::pair<float, unsigned int> > vDims;
+	for(unsigned int d = 0; d < m_iPosDim; d++) {
+		if(vMax[d] > vMin[d]) {
+			vDims.push_back(std::make_pair(-(vMax[d]-vMin[d]), d) );
+		}
+	}
+	std::stable_sort(vDims.begin(), vDims.end() );
+	const unsigned int iComponents = std::min<unsigned int>(vDims.size(), iInputs);
+
+	/*
+	 * Largest eigenvectors of the covariance matrix: power iteration, deflated by the ones found before
+	 */
+	std::vector<std::vector<double> > vEigenVecs(iComponents, std::vector<double>(iInputs) );
+	std::vector<double> vEigenVals(iComponents, 0.0);
+	std::vector<double> vNext(iInputs);
+	for(unsigned int c = 0; c < iComponents; c++) {
+		std::vector<double> &vVec = vEigenVecs[c];
+		for(unsigned int k = 0; k < iInputs; k++) {
+			vVec[k] = 1.0 + (double)( (k+c) % iInputs) / iInputs;
+		}
+
+		for(unsigned int iIter = 0; iIter < 1000; iIter++) {
+			#pragma omp parallel for if(iInputs > 256)
+			for(int k = 0; k < static_cast<int>(iInputs); k++) {
+				double fVal = 0.0;
+				for(unsigned int l = 0; l < iInputs; l++) {
+					fVal += vCov[k*iInputs+l] * vVec[l];
+				}
+				vNext[k] = fVal;
+			}
+			for(unsigned int p = 0; p < c; p++) {
+				double fProj = 0.0;
+				for(unsigned int k = 0; k < iInputs; k++) {
+					fProj += vNext[k] * vEigenVecs[p][k];
+				}
+				for(unsigned int k = 0; k < iInputs; k++) {
+					vNext[k] -= fProj * vEigenVecs[p][k];
+				}
+			}
+
+			double fNorm = 0.0;
+			for(unsigned int k = 0; k < iInputs; k++) {
+				fNorm += vNext[k]*vNext[k];
+			}
+			fNorm = sqrt(fNorm);
+			if(fNorm <= 0.0) {	// no variance left
+				break;
+			}
+
+			double fChange = 0.0;
+			for(unsigned int k = 0; k < iInputs; k++) {
+				vNext[k] /= fNorm;
+				fChange += (vNext[k]-vVec[k]) * (vNext[k]-vVec[k]);
+			}
+			vVec 			= vNext;
+			vEigenVals[c] 	= fNorm;
+			if(fChange < 1e-12) {
+				break;
+			}
+		}
+		std::cout<<"PCA initialization: eigenvalue of component "<<c+1<<": "<<vEigenVals[c]<<std::endl;
+	}
+
+	/*
+	 * Lay out the codebook
+	 */
+	#pragma omp parallel
+	{
+		std::vector<float> vRow(iInputs);
+
+		#pragma omp for
+		for(int i = 0; i < static_cast<int>(iSize); i++) {
+			for(unsigned int k = 0; k < iInputs; k++) {
+				vRow[k] = vMean[k];
+			}
+			for(unsigned int c = 0; c < iComponents; c++) {
+				unsigned int d 	= vDims[c].second;
+				float fCoord 	= 2.f*(m_vPositions[i*m_iPosDim+d]-vMin[d]) / (vMax[d]-vMin[d]) - 1.f;
+				float fScale 	= fCoord * sqrt(vEigenVals[c]);
+				for(unsigned int k = 0; k < iInputs; k++) {
+					vRow[k] += fScale * vEigenVecs[c][k];
+				}
+			}
+			m_Codebook.SetRow(i, &vRow[0]);
+		}
+	}
+	m_Codebook.Export(m_pOPLayer);
+	return true;
+}
+
+void SOMNet::ReportIndex(const TrainingSet *pSet) {
+	if(pSet == NULL || pSet->GetNrElements() == 0) {
+		return;
+	}
+	const unsigned int iInputs 	= m_Codebook.GetNrOfInputs();
+	const unsigned int iSamples = std::min(64u, pSet->GetNrElements() );
+
+	std::vector<float> vSamples(iSamples*iInputs);
+	for(unsigned int i = 0; i < iSamples; i++) {
+		const SampleView Input = pSet->GetInput( (unsigned int)( (unsigned long)i*pSet->GetNrElements()/iSamples) );
+		assert(Input.size() == iInputs);
+		std::copy(Input.begin(), Input.end(), &vSamples[i*iInputs]);
+	}
+
+	float fRecall = m_Index.MeasureRecall(m_Codebook, &vSamples[0], iSamples);
+	std::cout<<"Approximate BMU search: recall "<<fRecall<<", speedup "<<m_Index.GetSpeedup()<<"x"<<std::endl;
+}
+
+void SOMNet::SetApproximateSearch(const bool &bEnable, const unsigned int &iProbes, const unsigned int &iRebuild, const unsigned int &iClusters) {
+	assert(iRebuild > 0);
+
+	m_bApproximate 	= bEnable;
+	m_iIndexRebuild = iRebuild;
+	m_Index.SetNrOfProbes(iProbes);
+	if(m_Index.GetNrOfClusters() != iClusters) {
+		m_Index.Clear();
+		m_Index.SetNrOfClusters(iClusters);
+	}
+}
+
+const SOMIndex *SOMNet::GetApproximateSearch() const {
+	return m_bApproximate ? &m_Index : NULL;
+}
+
+/*
+ * Multilinear interpolation of the codebook of a smaller lattice
+ */
+static void Interpolate(const SOMCodebook &Coarse, const std::vector<unsigned int> &vCoarseDim,
+						SOMCodebook &Fine, const std::vector<unsigned int> &vFineDim)
+{
+	assert(vCoarseDim.size() == vFineDim.size() );
+	assert(Coarse.GetNrOfInputs() == Fine.GetNrOfInputs() );
+
+	const unsigned int iDims 	= vFineDim.size();
+	const unsigned int iInputs 	= Fine.GetNrOfInputs();
+	const unsigned int iCorners = 1u << iDims;
+
+	#pragma omp parallel
+	{
+		std::vector<float> vRow(iInputs);
+		std::vector<unsigned int> vLow(iDims), vHigh(iDims);
+		std::vector<float> vFrac(iDims);
+
+		#pragma omp for
+		for(int i = 0; i < static_cast<int>(Fine.GetNrOfNeurons() ); i++) {
+			// position on the coarse lattice
+			unsigned int iRest = i;
+			for(unsigned int k = 0; k < iDims; k++) {
+				unsigned int iPos = iRest % vFineDim[k];
+				iRest /= vFineDim[k];
+
+				float fPos = vFineDim[k] > 1 ? (float)iPos * (vCoarseDim[k]-1) / (vFineDim[k]-1) : 0.f;
+				vLow[k] 	= std::min( (unsigned int)fPos, vCoarseDim[k]-1);
+				vHigh[k] 	= std::min(vLow[k]+1, vCoarseDim[k]-1);
+				vFrac[k] 	= fPos - vLow[k];
+			}
+
+			// weighted sum of the corners of the surrounding cell
+			std::fill(vRow.begin(), vRow.end(), 0.f);
+			for(unsigned int c = 0; c < iCorners; c++) {
+				float fWeight 		= 1.f;
+				unsigned int iIndex = 0, iStride = 1;
+				for(unsigned int k = 0; k < iDims; k++) {
+					bool bHigh = (c >> k) & 1;
+					fWeight *= bHigh ? vFrac[k] : 1.f-vFrac[k];
+					iIndex 	+= (bHigh ? vHigh[k] : vLow[k]) * iStride;
+					iStride *= vCoarseDim[k];
+				}
+				if(fWeight > 0.f) {
+					const float *pCoarse = Coarse.GetRow(iIndex);
+					for(unsigned int j = 0; j < iInputs; j++) {
+						vRow[j] += fWeight * pCoarse[j];
+					}
+				}
+			}
+			Fine.SetRow(i, &vRow[0]);
+		}
+	}
 }
 
-void SOMNet::FindBMNeuron() {
+void SOMNet::TrainMultiRes(const unsigned int &iCycles) {
 	assert(m_pIPLayer != NULL && m_pOPLayer != NULL);
 
-	float fCurVal 	= 0.f;
-	float fSmallest = std::numeric_limits<float>::max();
-	float fNrOfNeurons 	= (float)(m_pOPLayer->GetNeurons().size() );
+	m_Codebook.Import(m_pOPLayer);
+	BuildLattice();
+	if(m_vLattice.empty() || m_vLattice.size() > 8) {
+		std::cout<<"Coarse-to-fine training needs a regular lattice, the map gets trained directly"<<std::endl;
+		TrainMap(iCycles);
+		return;
+	}
 
-	#pragma omp parallel for
-	for(int i = 0; i < static_cast<int>(m_pOPLayer->GetNeurons().size() ); i++) {
-		SOMNeuron *pNeuron = (SOMNeuron*)m_pOPLayer->GetNeuron(i);
-		pNeuron->CalcDistance2Inp();
-		fCurVal = pNeuron->GetValue();
+	std::vector<unsigned int> vDimI = ((SOMLayer*)m_pIPLayer)->GetDim();
+	if(vDimI.empty() ) {
+		vDimI.push_back(m_pIPLayer->GetNeurons().size() );
+	}
+	const std::vector<unsigned int> vDimO = m_vLattice;
+	const unsigned int iLevels = m_vResolutionShares.size();
 
-		// with implementation of conscience mechanism (2nd term)
-		float fConscienceBias = 1.f/fNrOfNeurons - pNeuron->GetConscience();
-		if(m_fConscienceRate > 0.f)
-			fCurVal -= fConscienceBias;
-		// end of implementation of conscience mechanism
+	float fShares = 0.f;
+	for(unsigned int l = 0; l < iLevels; l++) {
+		fShares += m_vResolutionShares[l];
+	}
+	assert(fShares > 0.f);
+
+	// codebook and lattice of the last trained level
+	SOMCodebook Coarse;
+	std::vector<unsigned int> vCoarseDim;
+
+	const float fSigma0 = m_fSigma0;
+	for(unsigned int l = 0; l < iLevels; l++) {
+		unsigned int iLevelCycles = std::max(1u, (unsigned int)(iCycles * m_vResolutionShares[l] / fShares + 0.5f) );
+
+		// size of this level, at least two neurons per dimension
+		std::vector<unsigned int> vDim(vDimO.size() );
+		float fScale = pow(m_fResolutionFactor, (float)(iLevels-1-l) );
+		for(unsigned int k = 0; k < vDim.size(); k++) {
+			vDim[k] = vDimO[k] > 1 ? std::min(vDimO[k], std::max(2u, (unsigned int)ceil(vDimO[k] / fScale) ) ) : 1;
+		}
+		std::cout<<"Coarse-to-fine training: level "<<l+1<<"/"<<iLevels<<", "<<iLevelCycles<<" cycles"<<std::endl;
+
+		if(l == iLevels-1) {
+			// the map itself
+			if(!vCoarseDim.empty() ) {
+				Interpolate(Coarse, vCoarseDim, m_Codebook, vDim);
+				m_Codebook.Export(m_pOPLayer);
+				m_fSigma0 = std::min(fSigma0, 2.f*m_fResolutionFactor);
+			}
+			TrainMap(iLevelCycles);
+			m_fSigma0 = fSigma0;
+			break;
+		}
+
+		SOMNet Level;
+		Level.CreateSOM(vDimI, vDim);
+		if(m_pTrainingStream != NULL) {
+			Level.SetTrainingStream(m_pTrainingStream);
+		}
+		else {
+			Level.SetTrainingSet(m_pTrainingData);
+		}
+		Level.SetLearningRate(m_fLearningRate);
+		Level.SetDistFunction(m_DistFunction);
+		Level.SetTrainingMode(m_fTrainingMode);
+		if(m_fConscienceRate > 0.f) {
+			Level.SetConscienceRate(m_fConscienceRate);
+		}
 
-		if(fSmallest > fCurVal) {
-			fSmallest = fCurVal;
-			m_pBMNeuron = pNeuron;
+		if(!vCoarseDim.empty() ) {
+			Level.m_Codebook.Import(Level.m_pOPLayer);
+			Interpolate(Coarse, vCoarseDim, Level.m_Codebook, vDim);
+			Level.m_Codebook.Export(Level.m_pOPLayer);
+			Level.m_fSigma0 = std::min(Level.m_fSigma0, 2.f*m_fResolutionFactor);
 		}
+		Level.TrainMap(iLevelCycles);
+
+		Coarse.Import(Level.m_pOPLayer);
+		vCoarseDim = vDim;
 	}
+}
+
+void SOMNet::SetResolutionSchedule(const std::vector<float> &vShares, const float &fFactor) {
+	assert(fFactor > 1.f);
+	for(unsigned int l = 0; l < vShares.size(); l++) {
+		assert(vShares[l] > 0.f);
+	}
+	m_vResolutionShares = vShares;
+	m_fResolutionFactor = fFactor;
+}
+
+std::vector<float> SOMNet::GetResolutionSchedule() const {
+	return m_vResolutionShares;
+}
 
-	// implementation of conscience mechanism
-	//float fConscience = m_fConscienceRate * (m_pBMNeuron->GetValue() - m_pBMNeuron->GetConscience() ); 	// standard implementation seems to have some problems
-	//m_pBMNeuron->AddConscience(fConscience); 																// standard implementation seems to have some problems
+void SOMNet::SetTrainingMode(const SOMTrainingFlag &fMode) {
+	assert(fMode == ANSOMOnline || fMode == ANSOMBatch);
+	m_fTrainingMode = fMode;
+}
+
+SOMTrainingFlag SOMNet::GetTrainingMode() const {
+	return m_fTrainingMode;
+}
+
+void SOMNet::SetLearningRate(const float &fVal) {
+	m_fLearningRate = fVal;
+	#pragma omp parallel for
+	for(int i = 0; i < static_cast<int>(m_lLayers.size() ); i++) {
+		( (SOMLayer*)GetLayer(i) )->SetLearningRate(fVal);
+	}
+}
+
+void SOMNet::SetSigma0(const float &fVal) {
+	assert(fVal > 1.f);
+	m_fSigma0 = fVal;
+}
+
+float SOMNet::GetSigma0() const {
+	return m_fSigma0;
+}
+
+float SOMNet::GetLearningRate() const {
+	return m_fLearningRate;
+}
+
+void SOMNet::FindBMNeuron(const float *pInput) {
+	assert(m_pIPLayer != NULL && m_pOPLayer != NULL);
 
 	if(m_fConscienceRate > 0.f) {
+		// with implementation of conscience mechanism (2nd term)
+		m_iBMNeuron = m_Codebook.FindBMU(pInput, &m_vDistances[0], &m_vConscience[0]);
+
+		//float fConscience = m_fConscienceRate * (m_pBMNeuron->GetValue() - m_pBMNeuron->GetConscience() ); 	// standard implementation seems to have some problems
+		//m_pBMNeuron->AddConscience(fConscience); 																// standard implementation seems to have some problems
 		#pragma omp parallel for
-		for(int i = 0; i < static_cast<int>(m_pOPLayer->GetNeurons().size() ); i++) {
-			SOMNeuron *pNeuron = (SOMNeuron*)m_pOPLayer->GetNeuron(i);
-			float fConscience = m_fConscienceRate * (pNeuron->GetValue() - pNeuron->GetConscience() );
-			pNeuron->SetConscience(fConscience);
+		for(int i = 0; i < static_cast<int>(m_vConscience.size() ); i++) {
+			m_vConscience[i] = m_fConscienceRate * (m_vDistances[i] - m_vConscience[i]);
 		}
+		// end of implementation of conscience mechanism
+	}
+	else if(m_bApproximate && m_Index.IsBuilt(m_Codebook) ) {
+		m_iBMNeuron = m_Index.FindBMU(m_Codebook, pInput);
+	}
+	else {
+		m_iBMNeuron = m_Codebook.FindBMU(pInput);
 	}
-	// end of implementation of conscience mechanism
 
+	m_pBMNeuron = (SOMNeuron*)m_pOPLayer->GetNeuron(m_iBMNeuron);
 	assert(m_pBMNeuron != NULL);
 }
 
@@ -78,12 +78,15 @@ void SOMNetGPU::Training(const unsigned int &iCycles) {
 		hvConscience[i] = m_pOPLayer->GetNeuron(i)->GetValue();
 	}
 	dvConscience = hvConscience;
+
+	// Upload the whole training set once
+	m_Workspace.SetInputs(*GetTrainingSet(), m_EdgeMat.getH() );
 	
 	std::cout<< "Process the SOM now" <<std::endl;
-	hostSOMTraining(dvConscience,
+	hostSOMTraining(m_Workspace,
+			dvConscience,
 			m_EdgeMat,
 			m_PosiMat,
-			*GetTrainingSet(),
 			iCycles,
 			m_fSigma0,
 			m_fLearningRate,
@@ -94,9 +97,12 @@ void SOMNetGPU::Training(const unsigned int &iCycles) {
 	// Write edge matrix back
 	std::cout<<"Copy device memory back .."<<std::endl;
 	m_pOPLayer->ImpEdgesIn(m_EdgeMat);
+	// MapBatch() has to import the new weights
+	m_Codebook.Clear();
 	
+	hvConscience = dvConscience;
 	for(unsigned int i = 0; i < iSize; i++) {
-		m_pOPLayer->GetNeuron(i)->SetValue(dvConscience[i]);
+		m_pOPLayer->GetNeuron(i)->SetValue(hvConscience[i]);
 	}
 	
 	std::cout<<".. Finished"<<std::endl;
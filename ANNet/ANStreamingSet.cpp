@@ -0,0 +1,306 @@
+/*
+ * StreamingSet.cpp
+ *
+ *  Created on: 17.10.2026
+ */
+
+#include <cstring>
+#include <climits>
+#include <cassert>
+#include <iostream>
+#include <algorithm>
+//own classes
+#include <math/ANRandom.h>
+#include <containers/ANStreamingSet.h>
+
+using namespace ANN;
+
+
+/*
+ * Seeks beyond 2 GB
+ */
+static bool SeekTo(FILE *pFile, const uint64_t &iPos) {
+#ifndef WIN32
+	return fseeko(pFile, static_cast<off_t>(iPos), SEEK_SET) == 0;
+#else
+	return _fseeki64(pFile, static_cast<__int64>(iPos), SEEK_SET) == 0;
+#endif /*WIN32*/
+}
+
+/*
+ * Fisher-Yates, called from the main thread only (rand() is not thread safe)
+ */
+static void Shuffle(std::vector<unsigned int> &vOrder) {
+	for(int i = static_cast<int>(vOrder.size() )-1; i > 0; i--) {
+		std::swap(vOrder[i], vOrder[RandInt(0, i)]);
+	}
+}
+
+StreamingSet::StreamingSet(const unsigned int &iChunkSize, const bool &bShuffle) {
+	assert(iChunkSize > 0);
+
+	m_pFile 		= NULL;
+	memset(&m_Header, 0, sizeof(RawSampleHeader) );
+
+	m_iChunkSize 	= iChunkSize;
+	m_bShuffle 		= bShuffle;
+
+	m_iCurrent 		= 0;
+	m_iNextChunk 	= 0;
+	m_iLoadChunk 	= 0;
+	m_bLoading 		= false;
+	m_bLoadError 	= false;
+	m_bThread 		= false;
+}
+
+StreamingSet::~StreamingSet() {
+	Close();
+}
+
+bool StreamingSet::Open(const std::string &sPath) {
+	Close();
+
+	m_pFile = fopen(sPath.c_str(), "rb");
+	if(m_pFile == NULL) {
+		return false;
+	}
+	if(	fread(&m_Header, sizeof(RawSampleHeader), 1, m_pFile) != 1 ||
+		memcmp(m_Header.m_cMagic, ANSMP_MAGIC, sizeof(m_Header.m_cMagic) ) != 0 ||
+		m_Header.m_iVersion != ANSMP_VERSION ||
+		m_Header.m_iInputSize == 0 )
+	{
+		std::cout<<"StreamingSet: "<<sPath<<" is no valid sample file"<<std::endl;
+		Close();
+		return false;
+	}
+	// the chunks get numbered with unsigned int
+	if(m_Header.m_iNrOfSamples / m_iChunkSize >= UINT_MAX) {
+		std::cout<<"StreamingSet: "<<sPath<<" has too many samples for chunks of "<<m_iChunkSize<<std::endl;
+		Close();
+		return false;
+	}
+	return true;
+}
+
+void StreamingSet::Close() {
+	WaitLoading();
+	m_bLoading = false;
+
+	if(m_pFile != NULL) {
+		fclose(m_pFile);
+		m_pFile = NULL;
+	}
+	memset(&m_Header, 0, sizeof(RawSampleHeader) );
+
+	for(unsigned int i = 0; i < 2; i++) {
+		m_Chunks[i].Clear();
+		m_vRows[i].clear();
+		m_vOrder[i].clear();
+	}
+	m_vChunkOrder.clear();
+}
+
+bool StreamingSet::IsOpen() const {
+	return m_pFile != NULL;
+}
+
+void StreamingSet::Load() {
+	TrainingSet &Chunk 					= m_Chunks[1-m_iCurrent];
+	std::vector<float> &vRows 			= m_vRows[1-m_iCurrent];
+	const std::vector<unsigned int> &vOrder = m_vOrder[1-m_iCurrent];
+
+	const unsigned int iInputSize 	= m_Header.m_iInputSize;
+	const unsigned int iOutputSize 	= m_Header.m_iOutputSize;
+	const unsigned int iRowSize 	= iInputSize + iOutputSize;
+	const unsigned int iCount 		= vOrder.size();
+
+	// one read for the whole chunk
+	uint64_t iFirst = static_cast<uint64_t>(m_iLoadChunk) * m_iChunkSize;
+	vRows.resize(static_cast<size_t>(iCount) * iRowSize);
+	if(	!SeekTo(m_pFile, sizeof(RawSampleHeader) + iFirst * iRowSize * sizeof(float) ) ||
+		fread(&vRows[0], sizeof(float) * iRowSize, iCount, m_pFile) != iCount )
+	{
+		m_bLoadError = true;
+		return;
+	}
+
+	// the buffers of the chunk keep their capacity, so no allocations after the first epoch
+	Chunk.Clear();
+	Chunk.Reserve(iCount, iInputSize, iOutputSize);
+	for(unsigned int i = 0; i < iCount; i++) {
+		const float *pRow = &vRows[static_cast<size_t>(vOrder[i]) * iRowSize];
+		Chunk.AddInput(pRow, iInputSize);
+		if(iOutputSize > 0) {
+			Chunk.AddOutput(pRow + iInputSize, iOutputSize);
+		}
+	}
+}
+
+void *StreamingSet::LoadThread(void *pSet) {
+	static_cast<StreamingSet*>(pSet)->Load();
+	return NULL;
+}
+
+void StreamingSet::StartLoading() {
+	assert(!m_bLoading);
+
+	if(m_iNextChunk >= m_vChunkOrder.size() ) {
+		return;
+	}
+	m_iLoadChunk = m_vChunkOrder[m_iNextChunk++];
+
+	uint64_t iFirst = static_cast<uint64_t>(m_iLoadChunk) * m_iChunkSize;
+	unsigned int iCount = static_cast<unsigned int>(std::min<uint64_t>(m_iChunkSize, m_Header.m_iNrOfSamples - iFirst) );
+
+	std::vector<unsigned int> &vOrder = m_vOrder[1-m_iCurrent];
+	vOrder.resize(iCount);
+	for(unsigned int i = 0; i < iCount; i++) {
+		vOrder[i] = i;
+	}
+	if(m_bShuffle) {
+		Shuffle(vOrder);
+	}
+
+	m_bLoading 		= true;
+	m_bLoadError 	= false;
+#ifndef WIN32
+	m_bThread = pthread_create(&m_Thread, NULL, &StreamingSet::LoadThread, this) == 0;
+	if(!m_bThread) {
+		Load();
+	}
+#else
+	Load();
+#endif /*WIN32*/
+}
+
+void StreamingSet::WaitLoading() {
+#ifndef WIN32
+	if(m_bThread) {
+		pthread_join(m_Thread, NULL);
+		m_bThread = false;
+	}
+#endif /*WIN32*/
+}
+
+void StreamingSet::Rewind() {
+	WaitLoading();
+	m_bLoading = false;
+	if(!IsOpen() ) {
+		return;
+	}
+
+	m_vChunkOrder.resize(GetNrOfChunks() );
+	for(unsigned int i = 0; i < m_vChunkOrder.size(); i++) {
+		m_vChunkOrder[i] = i;
+	}
+	if(m_bShuffle) {
+		Shuffle(m_vChunkOrder);
+	}
+	m_iNextChunk = 0;
+
+	StartLoading();
+}
+
+TrainingSet *StreamingSet::NextChunk() {
+	if(!m_bLoading) {
+		return NULL;
+	}
+	WaitLoading();
+	m_bLoading = false;
+	if(m_bLoadError) {
+		std::cout<<"StreamingSet: could not read chunk "<<m_iLoadChunk<<std::endl;
+		return NULL;
+	}
+
+	m_iCurrent = 1-m_iCurrent;
+	// prefetch while the caller works on the current chunk
+	StartLoading();
+	return &m_Chunks[m_iCurrent];
+}
+
+uint64_t StreamingSet::GetNrElements() const {
+	return m_Header.m_iNrOfSamples;
+}
+
+unsigned int StreamingSet::GetNrOfChunks() const {
+	return static_cast<unsigned int>( (m_Header.m_iNrOfSamples + m_iChunkSize-1) / m_iChunkSize);
+}
+
+unsigned int StreamingSet::GetChunkSize() const {
+	return m_iChunkSize;
+}
+
+unsigned int StreamingSet::GetInputSize() const {
+	return m_Header.m_iInputSize;
+}
+
+unsigned int StreamingSet::GetOutputSize() const {
+	return m_Header.m_iOutputSize;
+}
+
+void StreamingSet::SetShuffle(const bool &bShuffle) {
+	m_bShuffle = bShuffle;
+}
+
+bool StreamingSet::GetShuffle() const {
+	return m_bShuffle;
+}
+
+bool StreamingSet::ExpToFS(const std::string &sPath, const TrainingSet &Set, const bool &bAppend) {
+	const unsigned int iNrOfSamples = Set.GetNrInputs();
+	if(iNrOfSamples == 0 || (Set.GetNrOutputs() != 0 && Set.GetNrOutputs() != iNrOfSamples) ) {
+		std::cout<<"StreamingSet: the training set must have as many outputs as inputs or none"<<std::endl;
+		return false;
+	}
+	const unsigned int iInputSize 	= Set.GetInput(0).size();
+	const unsigned int iOutputSize 	= Set.GetNrOutputs() > 0 ? Set.GetOutput(0).size() : 0;
+	for(unsigned int i = 0; i < iNrOfSamples; i++) {
+		if(Set.GetInput(i).size() != iInputSize || (iOutputSize > 0 && Set.GetOutput(i).size() != iOutputSize) ) {
+			std::cout<<"StreamingSet: all samples must have the same size"<<std::endl;
+			return false;
+		}
+	}
+
+	RawSampleHeader Header;
+	FILE *fout = NULL;
+	if(bAppend && (fout = fopen(sPath.c_str(), "r+b") ) != NULL) {
+		if(	fread(&Header, sizeof(RawSampleHeader), 1, fout) != 1 ||
+			memcmp(Header.m_cMagic, ANSMP_MAGIC, sizeof(Header.m_cMagic) ) != 0 ||
+			Header.m_iInputSize != iInputSize || Header.m_iOutputSize != iOutputSize )
+		{
+			std::cout<<"StreamingSet: can not append to "<<sPath<<std::endl;
+			fclose(fout);
+			return false;
+		}
+		if(fseek(fout, 0, SEEK_END) != 0) {
+			fclose(fout);
+			return false;
+		}
+	}
+	else {
+		fout = fopen(sPath.c_str(), "wb");
+		if(fout == NULL) {
+			return false;
+		}
+		memset(&Header, 0, sizeof(RawSampleHeader) );
+		memcpy(Header.m_cMagic, ANSMP_MAGIC, sizeof(Header.m_cMagic) );
+		Header.m_iVersion 		= ANSMP_VERSION;
+		Header.m_iInputSize 	= iInputSize;
+		Header.m_iOutputSize 	= iOutputSize;
+		fwrite(&Header, sizeof(RawSampleHeader), 1, fout);
+	}
+
+	bool bRes = true;
+	for(unsigned int i = 0; i < iNrOfSamples && bRes; i++) {
+		bRes = fwrite(Set.GetInput(i).GetData(), sizeof(float), iInputSize, fout) == iInputSize;
+		if(iOutputSize > 0 && bRes) {
+			bRes = fwrite(Set.GetOutput(i).GetData(), sizeof(float), iOutputSize, fout) == iOutputSize;
+		}
+	}
+
+	// the number of samples is known at the end
+	Header.m_iNrOfSamples += iNrOfSamples;
+	bRes = bRes && fseek(fout, 0, SEEK_SET) == 0 && fwrite(&Header, sizeof(RawSampleHeader), 1, fout) == 1;
+	fclose(fout);
+	return bRes;
+}
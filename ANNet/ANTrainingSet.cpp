@@ -14,8 +14,8 @@ using namespace ANN;
 
 
 TrainingSet::TrainingSet() {
-	m_vInputList.resize(0);
-	m_vOutputList.resize(0);
+	m_vInputOffsets.push_back(0);
+	m_vOutputOffsets.push_back(0);
 }
 
 TrainingSet::~TrainingSet() {
@@ -23,73 +23,111 @@ TrainingSet::~TrainingSet() {
 }
 
 void TrainingSet::AddInput(const std::vector<float> &vIn) {
-	m_vInputList.push_back(vIn);
+	AddInput(vIn.empty() ? NULL : &vIn[0], vIn.size() );
 }
 
 void TrainingSet::AddOutput(const std::vector<float> &vOut) {
-	m_vOutputList.push_back(vOut);
+	AddOutput(vOut.empty() ? NULL : &vOut[0], vOut.size() );
 }
 
-void TrainingSet::AddInput(float *pIn, const unsigned int &iSize) {
-	std::vector<float> vIn;
-	for(unsigned int i = 0; i < iSize; i++)
-		vIn.push_back(pIn[i]);
-	AddInput(vIn);
+void TrainingSet::AddInput(const float *pIn, const unsigned int &iSize) {
+	m_vInputs.insert(m_vInputs.end(), pIn, pIn + iSize);
+	m_vInputOffsets.push_back(m_vInputs.size() );
 }
 
-void TrainingSet::AddOutput(float *pOut, const unsigned int &iSize) {
-	std::vector<float> vOut;
-	for(unsigned int i = 0; i < iSize; i++)
-		vOut.push_back(pOut[i]);
-	AddOutput(vOut);
+void TrainingSet::AddOutput(const float *pOut, const unsigned int &iSize) {
+	m_vOutputs.insert(m_vOutputs.end(), pOut, pOut + iSize);
+	m_vOutputOffsets.push_back(m_vOutputs.size() );
+}
+
+void TrainingSet::AddInputs(const float *pIn, const unsigned int &iSamples, const unsigned int &iSize) {
+	m_vInputs.insert(m_vInputs.end(), pIn, pIn + static_cast<size_t>(iSamples)*iSize);
+	m_vInputOffsets.reserve(m_vInputOffsets.size() + iSamples);
+	for(unsigned int i = 0; i < iSamples; i++) {
+		m_vInputOffsets.push_back(m_vInputOffsets.back() + iSize);
+	}
+}
+
+void TrainingSet::AddOutputs(const float *pOut, const unsigned int &iSamples, const unsigned int &iSize) {
+	m_vOutputs.insert(m_vOutputs.end(), pOut, pOut + static_cast<size_t>(iSamples)*iSize);
+	m_vOutputOffsets.reserve(m_vOutputOffsets.size() + iSamples);
+	for(unsigned int i = 0; i < iSamples; i++) {
+		m_vOutputOffsets.push_back(m_vOutputOffsets.back() + iSize);
+	}
+}
+
+void TrainingSet::Reserve(const unsigned int &iSamples, const unsigned int &iInputSize, const unsigned int &iOutputSize) {
+	m_vInputs.reserve(m_vInputs.size() + static_cast<size_t>(iSamples)*iInputSize);
+	m_vInputOffsets.reserve(m_vInputOffsets.size() + iSamples);
+	if(iOutputSize > 0) {
+		m_vOutputs.reserve(m_vOutputs.size() + static_cast<size_t>(iSamples)*iOutputSize);
+		m_vOutputOffsets.reserve(m_vOutputOffsets.size() + iSamples);
+	}
 }
 
 unsigned int TrainingSet::GetNrElements() const {
-	return m_vInputList.size();
+	return m_vInputOffsets.size()-1;
+}
+
+unsigned int TrainingSet::GetNrInputs() const {
+	return m_vInputOffsets.size()-1;
+}
+
+unsigned int TrainingSet::GetNrOutputs() const {
+	return m_vOutputOffsets.size()-1;
+}
+
+SampleView TrainingSet::GetInput(const unsigned int &iID) const {
+	assert(iID < GetNrInputs() );
+
+	size_t iBegin = m_vInputOffsets[iID];
+	return SampleView(GetInputBuffer() + iBegin, static_cast<unsigned int>(m_vInputOffsets[iID+1] - iBegin) );
 }
 
-std::vector<float> TrainingSet::GetInput(const unsigned int &iID) const {
-	assert(iID < GetNrElements() );
+SampleView TrainingSet::GetOutput(const unsigned int &iID) const {
+	assert(iID < GetNrOutputs() );
 
-	return m_vInputList.at(iID);
+	size_t iBegin = m_vOutputOffsets[iID];
+	return SampleView(GetOutputBuffer() + iBegin, static_cast<unsigned int>(m_vOutputOffsets[iID+1] - iBegin) );
 }
 
-std::vector<float> TrainingSet::GetOutput(const unsigned int &iID) const {
-	assert(iID < GetNrElements() );
+const float *TrainingSet::GetInputBuffer() const {
+	return m_vInputs.empty() ? NULL : &m_vInputs[0];
+}
 
-	return m_vOutputList.at(iID);
+const float *TrainingSet::GetOutputBuffer() const {
+	return m_vOutputs.empty() ? NULL : &m_vOutputs[0];
 }
 
 void TrainingSet::Clear() {
-	m_vInputList.clear();
-	m_vOutputList.clear();
+	m_vInputs.clear();
+	m_vOutputs.clear();
+	m_vInputOffsets.resize(1);
+	m_vOutputOffsets.resize(1);
 }
 
 void TrainingSet::ExpToFS(BZFILE* bz2out, int iBZ2Error) {
-	unsigned int iNrInpE = m_vInputList.size();
-	unsigned int iNrOutE = m_vOutputList.size();
+	unsigned int iNrInpE = GetNrInputs();
+	unsigned int iNrOutE = GetNrOutputs();
 
 	BZ2_bzWrite( &iBZ2Error, bz2out, &iNrInpE, sizeof(unsigned int) );
 	BZ2_bzWrite( &iBZ2Error, bz2out, &iNrOutE, sizeof(unsigned int) );
 
+	// same stream as writing value by value
 	for(unsigned int i = 0; i < iNrInpE; i++) {
-		std::vector<float> vInp = m_vInputList.at(i);
-		unsigned int iSizeI = vInp.size();
+		SampleView Inp = GetInput(i);
+		unsigned int iSizeI = Inp.size();
 		BZ2_bzWrite( &iBZ2Error, bz2out, &iSizeI, sizeof(unsigned int) );
-
-		for(unsigned int j = 0; j < iSizeI; j++) {
-			float fVal = vInp.at(j);
-			BZ2_bzWrite( &iBZ2Error, bz2out, &fVal, sizeof(float) );
+		if(iSizeI > 0) {
+			BZ2_bzWrite( &iBZ2Error, bz2out, const_cast<float*>(Inp.GetData() ), sizeof(float) * iSizeI );
 		}
 	}
 	for(unsigned int i = 0; i < iNrOutE; i++) {
-		std::vector<float> vOut = m_vOutputList.at(i);
-		unsigned int iSizeO = vOut.size();
+		SampleView Out = GetOutput(i);
+		unsigned int iSizeO = Out.size();
 		BZ2_bzWrite( &iBZ2Error, bz2out, &iSizeO, sizeof(unsigned int) );
-
-		for(unsigned int j = 0; j < iSizeO; j++) {
-			float fVal = vOut.at(j);
-			BZ2_bzWrite( &iBZ2Error, bz2out, &fVal, sizeof(float) );
+		if(iSizeO > 0) {
+			BZ2_bzWrite( &iBZ2Error, bz2out, const_cast<float*>(Out.GetData() ), sizeof(float) * iSizeO );
 		}
 	}
 }
@@ -103,29 +141,30 @@ void TrainingSet::ImpFromFS(BZFILE* bz2in, int iBZ2Error) {
 	BZ2_bzRead( &iBZ2Error, bz2in, &iNrInpE, sizeof(unsigned int) );
 	BZ2_bzRead( &iBZ2Error, bz2in, &iNrOutE, sizeof(unsigned int) );
 
+	m_vInputOffsets.reserve(iNrInpE+1);
+	m_vOutputOffsets.reserve(iNrOutE+1);
+
 	for(unsigned int i = 0; i < iNrInpE; i++) {
-		std::vector<float> vInp;
 		unsigned int iSizeI = 0;
 		BZ2_bzRead( &iBZ2Error, bz2in, &iSizeI, sizeof(unsigned int) );
 
-		for(unsigned int j = 0; j < iSizeI; j++) {
-			float fVal = 0.f;
-			BZ2_bzRead( &iBZ2Error, bz2in, &fVal, sizeof(float) );
-			vInp.push_back(fVal);
+		size_t iBegin = m_vInputs.size();
+		m_vInputs.resize(iBegin + iSizeI);
+		if(iSizeI > 0) {
+			BZ2_bzRead( &iBZ2Error, bz2in, &m_vInputs[iBegin], sizeof(float) * iSizeI );
 		}
-		m_vInputList.push_back(vInp);
+		m_vInputOffsets.push_back(m_vInputs.size() );
 	}
 	for(unsigned int i = 0; i < iNrOutE; i++) {
-		std::vector<float> vOut;
 		unsigned int iSizeO = 0;
 		BZ2_bzRead( &iBZ2Error, bz2in, &iSizeO, sizeof(unsigned int) );
 
-		for(unsigned int j = 0; j < iSizeO; j++) {
-			float fVal = 0.f;
-			BZ2_bzRead( &iBZ2Error, bz2in, &fVal, sizeof(float) );
-			vOut.push_back(fVal);
+		size_t iBegin = m_vOutputs.size();
+		m_vOutputs.resize(iBegin + iSizeO);
+		if(iSizeO > 0) {
+			BZ2_bzRead( &iBZ2Error, bz2in, &m_vOutputs[iBegin], sizeof(float) * iSizeO );
 		}
-		m_vOutputList.push_back(vOut);
+		m_vOutputOffsets.push_back(m_vOutputs.size() );
 	}
 
 }
@@ -0,0 +1,241 @@
+/*
+#-------------------------------------------------------------------------------
+# Copyright (c) 2012 Daniel <dgrat> Frenzel.
+# All rights reserved. This program and the accompanying materials
+# are made available under the terms of the GNU Lesser Public License v2.1
+# which accompanies this distribution, and is available at
+# http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+#
+# Contributors:
+#     Daniel <dgrat> Frenzel - initial API and implementation
+#-------------------------------------------------------------------------------
+*/
+
+#ifndef ANBPENGINE_H_
+#define ANBPENGINE_H_
+
+#include <vector>
+
+namespace ANN {
+
+class AbsLayer;
+class BPLayer;
+class TransfFunction;
+class CPUKernels;
+class NetFile;
+
+
+/**
+ * \brief Dense representation of one layer of a compiled back propagation network.
+ *
+ * The incoming edges of the layer are stored as a row-major matrix:
+ * row j holds the weights of all edges directing from the previous layer to neuron j.
+ * The input layer (index 0) only holds values and error deltas.
+ * A layer of a mapped file (BPEngine::Map()) points to the weights in the mapping, the vectors of the weights stay empty then.
+ */
+struct BPDenseLayer {
+	unsigned int m_iInputs;					// nr. of neurons in the previous layer (width of the matrix)
+	unsigned int m_iNeurons;				// nr. of neurons in this layer (height of the matrix)
+
+	std::vector<float> m_vWeights;			// m_iNeurons * m_iInputs
+	std::vector<float> m_vMomentums;		// same layout like m_vWeights
+	std::vector<float> m_vAdapt;			// 1.f if the edge exists and is adaptable, otherwise 0.f; empty if all edges are adaptable
+
+	std::vector<float> m_vBias;				// edges from the bias neuron of the previous layer
+	std::vector<float> m_vBiasMomentums;
+	std::vector<float> m_vBiasAdapt;		// 1.f if the bias edge exists and is adaptable, otherwise 0.f
+	const float *m_pWeights;				// weights and bias of a mapped file, NULL if m_vWeights and m_vBias hold them
+	const float *m_pBias;
+	bool m_bBiasIsTheta;					// bias edges were registered with AbsNeuron::SetBiasEdge() (nets created from a ConTable)
+	float m_fBiasValue;						// value of the bias neuron of the previous layer
+
+	std::vector<float> m_vValues;			// values of the neurons
+	std::vector<float> m_vDeltas;			// error deltas of the neurons
+
+	std::vector<float> m_vBatchValues;		// values of the neurons for each sample of a mini-batch (samples * m_iNeurons)
+	std::vector<float> m_vBatchDeltas;		// error deltas of the neurons for each sample of a mini-batch
+	std::vector<float> m_vGradients;		// gradient of the weights accumulated over a mini-batch, same layout like m_vWeights
+	std::vector<float> m_vBiasGradients;
+
+	const TransfFunction *m_pFunction;		// transfer function of the neurons in this layer
+
+	/* learning parameters of the neurons in the previous layer (they own the outgoing edges) */
+	float m_fLearningRate;
+	float m_fWeightDecay;
+	float m_fMomentum;
+	/* learning parameters of the bias neuron in the previous layer */
+	float m_fBiasLearningRate;
+	float m_fBiasWeightDecay;
+	float m_fBiasMomentum;
+
+	const float *GetWeights() const {
+		return m_pWeights != NULL ? m_pWeights : &m_vWeights[0];
+	}
+	const float *GetBias() const {
+		return m_pBias != NULL ? m_pBias : &m_vBias[0];
+	}
+};
+
+/**
+ * \brief Compiled execution engine of a back propagation network.
+ *
+ * Lowers the layer/edge graph of a BPNet into contiguous weight matrices, bias vectors and activation buffers.
+ * Forward and backward propagation then run as dense matrix-vector operations.
+ * The Edge and neuron objects are only touched again when calling Sync().
+ *
+ * Supported are feed forward nets where all incoming edges of a layer come from the layer before (including its bias neuron).
+ * The semantics of BPNeuron::CalcValue() and BPNeuron::AdaptEdges() are preserved.
+ */
+class BPEngine {
+private:
+	std::vector<BPDenseLayer> m_vLayers;
+	const NetFile *m_pFile;					// file the weights are mapped from, NULL if the engine owns them
+
+	/*
+	 * Temporary buffer for the back propagated error of one layer.
+	 */
+	std::vector<float> m_vErrors;
+
+	/*
+	 * Mini-batch buffers: back propagated errors (samples * widest layer) and desired output
+	 */
+	unsigned int m_iBatchSize;
+	std::vector<float> m_vBatchErrors;
+	std::vector<float> m_vBatchTargets;
+
+	/*
+	 * One buffer per thread for PredictBatch(), holding the values of two layers of a block of samples
+	 */
+	std::vector<std::vector<float> > m_vWorkspaces;
+	unsigned int m_iMaxWidth;
+
+	/*
+	 * Vectorized kernels for the processor, chosen at runtime.
+	 */
+	const CPUKernels *m_pKernels;
+
+	bool CompileLayer(const BPLayer *pPrevLayer, const BPLayer *pLayer, BPDenseLayer &Dense);
+
+	/*
+	 * Calculates the neurons iBegin to iEnd of Layer for iSamples samples.
+	 * pInput has iSamples rows of the values of the previous layer,
+	 * pOutput has iSamples rows with a stride of the size of Layer.
+	 */
+	void PropagateLayer(const BPDenseLayer &Layer, const float *pInput, float *pOutput,
+			const unsigned int &iSamples, const unsigned int &iBegin, const unsigned int &iEnd) const;
+
+public:
+	BPEngine();
+	virtual ~BPEngine();
+
+	/**
+	 * Lowers the graph into dense matrices.
+	 * @param vLayers Layers of the net. First is the input, last the output layer.
+	 * @return Returns false if the topology of the net is not supported. The engine is empty then.
+	 */
+	bool Compile(const std::vector<AbsLayer*> &vLayers);
+	/**
+	 * Points the layers to the dense blocks of a raw network file instead of copying the weights.
+	 * The engine can propagate only, it must not be trained or synchronized with edges.
+	 * @param File Opened file. Must stay open as long as the engine uses it.
+	 * @param vLayers Layers of the net, created from File. They give the sizes, the transfer functions and the values of the bias neurons.
+	 * @return Returns false if the file has no dense blocks or does not match the layers. The engine is empty then.
+	 */
+	bool Map(const NetFile &File, const std::vector<AbsLayer*> &vLayers);
+	/**
+	 * Writes weights, momentums, values and error deltas back to the edges and neurons of the graph.
+	 * @param vLayers Layers of the net. Must be the same layers the engine was compiled from.
+	 */
+	void Sync(const std::vector<AbsLayer*> &vLayers) const;
+	/**
+	 * Deletes all matrices and buffers.
+	 */
+	void Clear();
+
+	/**
+	 * @return Returns true if no net is compiled.
+	 */
+	bool IsEmpty() const;
+	/**
+	 * @return Returns the file the weights are mapped from (see Map()), NULL if the engine owns its weights.
+	 */
+	const NetFile *GetFile() const;
+
+	/**
+	 * @return Number of layers (including the input layer).
+	 */
+	unsigned int GetNrLayers() const;
+	/**
+	 * @return Returns the dense layer at index iLayerID.
+	 */
+	BPDenseLayer &GetLayer(const unsigned int &iLayerID);
+	const BPDenseLayer &GetLayer(const unsigned int &iLayerID) const;
+
+	/**
+	 * Propagates the values of the input layer buffer to the output layer buffer.
+	 */
+	void PropagateFW();
+	/**
+	 * Propagates the error deltas of the output layer buffer back and adapts the weights.
+	 */
+	void PropagateBW();
+
+	/**
+	 * Allocates the buffers for mini-batches.
+	 * @param iSize Number of samples propagated together.
+	 */
+	void SetBatchSize(const unsigned int &iSize);
+	/**
+	 * @return Returns the number of samples of a mini-batch.
+	 */
+	unsigned int GetBatchSize() const;
+	/**
+	 * @return Returns a pointer to the input values of sample iSample of the mini-batch (size of the input layer).
+	 */
+	float *GetBatchInput(const unsigned int &iSample);
+	/**
+	 * @return Returns a pointer to the desired output of sample iSample of the mini-batch (size of the output layer).
+	 */
+	float *GetBatchTarget(const unsigned int &iSample);
+	/**
+	 * Propagates all samples of the mini-batch as matrix-matrix products.
+	 */
+	void PropagateBatchFW();
+	/**
+	 * Back propagates the errors of all samples of the mini-batch.
+	 * The gradients get averaged over the batch, the weights are adapted once.
+	 * @return Returns the summed error of the mini-batch like AbsNet::SetOutput().
+	 */
+	float PropagateBatchBW();
+
+	/**
+	 * Propagates many samples without touching the buffers used for training.
+	 * Blocks of samples get distributed over the threads.
+	 * The workspaces are allocated at the first call only.
+	 * @param pInput Contiguous input, iSamples * (size of the input layer).
+	 * @param pOutput Contiguous output, iSamples * (size of the output layer).
+	 * @param iSamples Number of samples.
+	 */
+	void PredictBatch(const float *pInput, float *pOutput, const unsigned int &iSamples);
+
+	/**
+	 * Sets the learning rate of all neurons (not bias neurons, like BPLayer::SetLearningRate()).
+	 */
+	void SetLearningRate(const float &fVal);
+	/**
+	 * Sets the momentum of all neurons (not bias neurons, like BPLayer::SetMomentum()).
+	 */
+	void SetMomentum(const float &fVal);
+	/**
+	 * Sets the weight decay of all neurons (not bias neurons, like BPLayer::SetWeightDecay()).
+	 */
+	void SetWeightDecay(const float &fVal);
+	/**
+	 * Sets the transfer function of all layers.
+	 */
+	void SetTransfFunction(const TransfFunction *pFunction);
+};
+
+}
+
+#endif /* ANBPENGINE_H_ */
@@ -117,16 +117,18 @@ public:
 	 * The first index of this array is equal to the ID of the neuron in the actual (this) layer.
 	 * The second ID is equal to the ID of neurons in the other (pDestLayer).
 	 * @param bAllowAdapt allows the change of the weights between both layers.
+	 * @param pArena takes the edges from this arena (e.g. AbsNet::GetEdgeArena()). If NULL, every edge is allocated on its own.
 	 */
-	void ConnectLayer(AbsLayer *pDestLayer, std::vector<std::vector<int> > Connections, const bool bAllowAdapt = true); // TODO use connections table
+	void ConnectLayer(AbsLayer *pDestLayer, std::vector<std::vector<int> > Connections, const bool bAllowAdapt = true, EdgeArena *pArena = NULL); // TODO use connections table
 	/**
 	 * Connects this layer with another one.
 	 * Each neuron of this layer with each of the neurons in "pDestLayer".
 	 * Neurons in "pDestLayer" get
 	 * @param pDestLayer pointer to layer to connect with.
 	 * @param bAllowAdapt allows the change of the weights between both layers.
+	 * @param pArena takes the edges from this arena in one block (e.g. AbsNet::GetEdgeArena()). If NULL, every edge is allocated on its own.
 	 */
-	void ConnectLayer(AbsLayer *pDestLayer, const bool &bAllowAdapt = true);
+	void ConnectLayer(AbsLayer *pDestLayer, const bool &bAllowAdapt = true, EdgeArena *pArena = NULL);
 
 	/**
 	 * Sets learning rate scalar of the network.
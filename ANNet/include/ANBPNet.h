@@ -22,6 +22,7 @@
 namespace ANN {
 
 class BPLayer;
+class BPEngine;
 
 /**
  * \brief Implementation of a back propagation network.
@@ -30,7 +31,21 @@ class BPLayer;
  */
 class BPNet : public AbsNet
 {
+private:
+	/*
+	 * The engine is owned by exactly one net, copies would delete it twice.
+	 * Use BPNet(BPNet*) which copies the graph only.
+	 */
+	BPNet(const BPNet &);
+	BPNet &operator = (const BPNet &);
+
 protected:
+	/*
+	 * Dense matrix representation of the net, NULL if the net is not compiled.
+	 */
+	BPEngine *m_pEngine;
+	bool m_bTmpEngine;		// engine got compiled for the current TrainFromData() only
+
 	/**
 	 * Adds a layer to the network.
 	 * @param iSize Number of neurons of the layer.
@@ -38,6 +53,13 @@ protected:
 	 */
 	virtual void AddLayer(const unsigned int &iSize, const LayerTypeFlag &flType);
 
+	/**
+	 * Propagates the mini-batch as matrix-matrix products through the compiled net.
+	 * The net gets compiled temporarily if necessary.
+	 * Falls back to AbsNet::TrainBatch() for online learning or unsupported topologies.
+	 */
+	virtual float TrainBatch(const unsigned int &iStart, const unsigned int &iSize);
+
 public:
 	/**
 	 * Standard constructor
@@ -45,6 +67,7 @@ public:
 	BPNet();
 	/**
 	 * Copy constructor for copying the complete network:
+	 * A compiled net gets synchronized first, the copy itself starts in graph mode.
 	 * @param pNet
 	 */
 	BPNet(ANN::BPNet *pNet);
@@ -62,6 +85,55 @@ public:
 	 */
 	virtual void AddLayer(BPLayer *pLayer);
 
+	/**
+	 * Lowers the edges of the net into contiguous weight matrices.
+	 * PropagateFW() and PropagateBW() will then run as dense matrix operations.
+	 * The edge objects get only updated by SyncEdges() or Decompile().
+	 * Adding layers or creating a new net drops the compiled representation.
+	 * @return Returns false if the topology is not supported (e.g. edges skipping layers). The net stays in graph mode then.
+	 */
+	bool Compile();
+	/**
+	 * Creates the net from a raw network file (AbsNet::ExpToFS() with ANFormatRaw) and runs it straight from the dense blocks of the file.
+	 * The weights are not copied: only the layers and neurons get created, the net has no edges while it is mapped.
+	 * PropagateFW() and PredictBatch() read the weights from the mapping.
+	 * Training, SyncEdges() and Decompile() create the edges from the file and switch to graph mode.
+	 * @param File Opened file. Must stay open as long as the net is mapped.
+	 * @return Returns false if the file has no dense blocks. The net gets imported in graph mode then (like ImpFromFS()).
+	 */
+	bool Compile(const NetFile &File);
+	/**
+	 * Writes the compiled weights back to the edges and switches back to graph mode.
+	 * A mapped net gets its edges from the file.
+	 */
+	void Decompile();
+	/**
+	 * @return Returns true if the net runs in compiled mode (also if it is mapped).
+	 */
+	bool IsCompiled() const;
+	/**
+	 * @return Returns true if the net runs on the weights of a mapped file (see Compile(const NetFile &)).
+	 */
+	bool IsMapped() const;
+	/**
+	 * Writes weights, momentums, values and error deltas of the compiled net back to the edges and neurons.
+	 * A mapped net has no edges to write to, it gets decompiled instead.
+	 * Does nothing if the net is not compiled.
+	 */
+	void SyncEdges();
+
+	/**
+	 * Propagates many samples and writes the values of the output layer into a buffer owned by the caller.
+	 * The samples get propagated in blocks as matrix-matrix products in parallel. The neurons of the net are not touched.
+	 * A net in graph mode gets compiled for the call and switches back to graph mode afterwards,
+	 * so call Compile() first if the net predicts many batches (no heap allocations after the first call then).
+	 * Only unsupported topologies propagate the samples one by one (see AbsNet::PredictBatch()).
+	 * @param pInput Contiguous input, iSamples * (size of the input layer).
+	 * @param pOutput Contiguous output, iSamples * (size of the output layer).
+	 * @param iSamples Number of samples.
+	 */
+	virtual void PredictBatch(const float *pInput, float *pOutput, const unsigned int &iSamples);
+
 	/**
 	 * Cycles the input from m_pTrainingData
 	 * Checks total error of the output returned from SetExpectedOutputData()
@@ -138,6 +210,23 @@ public:
 	 */
 	BPNet *GetSubNet(const unsigned int &iStartID, const unsigned int &iStopID);
 
+	/**
+	 * Sets the transfer function of all neurons of the net.
+	 * @param pFunction Pointer to the transfer function.
+	 */
+	virtual void SetTransfFunction(const TransfFunction *pFunction);
+
+	/**
+	 * Deletes all layers of the net.
+	 */
+	virtual void EraseAll();
+
+	/**
+	 * Saves the net to the filesystem. A compiled net gets synchronized before.
+	 * @param path Path of the file.
+	 */
+	virtual void ExpToFS(std::string path, const FileFormatFlag &fFormat = ANFormatBZ2);
+
 	/**
 	 * Sets learning rate scalar of the network.
 	 * @param fVal New value of the learning rate. Recommended: 0.005f - 1.0f
@@ -66,6 +66,19 @@ public:
 	 */
 	void SetMomentum 		(const float &fVal);
 
+	/**
+	 * @return Returns the scalar of the learning rate.
+	 */
+	float GetLearningRate() const;
+	/**
+	 * @return Returns the scalar of the weight decay.
+	 */
+	float GetWeightDecay() const;
+	/**
+	 * @return Returns the scalar of the momentum.
+	 */
+	float GetMomentum() const;
+
 	/**
 	 * Defines how to calculate the values of each neuron.
 	 */
@@ -0,0 +1,176 @@
+/*
+#-------------------------------------------------------------------------------
+# Copyright (c) 2012 Daniel <dgrat> Frenzel.
+# All rights reserved. This program and the accompanying materials
+# are made available under the terms of the GNU Lesser Public License v2.1
+# which accompanies this distribution, and is available at
+# http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+#
+# Contributors:
+#     Daniel <dgrat> Frenzel - initial API and implementation
+#-------------------------------------------------------------------------------
+*/
+
+#ifndef ANHFENGINE_H_
+#define ANHFENGINE_H_
+
+#include <vector>
+#include <stdint.h>
+
+namespace ANN {
+
+class CPUKernels;
+
+
+enum {
+	ANHFSynchronous 	= 1 << 0,	// all neurons get updated at once from the previous state
+	ANHFAsynchronous 	= 1 << 1	// one neuron after another in random order, each one sees the changes before
+};
+typedef uint32_t HFUpdateFlag;
+
+/**
+ * \brief Bit-packed representation of a hopfield network with bipolar states.
+ *
+ * States and patterns are bitsets (bit set: +1, bit not set: -1), 64 neurons per word.
+ * The weight matrix is not stored. For the hebbian weights \f$ w_{ij} = \sum_{\mu} \xi_{\mu i} \xi_{\mu j} \f$ (i != j)
+ * the local field of a neuron can be calculated from the overlaps of the state with the patterns:
+ * \f$
+ * h_i = \sum_{\mu} \xi_{\mu i} m_{\mu} - P s_i, \quad m_{\mu} = \sum_{j} \xi_{\mu j} s_j = N - 2 \cdot popcount(\xi_{\mu} \oplus s)
+ * \f$
+ * The overlaps get calculated with popcount, the fields with vectorized masked sums (see CPUKernels).
+ * The patterns are stored twice: pattern-wise for the overlaps and neuron-wise for the fields.
+ * So N neurons and P patterns take 2*N*P bits, instead of N*N weights.
+ */
+class HFEngine {
+private:
+	unsigned int m_iNeurons;
+	unsigned int m_iWords;				// 64 bit words of a state (or pattern)
+	unsigned int m_iPatterns;
+	unsigned int m_iCapacity;			// nr. of patterns the neuron-wise bitsets have room for (multiple of 64)
+
+	std::vector<uint64_t> m_vPatterns;	// pattern-wise: m_iPatterns * m_iWords
+	std::vector<uint64_t> m_vNeurons;	// neuron-wise: bit mu of neuron i, m_iNeurons * m_iCapacity/64
+
+	const CPUKernels *m_pKernels;
+
+	void Reserve(const unsigned int &iPatterns);
+
+public:
+	HFEngine();
+	virtual ~HFEngine();
+
+	/**
+	 * Removes all patterns and sets the number of neurons.
+	 * @param iNeurons Number of neurons.
+	 */
+	void Resize(const unsigned int &iNeurons);
+	/**
+	 * Removes all patterns.
+	 */
+	void Clear();
+
+	/**
+	 * Adds a pattern, which is the same like adding its outer product to the weights.
+	 * @param pPattern GetNrOfNeurons() values, values >= 0 are stored as +1, the others as -1.
+	 */
+	void AddPattern(const float *pPattern);
+	/**
+	 * Adds several patterns at once.
+	 * @param pPatterns iPatterns patterns one after another, each with GetNrOfNeurons() values.
+	 * @param iPatterns Number of patterns.
+	 */
+	void AddPatterns(const float *pPatterns, const unsigned int &iPatterns);
+	/**
+	 * Removes a pattern, which is the same like subtracting its outer product from the weights.
+	 * The last pattern takes its index.
+	 * @param iPattern Index of the pattern.
+	 */
+	void RemovePattern(const unsigned int &iPattern);
+	/**
+	 * @param pPattern GetNrOfNeurons() values, packed like with AddPattern().
+	 * @return Returns the index of the stored pattern which is equal to pPattern, or -1 if there is none.
+	 */
+	int FindPattern(const float *pPattern) const;
+
+	unsigned int GetNrOfNeurons() const;
+	unsigned int GetNrOfPatterns() const;
+	/**
+	 * @return Returns the number of 64 bit words of a state.
+	 */
+	unsigned int GetNrOfWords() const;
+	/**
+	 * @return Returns the bits of the pattern iPattern (GetNrOfWords() words).
+	 */
+	const uint64_t *GetPattern(const unsigned int &iPattern) const;
+
+	/**
+	 * Packs bipolar values into a bitset. Unused bits of the last word are cleared.
+	 * @param pValues iSize values, values >= 0 give a set bit.
+	 * @param pBits Receives (iSize+63)/64 words.
+	 */
+	static void Pack(const float *pValues, const unsigned int &iSize, uint64_t *pBits);
+	/**
+	 * Unpacks a bitset into bipolar values (+1 for a set bit, otherwise -1).
+	 */
+	static void Unpack(const uint64_t *pBits, const unsigned int &iSize, float *pValues);
+
+	/**
+	 * Calculates the overlaps of a state with all patterns.
+	 * @param pState State with GetNrOfWords() words.
+	 * @param pOverlaps Receives GetNrOfPatterns() overlaps.
+	 * @return Returns the sum of the overlaps.
+	 */
+	int64_t CalcOverlaps(const uint64_t *pState, int32_t *pOverlaps) const;
+	/**
+	 * Calculates the local field of a neuron.
+	 * @param iNeuron Index of the neuron.
+	 * @param bState Current state of the neuron (true: +1).
+	 * @param pOverlaps Overlaps of the current state, see CalcOverlaps().
+	 * @param iSum Sum of the overlaps.
+	 */
+	int64_t CalcField(const unsigned int &iNeuron, const bool &bState, const int32_t *pOverlaps, const int64_t &iSum) const;
+
+	/**
+	 * Updates all neurons at once (synchronous update), distributed over the threads.
+	 * A neuron becomes +1 if its local field is >= 0 (like fcn_binary).
+	 * @param pState State with GetNrOfWords() words, gets replaced by the new state.
+	 * @param pOverlaps Buffer with room for GetNrOfPatterns() values.
+	 * @return Returns the number of neurons which changed their state.
+	 */
+	unsigned int Sweep(uint64_t *pState, int32_t *pOverlaps) const;
+
+	/**
+	 * Updates the overlaps after a neuron changed its state.
+	 * @param iNeuron Index of the neuron.
+	 * @param bState New state of the neuron (true: +1).
+	 * @param pOverlaps Overlaps to update, see CalcOverlaps().
+	 * @param iSum Sum of the overlaps to update.
+	 */
+	void UpdateOverlaps(const unsigned int &iNeuron, const bool &bState, int32_t *pOverlaps, int64_t &iSum) const;
+	/**
+	 * Calculates the energy of a state from its overlaps:
+	 * \f$ E = -\frac{1}{2} \sum_{i \neq j} w_{ij} s_i s_j = -\frac{1}{2} (\sum_{\mu} m_{\mu}^2 - P N) \f$
+	 * @param pOverlaps Overlaps of the state, see CalcOverlaps().
+	 */
+	int64_t CalcEnergy(const int32_t *pOverlaps) const;
+
+	/**
+	 * Updates the state until no neuron changes any more (fixed point) or iMaxIterations sweeps are done.
+	 * With ANHFSynchronous each sweep is a Sweep(), it stops as well if the state alternates between two states.
+	 * With ANHFAsynchronous the neurons get updated one after another
+	 * in a new random order each sweep; only the overlaps get updated after a flip, and with them the energy.
+	 * @param pState State with GetNrOfWords() words, gets replaced by the final state.
+	 * @param pOverlaps Buffer with room for GetNrOfPatterns() values.
+	 * @param iMaxIterations Maximum number of sweeps.
+	 * @param flMode ANHFSynchronous or ANHFAsynchronous.
+	 * @param iSeed State of the random generator for the update order (see RandXorShift()), gets advanced.
+	 * @param iEnergy Receives the energy of the final state.
+	 * @return Returns the number of sweeps, including the last one without changes.
+	 */
+	unsigned int Recall(uint64_t *pState, int32_t *pOverlaps, const unsigned int &iMaxIterations,
+						const HFUpdateFlag &flMode, uint32_t &iSeed, int64_t &iEnergy) const;
+};
+
+}
+
+#endif /* ANHFENGINE_H_ */
@@ -62,8 +62,9 @@ public:
 	 * A hopfield net only consists of one layer.
 	 * This functions connects each neuron of this layer with all the other ones.
 	 * @param bAllowAdapt allows the change of the weights between both layers.
+	 * @param pArena takes the edges from this arena in one block (e.g. AbsNet::GetEdgeArena()). If NULL, every edge is allocated on its own.
 	 */
-	void ConnectLayer(bool bAllowAdapt = true);
+	void ConnectLayer(bool bAllowAdapt = true, EdgeArena *pArena = NULL);
 
 	/**
 	 * A hopfield net only consists of one layer.
@@ -71,9 +72,17 @@ public:
 	 * and sets the connection to a value specified in pEdges.
 	 * @param pEdges is a pointer to a one dimensional array saving the values of the connections between all neurons.
 	 * @param bAllowAdapt allows the change of the weights between both layers.
+	 * @param pArena takes the edges from this arena in one block. If NULL, every edge is allocated on its own.
 	 */
-	void ConnectLayer(const float *pEdges, bool bAllowAdapt = true);
+	void ConnectLayer(const float *pEdges, bool bAllowAdapt = true, EdgeArena *pArena = NULL);
 
+	/**
+	 * Sets the values of the existing connections to the values specified in pEdges, without reallocating edges.
+	 * The edge from neuron j to neuron i gets the value pEdges[i*N+j] (like with ConnectLayer()).
+	 * @param pEdges is a pointer to a one dimensional array saving the values of the connections between all neurons.
+	 * @return Returns false if the layer is not fully connected. Then nothing was changed.
+	 */
+	bool SetWeights(const float *pEdges);
 	/**
 	 * This function is running through all connections between all neurons and sets them to zero.
 	 */
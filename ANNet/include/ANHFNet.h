@@ -16,13 +16,14 @@
 
 #include <vector>
 #include <string>
+#include <stdint.h>
 
 #include <basic/ANAbsNet.h>
 #include <basic/ANAbsLayer.h>
+#include <ANHFEngine.h>
 
 namespace ANN {
 
-
 /**
  * \brief Implementation of a hopfield network.
  */
@@ -31,7 +32,24 @@ private:
 	unsigned int m_iWidth;
 	unsigned int m_iHeight;
 
-	void CalculateMatrix();
+	HFEngine *m_pEngine;
+	std::vector<uint64_t> m_vState;		// packed neuron values for the compiled mode
+	std::vector<int32_t> m_vOverlaps;
+
+	std::vector<float> m_vWeights;		// dense weight matrix for Recall(), row i holds the incoming weights of neuron i
+
+	std::vector<float> m_vPatterns;		// graph mode: the patterns the weights are made of, one after another
+	bool m_bHebbian;					// true if the edges are the hebbian weights of m_vPatterns
+	std::vector<float> m_vStored;		// patterns of StorePattern(), PropagateBW() adds them to the training set
+
+	void CalculateMatrix(const float *pPatterns, const unsigned int &iPatterns);
+	void AddOuterProduct(const float *pPattern, const float &fScale);
+	bool CanCompile();
+	void RecallBatchSync(float *pStates, const unsigned int &iProbes, unsigned int *pIterations, const unsigned int &iMaxIterations, float *pEnergies);
+
+	// m_pEngine is owned by exactly one net, copies would delete it twice
+	HFNet(const HFNet &);
+	HFNet &operator = (const HFNet &);
 
 protected:
 	/**
@@ -60,6 +78,97 @@ public:
 	 */
 	void Resize(const unsigned int &iW, const unsigned int &iH);
 
+	/**
+	 * Switches to the bit-packed representation (HFEngine), meant for nets with many neurons.
+	 * The weights are represented by the stored patterns instead of edges:
+	 * The patterns the weights were calculated from (PropagateBW(), StorePattern()) get packed and all edges are released.
+	 * A net without weights (all zero) gets the patterns of the training set, if there is one.
+	 * Call it before Resize(), so the edges of a big net never get allocated.
+	 * States and patterns are bipolar, values >= 0 are taken as +1, the others as -1.
+	 * @return Returns false if the weights can not be represented by bipolar patterns,
+	 * e.g. after ImpFromFS() or if edges were changed directly. The net stays in graph mode then.
+	 */
+	bool Compile();
+	/**
+	 * Connects the neurons again and calculates the weights of the edges from the stored patterns.
+	 * Switches back to graph mode.
+	 */
+	void Decompile();
+	/**
+	 * @return Returns true if the net runs in compiled mode.
+	 */
+	bool IsCompiled() const;
+
+	/**
+	 * Stores a single pattern as rank-1 update of the weights (hebbian rule): \f$ w_{ij} = w_{ij} + x_i x_j, i \neq j \f$
+	 * The edges only get changed, not reallocated. It takes O(N^2), distributed over the threads.
+	 * In compiled mode the pattern just gets packed.
+	 * The pattern is kept, so PropagateBW() and Compile() take it along with the patterns of the training set,
+	 * until it gets forgotten or the net gets resized or imported.
+	 * @param pPattern One value per neuron.
+	 */
+	void StorePattern(const float *pPattern);
+	/**
+	 * Forgets a pattern stored before, by subtracting its outer product from the weights (see StorePattern()).
+	 * In compiled mode the stored pattern which is equal to pPattern gets removed.
+	 * Patterns are equal if all values have the same sign (like in the compiled mode).
+	 * A pattern of the training set is forgotten only until the next PropagateBW().
+	 * @param pPattern One value per neuron.
+	 * @return Returns false if in compiled mode no stored pattern is equal to pPattern.
+	 */
+	bool ForgetPattern(const float *pPattern);
+
+	/**
+	 * Updates the neurons until none of them changes its state any more (fixed point) or iMaxIterations sweeps are done.
+	 * With ANHFAsynchronous the neurons get updated one after another in a new random order each sweep.
+	 * The local fields of all neurons are kept up to date, so a flip costs O(N) and a sweep without flips O(N).
+	 * With ANHFSynchronous all neurons get updated at once from the state before the sweep.
+	 * Then the state can also end in a cycle of two states, which stops the recall too.
+	 * The energy \f$ E = -\frac{1}{2} \sum_{i,j} w_{ij} s_i s_j \f$ is tracked along (the weight matrix has to be symmetric).
+	 * In graph mode the weights are taken from the matrix of the last PropagateBW() (or imported by the first call), see UpdateMatrix().
+	 * @param iMaxIterations Maximum number of sweeps.
+	 * @param flMode ANHFAsynchronous or ANHFSynchronous.
+	 * @param pEnergy If not NULL, receives the energy of the final state.
+	 * @return Returns the number of sweeps, including the last one without changes.
+	 */
+	unsigned int Recall(const unsigned int &iMaxIterations = 100, const HFUpdateFlag &flMode = ANHFAsynchronous, float *pEnergy = NULL);
+
+	/**
+	 * Recalls many probe patterns at once (see Recall()), the neurons of the net are not touched.
+	 * Each probe has its own state buffer, the weights are shared.
+	 * With ANHFSynchronous in graph mode the fields of all probes get calculated as one matrix-matrix product per sweep,
+	 * probes which converged drop out. Otherwise the probes get distributed over the threads.
+	 * @param pProbes iProbes patterns one after another, one value per neuron.
+	 * @param pResults Receives the final states, same layout like pProbes (may be the same buffer).
+	 * @param iProbes Number of probes.
+	 * @param pIterations If not NULL, receives the number of sweeps of each probe.
+	 * @param iMaxIterations Maximum number of sweeps.
+	 * @param flMode ANHFAsynchronous or ANHFSynchronous.
+	 * @param pEnergies If not NULL, receives the energy of the final state of each probe.
+	 */
+	void RecallBatch(	const float *pProbes, float *pResults, const unsigned int &iProbes, unsigned int *pIterations = NULL,
+						const unsigned int &iMaxIterations = 100, const HFUpdateFlag &flMode = ANHFAsynchronous, float *pEnergies = NULL);
+	/**
+	 * Recalls many samples with the default parameters of RecallBatch().
+	 * @param pInput Contiguous input, iSamples * (size of the layer).
+	 * @param pOutput Contiguous output, iSamples * (size of the layer).
+	 * @param iSamples Number of samples.
+	 */
+	virtual void PredictBatch(const float *pInput, float *pOutput, const unsigned int &iSamples);
+
+	/**
+	 * Saves the net to the filesystem.
+	 * A compiled net has no edges, so they get rebuilt from the patterns before (Decompile()) and released afterwards.
+	 * @param path Path of the file.
+	 */
+	virtual void ExpToFS(std::string path, const FileFormatFlag &fFormat = ANFormatBZ2);
+
+	/**
+	 * Copies the weights of the edges into the weight matrix used by Recall().
+	 * Only needed if the edges were changed directly after the last PropagateBW().
+	 */
+	void UpdateMatrix();
+
 	/**
 	 * Propagates through all neurons of the net.
 	 * \f$
@@ -72,6 +181,7 @@ public:
 	 * \\ s_i \text{ is the current state of the neuron which will get updated and}
 	 * \\ \theta_i \text{ is the bias}
 	 * \f$
+	 * In compiled mode all neurons get updated at once from the packed states (synchronous update).
 	 */
 	virtual void PropagateFW();
 	/**
@@ -87,6 +197,8 @@ public:
 	 * \\ L \hat = \text{ is the number of patterns}
 	 * \\ N \hat = \text{ are the single values in the patterns}
 	 * \f$
+	 * The patterns are the ones of the training set (if there is one) and the ones of StorePattern().
+	 * In compiled mode the patterns only get packed.
 	 */
 	virtual void PropagateBW();
 
@@ -0,0 +1,133 @@
+/*
+#-------------------------------------------------------------------------------
+# Copyright (c) 2012 Daniel <dgrat> Frenzel.
+# All rights reserved. This program and the accompanying materials
+# are made available under the terms of the GNU Lesser Public License v2.1
+# which accompanies this distribution, and is available at
+# http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+#
+# Contributors:
+#     Daniel <dgrat> Frenzel - initial API and implementation
+#-------------------------------------------------------------------------------
+*/
+
+#ifndef ANSOMCODEBOOK_H_
+#define ANSOMCODEBOOK_H_
+
+#include <vector>
+
+namespace ANN {
+
+class AbsLayer;
+class CPUKernels;
+
+/* maximum number of neurons per sample in SOMCodebook::FindBMUs() */
+#define ANSOM_MAX_K 64
+
+
+/**
+ * \brief Dense weight matrix (codebook) of the output layer of a self organizing map.
+ *
+ * Row j holds the weights of all edges directing from the input layer to neuron j of the output layer,
+ * in the order of AbsNeuron::GetConsI() (like AbsLayer::ExpEdgesIn()).
+ * The squared length of every row is kept up to date, so the squared euclidean distance to an input x is
+ * \f$ ||x||^2 - 2x \cdot w + ||w||^2 \f$, which needs one matrix-vector product for all neurons.
+ *
+ * The edges of the graph are not changed by the codebook, Export() writes the weights back.
+ */
+class SOMCodebook {
+private:
+	unsigned int m_iNeurons;				// nr. of rows
+	unsigned int m_iInputs;					// nr. of columns
+
+	std::vector<float> m_vWeights;			// m_iNeurons * m_iInputs
+	std::vector<float> m_vNorms;			// squared length of each row
+	std::vector<float> m_vDots;				// dot products of the current input with each row (FindBMU())
+
+	/*
+	 * One buffer per thread for FindBMUs(), holding the dot products of a block of samples with all rows
+	 */
+	std::vector<std::vector<float> > m_vWorkspaces;
+
+	/*
+	 * Vectorized kernels for the processor, chosen at runtime.
+	 */
+	const CPUKernels *m_pKernels;
+
+public:
+	SOMCodebook();
+	virtual ~SOMCodebook();
+
+	/**
+	 * Copies the weights of the incoming edges of the layer into the codebook.
+	 * @param pLayer Output layer of the map.
+	 */
+	void Import(const AbsLayer *pLayer);
+	/**
+	 * Writes the weights back to the incoming edges of the layer.
+	 * @param pLayer Must be the layer the codebook was imported from.
+	 */
+	void Export(AbsLayer *pLayer) const;
+
+	/**
+	 * Frees the memory.
+	 */
+	void Clear();
+	/**
+	 * Allocates iNeurons rows of iInputs zeros, to be filled with SetRow().
+	 */
+	void Resize(const unsigned int &iNeurons, const unsigned int &iInputs);
+
+	unsigned int GetNrOfNeurons() const;
+	unsigned int GetNrOfInputs() const;
+
+	/**
+	 * @return Returns the weights of neuron iNeuron (GetNrOfInputs() values).
+	 */
+	const float *GetRow(const unsigned int &iNeuron) const;
+	/**
+	 * @return Returns the whole matrix (GetNrOfNeurons() * GetNrOfInputs() values, row-major).
+	 */
+	const float *GetWeights() const;
+	/**
+	 * @return Returns the squared length of the weight vector of every neuron.
+	 */
+	const float *GetNorms() const;
+
+	/**
+	 * Overwrites the weights of neuron iNeuron.
+	 */
+	void SetRow(const unsigned int &iNeuron, const float *pWeights);
+
+	/**
+	 * Moves the weights of neuron iNeuron towards the input: \f$ w = w + \eta (x - w) \f$
+	 * @param fRate Learning rate times influence of the neighborhood.
+	 */
+	void Adapt(const unsigned int &iNeuron, const float *pInput, const float &fRate);
+
+	/**
+	 * Searches the best matching unit of an input vector.
+	 * Each thread searches a block of rows, the results of the threads get reduced afterwards.
+	 * If two neurons have the same distance the one with the smaller index wins, so the result does not depend on the number of threads.
+	 * @param pInput Input vector (GetNrOfInputs() values).
+	 * @param pDistances If not NULL, receives the squared distance of the input to every neuron.
+	 * @param pConscience If not NULL, the conscience mechanism is applied: neuron j competes with its distance minus (1/GetNrOfNeurons() - pConscience[j]).
+	 * @return Returns the index of the best matching neuron.
+	 */
+	unsigned int FindBMU(const float *pInput, float *pDistances = NULL, const float *pConscience = NULL);
+
+	/**
+	 * Searches the iK best matching units of many input vectors.
+	 * The samples are split into small blocks, each thread handles whole blocks with one matrix-matrix product.
+	 * The result of a sample does not depend on the number of threads (ties are broken like in FindBMU()).
+	 * @param pInputs iSamples input vectors, one after another (row-major).
+	 * @param pBMUs Receives iK indices per sample, the best matching neuron first.
+	 * @param pDistances If not NULL, receives the squared distances belonging to pBMUs.
+	 * @param iK Number of neurons per sample, at most GetNrOfNeurons() and ANSOM_MAX_K.
+	 */
+	void FindBMUs(const float *pInputs, const unsigned int &iSamples, unsigned int *pBMUs, float *pDistances = NULL, const unsigned int &iK = 1);
+};
+
+}
+
+#endif /* ANSOMCODEBOOK_H_ */
@@ -0,0 +1,113 @@
+/*
+#-------------------------------------------------------------------------------
+# Copyright (c) 2012 Daniel <dgrat> Frenzel.
+# All rights reserved. This program and the accompanying materials
+# are made available under the terms of the GNU Lesser Public License v2.1
+# which accompanies this distribution, and is available at
+# http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+#
+# Contributors:
+#     Daniel <dgrat> Frenzel - initial API and implementation
+#-------------------------------------------------------------------------------
+*/
+
+#ifndef ANSOMINDEX_H_
+#define ANSOMINDEX_H_
+
+#include <vector>
+
+#include <ANSOMCodebook.h>
+
+namespace ANN {
+
+
+/**
+ * \brief Approximate search of the best matching unit in a large codebook.
+ *
+ * The rows of the codebook get clustered with k-means. A query compares the input with the centroids first
+ * and then scans only the rows of the GetNrOfProbes() closest clusters.
+ * More probes give a higher recall (fraction of queries which find the exact best matching unit) and a smaller speedup.
+ *
+ * The distances to the scanned rows are always calculated with the current weights, so while the weights drift
+ * (SOMNet::Training()) the result is still a valid neuron, only the recall drops until the next Build().
+ */
+class SOMIndex {
+private:
+	unsigned int m_iClusters;				// wanted nr. of clusters, zero: square root of the nr. of neurons
+	unsigned int m_iProbes;					// nr. of clusters searched per query
+
+	SOMCodebook m_Centroids;				// one row per cluster
+	std::vector<unsigned int> m_vMembers;	// indices of the neurons, grouped by cluster
+	std::vector<unsigned int> m_vOffsets;	// first member of each cluster in m_vMembers, nr. of clusters + 1 entries
+	std::vector<unsigned int> m_vAssign;	// cluster of each neuron (Build())
+	std::vector<unsigned int> m_vProbes;	// clusters of the current query
+
+	unsigned int m_iNeurons;				// size of the codebook the index was built for
+
+	/*
+	 * Results of the last MeasureRecall()
+	 */
+	float m_fRecall;
+	float m_fSpeedup;
+
+public:
+	/**
+	 * @param iClusters Number of clusters, zero chooses the square root of the number of neurons.
+	 * @param iProbes Number of clusters searched per query.
+	 */
+	SOMIndex(const unsigned int &iClusters = 0, const unsigned int &iProbes = 1);
+	virtual ~SOMIndex();
+
+	void SetNrOfClusters(const unsigned int &iClusters);
+	unsigned int GetNrOfClusters() const;
+	/**
+	 * @param iProbes Number of clusters searched per query, at most ANSOM_MAX_K.
+	 */
+	void SetNrOfProbes(const unsigned int &iProbes);
+	unsigned int GetNrOfProbes() const;
+
+	/**
+	 * Clusters the rows of the codebook.
+	 * The first build starts with evenly spaced rows as centroids (on a trained map these are spread over the lattice),
+	 * later builds continue from the centroids of the previous one, so few iterations are needed while the weights drift.
+	 * @param iIterations Number of k-means iterations.
+	 */
+	void Build(const SOMCodebook &Codebook, const unsigned int &iIterations = 4);
+
+	/**
+	 * Frees the memory, the next Build() starts from scratch.
+	 */
+	void Clear();
+	/**
+	 * @return Returns true if Build() was called for a codebook of this size.
+	 */
+	bool IsBuilt(const SOMCodebook &Codebook) const;
+
+	/**
+	 * Searches the best matching unit approximately. Not thread safe.
+	 * If two neurons have the same distance the one with the smaller index wins.
+	 * @return Returns the index of the neuron.
+	 */
+	unsigned int FindBMU(const SOMCodebook &Codebook, const float *pInput);
+
+	/**
+	 * Compares FindBMU() with the exact search of the codebook (SOMCodebook::FindBMU()) and times both.
+	 * The results are kept for GetRecall() and GetSpeedup().
+	 * @param pInputs iSamples input vectors, one after another.
+	 * @return Returns the fraction of samples for which the exact best matching unit was found.
+	 */
+	float MeasureRecall(SOMCodebook &Codebook, const float *pInputs, const unsigned int &iSamples);
+
+	/**
+	 * @return Returns the recall of the last MeasureRecall().
+	 */
+	float GetRecall() const;
+	/**
+	 * @return Returns the time of the exact search divided by the time of FindBMU() in the last MeasureRecall().
+	 */
+	float GetSpeedup() const;
+};
+
+}
+
+#endif /* ANSOMINDEX_H_ */
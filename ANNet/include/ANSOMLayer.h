@@ -51,13 +51,14 @@ public:
 	 * Each neuron of this layer with each of the destination layer.
 	 * @param pDestLayer pointer to layer to connect with.
 	 * @param bAllowAdapt allows the change of the weights between both layers.
+	 * @param pArena takes the edges from this arena in one block (e.g. AbsNet::GetEdgeArena()). If NULL, every edge is allocated on its own.
 	 */
-	void ConnectLayer(AbsLayer *pDestLayer, const bool &bAllowAdapt = true);
+	void ConnectLayer(AbsLayer *pDestLayer, const bool &bAllowAdapt = true, EdgeArena *pArena = NULL);
 
 	/*
 	 *
 	 */
-	void ConnectLayer(AbsLayer *pDestLayer, const F2DArray &f2dEdgeMat, const bool &bAllowAdapt = true);
+	void ConnectLayer(AbsLayer *pDestLayer, const F2DArray &f2dEdgeMat, const bool &bAllowAdapt = true, EdgeArena *pArena = NULL);
 	/**
 	 * Sets learning rate scalar of the network.
 	 * @param fVal New value of the learning rate. Recommended: 0.005f - 1.0f
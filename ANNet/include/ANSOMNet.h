@@ -15,12 +15,22 @@
 #define SOMNET_H_
 
 #include <basic/ANAbsNet.h>
+#include <ANSOMCodebook.h>
+#include <ANSOMIndex.h>
 
 
 namespace ANN {
 
 class SOMNeuron;
 class DistFunction;
+class TrainingSet;
+
+
+enum {
+	ANSOMOnline 	= 1 << 0,	// one random sample per cycle, the neighborhood moves towards it (Kohonen)
+	ANSOMBatch 		= 1 << 1	// one epoch over all samples per cycle, each neuron becomes the weighted mean of the samples
+};
+typedef uint32_t SOMTrainingFlag;
 
 class SOMNet : public AbsNet {
 protected:
@@ -37,6 +47,50 @@ protected:
 	// Conscience mechanism
 	float 			m_fConscienceRate;
 
+	/*
+	 * Dense copy of the weights of the output layer, the training works on it.
+	 * Gets imported from the edges at the beginning of Training() and exported at the end.
+	 */
+	SOMCodebook 	m_Codebook;
+	unsigned int 	m_iBMNeuron;			// index of the best matching unit in the output layer
+	std::vector<float> m_vConscience;		// bias of the conscience mechanism of each neuron during the training
+	std::vector<float> m_vDistances;		// squared distances of the current input to each neuron (conscience mechanism)
+
+	/*
+	 * Batch training
+	 */
+	SOMTrainingFlag m_fTrainingMode;
+	std::vector<float> m_vPositions;		// positions of the neurons of the output layer, one row per neuron
+	unsigned int 	m_iPosDim;				// nr. of coordinates per neuron
+	std::vector<unsigned int> m_vBMUs;		// best matching unit of each sample of the current chunk
+	std::vector<double> m_vSums;			// sum of the samples mapped to each neuron, one row per neuron (a float would stop growing over large epochs)
+	std::vector<uint64_t> m_vHits;			// nr. of samples mapped to each neuron
+
+	/*
+	 * Lattice of the output layer (SOMLayer::GetDim()), empty if the positions of the neurons are no regular grid.
+	 * Neuron i sits at the coordinates (i / m_vLatticeStrides[k]) % m_vLattice[k].
+	 */
+	std::vector<unsigned int> m_vLattice;
+	std::vector<unsigned int> m_vLatticeStrides;
+	std::vector<float> m_vLatticeDist;		// distance of each offset (|dx|, |dy|, ..) on the lattice, indexed like a neuron
+	std::vector<float> m_vLatticeWeights;	// neighborhood function of each offset for m_fTableSigma
+	float 			m_fTableSigma;			// radius m_vLatticeWeights was calculated for
+	std::vector<unsigned int> m_vNeighbors;	// neighborhood of the current BMU (online training)
+	std::vector<float> m_vNeighborWeights;
+
+	/*
+	 * Approximate BMU search of the online training
+	 */
+	bool 			m_bApproximate;
+	unsigned int 	m_iIndexRebuild;		// nr. of cycles between two builds of m_Index
+	SOMIndex 		m_Index;
+
+	/*
+	 * Coarse-to-fine training
+	 */
+	std::vector<float> m_vResolutionShares;	// share of the cycles of each level, coarsest first
+	float 			m_fResolutionFactor;	// ratio of the sizes of two successive levels
+
 	/* first Ctor */
 	std::vector<unsigned int> m_vDimI; // dimensions of the input layer (Cartesian coordinates)
 	std::vector<unsigned int> m_vDimO; // dimensions of the output layer (Cartesian coordinates)
@@ -53,9 +107,15 @@ protected:
 	void FindSigma0();		// size of the net
 
 	/**
-	 *
+	 * Searches the best matching unit of pInput in m_Codebook and sets m_iBMNeuron and m_pBMNeuron.
+	 * Applies the conscience mechanism if the rate is greater zero.
 	 */
-	void FindBMNeuron();	// best matching unit
+	void FindBMNeuron(const float *pInput);	// best matching unit
+
+	/**
+	 * Moves the codebook vectors of the neighborhood of m_iBMNeuron towards pInput.
+	 */
+	void PropagateBW(const float *pInput);
 
 	/**
 	 * Implement to determine back propagation ( == learning ) behavior
@@ -63,7 +123,63 @@ protected:
 	virtual void PropagateBW();
 
 	/**
-	 * TODO Implement to determine propagation behavior
+	 * Copies the positions of the output layer into m_vPositions and checks whether they form the lattice of SOMLayer::GetDim().
+	 * If so, the tables of the lattice get set up, otherwise the neighborhood is searched among all neurons.
+	 */
+	void BuildLattice();
+
+	/**
+	 * Recalculates the neighborhood function of all offsets within m_fSigmaT if the radius changed.
+	 */
+	void UpdateLatticeWeights();
+
+	/**
+	 * Collects the neurons within m_fSigmaT of neuron iCenter and their neighborhood function.
+	 * Only the bounding box of the radius on the lattice gets visited. Needs BuildLattice() and UpdateLatticeWeights().
+	 */
+	void FindNeighbors(const unsigned int &iCenter, std::vector<unsigned int> &vNeurons, std::vector<float> &vWeights) const;
+
+	/**
+	 * Trains the map itself with the schedule of the radius and the learning rate (see Training()).
+	 */
+	void TrainMap(const unsigned int &iCycles);
+
+	/**
+	 * Trains a series of smaller maps first, each one initialized by interpolating the codebook of the previous one,
+	 * and finally the map itself (see SetResolutionSchedule()).
+	 */
+	void TrainMultiRes(const unsigned int &iCycles);
+
+	/**
+	 * Measures the recall of m_Index with up to 64 evenly spaced samples of the set and prints it with the speedup.
+	 */
+	void ReportIndex(const TrainingSet *pSet);
+
+	/**
+	 * Adds the samples of the set to the moments of InitPCA(): the sum of (x - vShift) and the sum of the outer products of (x - vShift).
+	 * Shifting by one sample of the data keeps the sums small. The threads handle whole blocks of samples with a matrix-matrix product.
+	 */
+	void AccumulateMoments(const TrainingSet *pSet, std::vector<float> &vShift, std::vector<double> &vSum, std::vector<double> &vProducts, double &fCount);
+
+	/**
+	 * Maps all samples of the set to their best matching units and adds them to m_vSums and m_vHits.
+	 */
+	void AccumulateBatch(const TrainingSet *pSet);
+
+	/**
+	 * Replaces every codebook vector by the mean of the accumulated samples,
+	 * weighted by the neighborhood function between the neuron and the best matching unit of each sample.
+	 */
+	void UpdateBatch();
+
+	/**
+	 * One epoch of the batch training: all samples of the training set or stream get accumulated, then UpdateBatch().
+	 */
+	void TrainEpoch();
+
+	/**
+	 * Maps the values of the input layer to the map:
+	 * the value of each output neuron becomes its euclidean distance to the input and the best matching unit gets set.
 	 */
 	virtual void PropagateFW();
 
@@ -134,10 +250,104 @@ public:
 
 	/**
 	 * Trains the network with given input until iCycles is reached.
+	 * In batch mode (SetTrainingMode()) each cycle is one epoch over the whole training set.
 	 * @param iCycles Maximum number of training cycles.
 	 */
 	virtual void Training(const unsigned int &iCycles = 1000);
 
+	/**
+	 * Linear initialization of the map: the weights get laid out on the plane (or space) spanned by the principal components of the training data.
+	 * The neuron positions are scaled to [-1, 1] per dimension; the dimension with the largest extent follows the first component,
+	 * the second one the second component and so on. Each component spans plus/minus the square root of its eigenvalue around the mean.
+	 * The covariance matrix is accumulated in parallel in one pass over the training set or the training stream.
+	 * The map is ordered from the beginning, so Training() can start with a small radius (SetSigma0())
+	 * and needs far fewer cycles than after the random initialization.
+	 * @return Returns false if there are no training data.
+	 */
+	bool InitPCA();
+
+	/**
+	 * Maps a block of vectors to the trained map (vector quantization).
+	 * The samples get distributed over the threads in small blocks, see SOMCodebook::FindBMUs().
+	 * Works on the codebook of the last Training() (or imported by the first call), see UpdateCodebook().
+	 * @param pInput iSamples vectors of the size of the input layer, one after another.
+	 * @param iSamples Number of vectors.
+	 * @param pBMUs Receives iK neuron indices per vector, the best matching unit first.
+	 * @param pErrors If not NULL, receives the quantization errors (euclidean distances) belonging to pBMUs.
+	 * @param iK Number of best matching units per vector (top-k), at most ANSOM_MAX_K.
+	 * @param pHits If not NULL, histogram with one counter per neuron of the output layer.
+	 * The counter of the best matching unit of each vector gets incremented, so it accumulates over calls.
+	 */
+	void MapBatch(	const float *pInput, const unsigned int &iSamples, unsigned int *pBMUs,
+					float *pErrors = NULL, const unsigned int &iK = 1, uint64_t *pHits = NULL);
+
+	/**
+	 * Copies the weights of the edges into the codebook used by MapBatch() and PropagateFW().
+	 * Only needed if the edges were changed directly after the last Training().
+	 */
+	void UpdateCodebook();
+
+	/**
+	 * Uses an approximate index (SOMIndex) instead of the exact search for the best matching units of the online training.
+	 * Meant for maps with very many neurons. The exact search is the default.
+	 * The index gets rebuilt every iRebuild cycles, as the weights drift. Before each rebuild the recall is measured and
+	 * reported together with the speedup (see GetApproximateSearch()).
+	 * Not used with the conscience mechanism, which needs the distances of all neurons.
+	 * Pays off once the map is ordered (e.g. when training a trained map further), while the map unfolds the weights move too fast.
+	 * @param bEnable Switches the index on or off.
+	 * @param iProbes Number of clusters searched per input. More probes raise the recall and lower the speedup.
+	 * @param iRebuild Number of cycles between two rebuilds.
+	 * @param iClusters Number of clusters, zero chooses the square root of the number of neurons.
+	 */
+	void SetApproximateSearch(	const bool &bEnable, const unsigned int &iProbes = 1,
+								const unsigned int &iRebuild = 1000, const unsigned int &iClusters = 0);
+	/**
+	 * @return Returns the index with its recall and speedup, or NULL if the exact search is used.
+	 */
+	const SOMIndex *GetApproximateSearch() const;
+
+	/**
+	 * Coarse-to-fine training for large maps: Training() trains a small map first, interpolates its codebook
+	 * to the next larger map and continues there, until the map itself is reached.
+	 * Level i is fFactor times smaller in every dimension of the lattice than level i+1, the last level is the map itself.
+	 * The first level starts with the radius of half of its size, each finer level with a radius of 2*fFactor,
+	 * so the expensive phase with a large radius runs on the small maps only.
+	 * The learning rate, the neighborhood function, the training mode and the training data are taken over by all levels.
+	 * Needs a regular lattice (SOMLayer::GetDim()).
+	 * @param vShares Share of the training cycles of each level, coarsest first. Fewer than two levels switch the schedule off.
+	 * @param fFactor Ratio of the sizes of two successive levels.
+	 */
+	void SetResolutionSchedule(const std::vector<float> &vShares, const float &fFactor = 2.f);
+	/**
+	 * @return Returns the share of the training cycles of each level, empty if the map is trained directly.
+	 */
+	std::vector<float> GetResolutionSchedule() const;
+
+	/**
+	 * Chooses the training algorithm.
+	 * ANSOMOnline (default): the classic Kohonen rule, one sample per cycle.
+	 * ANSOMBatch: batch SOM, one epoch per cycle. The best matching units of all samples get searched in parallel,
+	 * then every neuron is set to the neighborhood-weighted mean of the samples. Needs no learning rate and gives
+	 * the same result for the same training set (the order of the samples does not matter).
+	 * The conscience mechanism is only used by the online training.
+	 */
+	void SetTrainingMode(const SOMTrainingFlag &fMode);
+	/**
+	 * @return Returns the training algorithm.
+	 */
+	SOMTrainingFlag GetTrainingMode() const;
+
+
+	/**
+	 * Sets the radius of the neighborhood at the beginning of Training().
+	 * CreateSOM() sets it to half of the size of the map.
+	 * @param fVal New radius, must be greater than one.
+	 */
+	void SetSigma0(const float &fVal);
+	/**
+	 * @return Returns the radius of the neighborhood at the beginning of Training().
+	 */
+	float GetSigma0() const;
 
 	/**
 	 * Sets learning rate scalar of the network.
@@ -27,6 +27,7 @@ namespace ANN {
 class AbsNeuron;
 class TransfFunction;
 class ConTable;
+class EdgeArena;
 
 
 enum {
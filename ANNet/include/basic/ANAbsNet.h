@@ -21,6 +21,8 @@
 #include <iostream>
 
 #include <basic/ANAbsLayer.h>
+#include <basic/ANEdgeArena.h>
+#include <containers/ANNetFile.h>
 
 //#include <basic/ANExporter.h>
 //#include <basic/ANImporter.h>
@@ -31,6 +33,7 @@ namespace ANN {
 class F2DArray;
 class F3DArray;
 class TrainingSet;
+class StreamingSet;
 class ConTable;
 // math
 class TransfFunction;
@@ -63,9 +66,11 @@ protected:
 	NetTypeFlag m_fTypeFlag;
 
 	TrainingSet *m_pTrainingData;		// list of training data
+	StreamingSet *m_pTrainingStream;	// training data read from disk, used instead of m_pTrainingData if set
 	float m_fLearningRate;				// global learning rate
 	float m_fMomentum;
 	float m_fWeightDecay;
+	unsigned int m_iBatchSize;			// number of samples propagated together in TrainFromData()
 	const TransfFunction *m_pTransfFunction;
 
 	/* list of all layers in this net; last should be output layer, first input layer */
@@ -75,6 +80,8 @@ protected:
 	AbsLayer *m_pIPLayer;				// pointer to input layer
 	AbsLayer *m_pOPLayer;				// pointer to output layer
 
+	EdgeArena m_EdgeArena;				// memory of the edges created by the net, freed in EraseAll()
+
 	/**
 	 * Adds a layer to the network.
 	 * @param iSize Number of neurons of the layer.
@@ -82,6 +89,31 @@ protected:
 	 */
 	virtual void AddLayer(const unsigned int &iSize, const LayerTypeFlag &flType) = 0;
 
+	/**
+	 * Trains the net with a mini-batch of the training set.
+	 * Standard implementation propagates every sample on its own.
+	 * @param iStart Index of the first sample in m_pTrainingData.
+	 * @param iSize Number of samples.
+	 * @return Returns the summed error of the samples.
+	 */
+	virtual float TrainBatch(const unsigned int &iStart, const unsigned int &iSize);
+	/**
+	 * Trains the net once with every sample of m_pTrainingData, in mini-batches of m_iBatchSize.
+	 * @return Returns the summed error of the samples.
+	 */
+	float TrainSamples();
+
+	/**
+	 * Writes the net in the uncompressed raw format (see RawNetHeader).
+	 */
+	void ExpToRawFS(std::string path);
+	/**
+	 * Creates the net from a raw file.
+	 * @param bEdges Create the edges. Without them only the layers and neurons get created (see BPNet::Compile(const NetFile &)).
+	 * @param bTrainingSet Load the training set of the file (if any).
+	 */
+	void ImpFromRawFS(const NetFile &File, const bool &bEdges = true, const bool &bTrainingSet = true);
+
 public:
 	AbsNet();
 	//AbsNet(AbsNet *pNet);	// TODO implement
@@ -118,7 +150,7 @@ public:
 	NetTypeFlag GetFlag() const;
 
 	/**
-	 * Cycles the input from m_pTrainingData
+	 * Cycles the input from m_pTrainingData (or chunk by chunk from m_pTrainingStream if set)
 	 * Checks total error of the output returned from SetExpectedOutputData()
 	 * @return Returns the total error of the net after every training step.
 	 * @param iCycles Maximum number of training cycles
@@ -126,6 +158,16 @@ public:
 	 */
 	virtual std::vector<float> TrainFromData(const unsigned int &iCycles, const float &fTolerance, const bool &bBreak, float &fProgress);
 
+	/**
+	 * Sets the number of samples TrainFromData() propagates together before the weights get adapted.
+	 * @param iSize Size of a mini-batch. 1 (default) means online learning after every sample.
+	 */
+	virtual void SetBatchSize(const unsigned int &iSize);
+	/**
+	 * @return Returns the size of a mini-batch.
+	 */
+	unsigned int GetBatchSize() const;
+
 	/**
 	 * Adds a new layer to the network. New layer will get appended to m_lLayers.
 	 * @param pLayer Pointer to the new layer.
@@ -137,8 +179,17 @@ public:
 	 */
 	virtual std::vector<AbsLayer*> GetLayers() const;
 
+	/**
+	 * Arena holding the edges created by the net (CreateNet(), SOMNet::CreateSOM(), ..).
+	 * Pass it to the ConnectLayer() functions of layers added to this net,
+	 * so EraseAll() frees their edges as well.
+	 * @return Returns a pointer to the edge arena of the net.
+	 */
+	EdgeArena *GetEdgeArena();
+
 	/**
 	 * Deletes the complete network (all connections and all values).
+	 * The edges of the arena are released at once.
 	 */
 	virtual void EraseAll();
 
@@ -154,6 +205,13 @@ public:
 	 * @param iLayerID Index of the layer in m_lLayers
 	 */
 	virtual void SetInput(const std::vector<float> &inputArray, const unsigned int &iLayerID);
+	/**
+	 * Set the value of neurons in the input layer to new values
+	 * @param pInputArray New values of the input layer
+	 *
+	 * @param iSize Number of values in pInputArray
+	 */
+	virtual void SetInput(const float *pInputArray, const unsigned int &iSize);
 	/**
 	 * Set the value of neurons in the input layer to new values
 	 * @param pInputArray New values of the input layer
@@ -162,7 +220,7 @@ public:
 	 *
 	 * @param iSize Number of values in pInputArray
 	 */
-	virtual void SetInput(float *pInputArray, const unsigned int &iSize, const unsigned int &iLayerID);
+	virtual void SetInput(const float *pInputArray, const unsigned int &iSize, const unsigned int &iLayerID);
 
 	/**
 	 * Set the values of the neurons equal to the values of the outputArray.
@@ -180,6 +238,15 @@ public:
 	 * @param iLayerID Index of the layer in m_lLayers
 	 */
 	virtual float SetOutput(const std::vector<float> &outputArray, const unsigned int &iLayerID);
+	/**
+	 * Set the values of the neurons equal to the values of the outputArray.
+	 * Also calcs the error delta of each neuron in the output layer.
+	 * @return returns the total error of the output layer ( sum(pow(delta, 2)/2.f )
+	 * @param pOutputArray New values of the output layer
+	 *
+	 * @param iSize Number of values in pOutputArray
+	 */
+	virtual float SetOutput(const float *pOutputArray, const unsigned int &iSize);
 	/**
 	 * Set the values of the neurons equal to the values of the outputArray.
 	 * Also calcs the error delta of each neuron in the output layer.
@@ -190,7 +257,7 @@ public:
 	 *
 	 * @param iLayerID Index of the layer in m_lLayers
 	 */
-	virtual float SetOutput(float *pOutputArray, const unsigned int &iSize, const unsigned int &iLayerID);
+	virtual float SetOutput(const float *pOutputArray, const unsigned int &iSize, const unsigned int &iLayerID);
 
 	/**
 	 *  Sets training data of the net.
@@ -205,6 +272,16 @@ public:
 	 *  @return Returns the current training set of the net or NULL if nothing was set.
 	 */
 	virtual TrainingSet *GetTrainingSet() const;
+	/**
+	 *  Sets training data which is streamed from disk (see StreamingSet).
+	 *  TrainFromData() uses the stream instead of the training set as long as it is set.
+	 *  @param pStream Opened stream or NULL to use the training set again.
+	 */
+	virtual void SetTrainingStream(StreamingSet *pStream);
+	/**
+	 *  @return Returns the stream set by SetTrainingStream() or NULL.
+	 */
+	StreamingSet *GetTrainingStream() const;
 
 	/**
 	 * Returns layer at index iLayerID.
@@ -246,10 +323,13 @@ public:
 
 	/**
 	 * Save net's content to filesystem
+	 * @param path Path of the file.
+	 * @param fFormat ANFormatBZ2 (compressed, default) or ANFormatRaw (uncompressed, faster to load, back propagation nets can run straight from the file with BPNet::Compile(const NetFile &)).
 	 */
-	virtual void ExpToFS(std::string path);
+	virtual void ExpToFS(std::string path, const FileFormatFlag &fFormat = ANFormatBZ2);
 	/**
 	 * Load net's content to filesystem
+	 * Detects the format of the file (compressed or raw) automatically.
 	 * @return The connections table of this net.
 	 */
 	virtual void ImpFromFS(std::string path);
@@ -259,6 +339,15 @@ public:
 	 * @return Returns the values of the output layer after propagating the net.
 	 */
 	virtual std::vector<float> GetOutput();
+	/**
+	 * Propagates many samples and writes the values of the output layer into a buffer owned by the caller.
+	 * Standard implementation propagates the samples one by one through the neurons.
+	 * Only usable if input/output layer was already set.
+	 * @param pInput Contiguous input, iSamples * (size of the input layer).
+	 * @param pOutput Contiguous output, iSamples * (size of the output layer).
+	 * @param iSamples Number of samples.
+	 */
+	virtual void PredictBatch(const float *pInput, float *pOutput, const unsigned int &iSamples);
 	/**
 	 * standard output of the net. Only usable if input/output layer was already set.
 	 */
@@ -33,6 +33,7 @@ class TransfFunction;
 class AbsLayer;
 class AbsNeuron;
 class Edge;
+class EdgeArena;
 
 
 /**
@@ -77,8 +78,10 @@ public:
 	AbsNeuron(const AbsNeuron *pNeuron);
 	virtual ~AbsNeuron();
 
-	/*
-	 * TODO
+	/**
+	 * Removes all edges from the lists of this neuron.
+	 * The edges are not freed, because they are shared with other neurons.
+	 * Edges allocated from an EdgeArena get freed with the arena.
 	 */
 	void EraseAllEdges();
 
@@ -99,6 +102,15 @@ public:
 	virtual void SetConO(Edge *Edge, const unsigned int iID);
 	virtual void SetConI(Edge *Edge, const unsigned int iID);
 
+	/**
+	 * Resizes the list of incoming edges. New entries are NULL and must get set with SetConI().
+	 */
+	virtual void ResizeConsI(const unsigned int &iSize);
+	/**
+	 * Resizes the list of outgoing edges. New entries are NULL and must get set with SetConO().
+	 */
+	virtual void ResizeConsO(const unsigned int &iSize);
+
 	/**
 	 * @return Pointer to an incoming edge
 	 * @param iID Index of edge in m_lIncomingConnections
@@ -110,14 +122,14 @@ public:
 	 */
 	virtual Edge* GetConO(const unsigned int &iID) const;
 	/**
-	 * @return Array of pointers of all incoming edges
+	 * @return Array of pointers of all incoming edges (no copy, valid until edges get added or removed)
 	 */
-	virtual std::vector<Edge*> GetConsI() const;
+	virtual const std::vector<Edge*> &GetConsI() const;
 	//virtual ANN::list<Edge*> GetConsI() const;
 	/**
-	 * @return Array of pointers of all outgoing edges
+	 * @return Array of pointers of all outgoing edges (no copy, valid until edges get added or removed)
 	 */
-	virtual std::vector<Edge*> GetConsO() const;
+	virtual const std::vector<Edge*> &GetConsO() const;
 	//virtual ANN::list<Edge*> GetConsO() const;
 	/**
 	 * @param iID New index of this neuron.
@@ -139,7 +151,7 @@ public:
 	 * Get the position of the neuron
 	 * @return x, y, z, .. coordinates of the neuron (e.g. SOM)
 	 */
-	virtual const std::vector<float> GetPosition() const;
+	virtual const std::vector<float> &GetPosition() const;
 	/**
 	 * Sets the current position of the neuron in the net.
 	 * @param vPos Vector with Cartesian coordinates
@@ -223,8 +235,29 @@ public:
 	 */
 	friend void Connect(AbsNeuron *srcNeuron, AbsLayer *destLayer, const std::vector<float> &vValues, const std::vector<float> &vMomentums, const bool &bAdaptState);
 
+	/**
+	 * Like the functions above, but takes the edges from pArena.
+	 * If pArena is NULL, every edge gets allocated on its own.
+	 */
+	friend void Connect(AbsNeuron *pSrcNeuron, AbsNeuron *pDstNeuron, const bool &bAdaptState, EdgeArena *pArena);
+	friend void Connect(AbsNeuron *pSrcNeuron, AbsNeuron *pDstNeuron, const float &fVal, const float &fMomentum, const bool &bAdaptState, EdgeArena *pArena);
+	friend void Connect(AbsNeuron *pSrcNeuron, AbsLayer *pDestLayer, const bool &bAdaptState, EdgeArena *pArena);
+	friend void Connect(AbsNeuron *pSrcNeuron, AbsLayer *pDestLayer, const std::vector<float> &vValues, const std::vector<float> &vMomentums, const bool &bAdaptState, EdgeArena *pArena);
+	/**
+	 * Connects every neuron of pSrcLayer with every neuron of pDestLayer (not the bias neurons).
+	 * All edges are taken from pArena in one block and the edge lists of the neurons get reserved before.
+	 * If pArena is NULL, every edge gets allocated on its own.
+	 * bAdaptState indicates whether the connections are changeable
+	 */
+	friend void Connect(AbsLayer *pSrcLayer, AbsLayer *pDestLayer, const bool &bAdaptState, EdgeArena *pArena);
+
 	operator float() const;
 };
 
+/*
+ * Not found by argument dependent lookup (no neuron among the parameters)
+ */
+void Connect(AbsLayer *pSrcLayer, AbsLayer *pDestLayer, const bool &bAdaptState, EdgeArena *pArena);
+
 }
 #endif /* ABSNEURON_H_ */
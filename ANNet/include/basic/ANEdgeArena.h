@@ -0,0 +1,86 @@
+/*
+#-------------------------------------------------------------------------------
+# Copyright (c) 2012 Daniel <dgrat> Frenzel.
+# All rights reserved. This program and the accompanying materials
+# are made available under the terms of the GNU Lesser Public License v2.1
+# which accompanies this distribution, and is available at
+# http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+#
+# Contributors:
+#     Daniel <dgrat> Frenzel - initial API and implementation
+#-------------------------------------------------------------------------------
+*/
+
+#ifndef ANEDGEARENA_H_
+#define ANEDGEARENA_H_
+
+#include <vector>
+
+namespace ANN {
+
+class Edge;
+
+
+/**
+ * \brief Arena allocator for the edges of a network.
+ *
+ * Edges get handed out from large memory blocks instead of being allocated one by one.
+ * They are never freed on their own: Release() gives back all blocks at once.
+ * A neuron only stores pointers to its edges, so all neurons using edges of the arena
+ * must have dropped them (AbsNeuron::EraseAllEdges()) before releasing.
+ *
+ * Not thread safe.
+ */
+class EdgeArena {
+private:
+	std::vector<Edge*> m_vBlocks;
+	unsigned int m_iBlockSize;				// nr. of edges in a regular block
+
+	Edge *m_pNext;							// next free edge in the current block
+	unsigned int m_iFree;					// nr. of free edges in the current block
+	unsigned int m_iSize;					// nr. of edges handed out
+
+public:
+	/**
+	 * @param iBlockSize Number of edges allocated together.
+	 */
+	EdgeArena(const unsigned int &iBlockSize = 4096);
+	/**
+	 * Creates an empty arena with the block size of Arena.
+	 * The edges stay owned by Arena (nets copied with the assignment operator share their edges).
+	 */
+	EdgeArena(const EdgeArena &Arena);
+	virtual ~EdgeArena();
+
+	/**
+	 * Only takes over the block size. This arena keeps its own edges, the edges of Arena stay owned by Arena.
+	 */
+	EdgeArena &operator = (const EdgeArena &Arena);
+
+	/**
+	 * Reserves a contiguous array of edges.
+	 * The memory is not initialized, the edges must get constructed with placement new.
+	 * Arrays larger than the block size get a block on their own.
+	 * @param iCount Number of edges.
+	 * @return Returns a pointer to the first edge.
+	 */
+	Edge *Alloc(const unsigned int &iCount);
+
+	/**
+	 * Frees all blocks. Every edge handed out by Alloc() becomes invalid.
+	 */
+	void Release();
+
+	/**
+	 * @return Returns the number of edges handed out since the last Release().
+	 */
+	unsigned int GetNrOfEdges() const;
+	/**
+	 * @return Returns the number of allocated memory blocks.
+	 */
+	unsigned int GetNrOfBlocks() const;
+};
+
+}
+
+#endif /* ANEDGEARENA_H_ */
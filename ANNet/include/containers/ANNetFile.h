@@ -0,0 +1,189 @@
+/*
+#-------------------------------------------------------------------------------
+# Copyright (c) 2012 Daniel <dgrat> Frenzel.
+# All rights reserved. This program and the accompanying materials
+# are made available under the terms of the GNU Lesser Public License v2.1
+# which accompanies this distribution, and is available at
+# http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+#
+# Contributors:
+#     Daniel <dgrat> Frenzel - initial API and implementation
+#-------------------------------------------------------------------------------
+*/
+
+#ifndef ANNETFILE_H_
+#define ANNETFILE_H_
+
+#include <string>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace ANN {
+
+enum {
+	ANFormatBZ2 	= 1 << 0,	// bzip2 compressed stream, written value by value (default)
+	ANFormatRaw 	= 1 << 1	// uncompressed, memory mappable (see RawNetHeader)
+};
+typedef uint32_t FileFormatFlag;
+
+/* magic number and version of the raw format */
+#define ANRAW_MAGIC 	"ANNETRAW"
+#define ANRAW_VERSION 	2
+/* alignment of every array in a raw file (bytes) */
+#define ANRAW_ALIGN 	64
+
+
+/**
+ * \brief Header at the beginning of a raw network file.
+ *
+ * Layout of the file: header, table of RawLayerDescr (one per layer), the arrays of the layers, the training set.
+ * The layers are stored in the order of AbsNet::GetLayers(), the input layer first for back propagation nets.
+ * All offsets are counted in bytes from the beginning of the file. Every array starts at a multiple of ANRAW_ALIGN.
+ * Numbers are stored in the byte order of the machine which wrote the file.
+ */
+struct RawNetHeader {
+	char 		m_cMagic[8];			// ANRAW_MAGIC, not null terminated
+	uint32_t 	m_iVersion;				// ANRAW_VERSION
+	uint32_t 	m_iNetType;				// NetTypeFlag
+	uint32_t 	m_iNrOfLayers;
+	uint32_t 	m_iReserved;
+	uint64_t 	m_iLayerTable;			// offset of the RawLayerDescr table
+	uint64_t 	m_iTrainingSet;			// offset of the RawTrainingSetDescr, 0 if the file contains no training set
+	uint64_t 	m_iFileSize;
+};
+
+/**
+ * \brief Description of a layer in a raw network file.
+ *
+ * The outgoing edges of all neurons are stored in compressed sparse row form:
+ * the edges of neuron i are the entries m_iEdgeOffsets[i] to m_iEdgeOffsets[i+1]-1 of the edge arrays,
+ * in the order of AbsNeuron::GetConsO(). AbsNet::ImpFromFS() builds the graph from these arrays.
+ *
+ * Back propagation nets which can be compiled (BPNet::Compile()) additionally store a dense block per layer except the input layer:
+ * the incoming weights as a row-major matrix in the layout of BPDenseLayer (row j holds the weights of neuron j,
+ * m_iNrOfNeurons * m_iDenseInputs) and the weights of the bias edges (m_iNrOfNeurons).
+ * BPNet::Compile(const NetFile &) propagates straight from these blocks.
+ */
+struct RawLayerDescr {
+	int32_t 	m_iID;
+	uint32_t 	m_iType;				// LayerTypeFlag
+	uint32_t 	m_iNrOfNeurons;
+	int32_t 	m_iZLayer;				// z-layer of back propagation nets, -1 otherwise
+	uint32_t 	m_iNrOfDims;			// dimensions of the positions of the neurons
+	uint32_t 	m_iHasBias;				// 1 if the layer has a bias neuron
+	uint64_t 	m_iNrOfEdges;			// outgoing edges of all neurons
+	uint64_t 	m_iNrOfBiasEdges;		// outgoing edges of the bias neuron
+
+	uint64_t 	m_iNeuronIDs;			// int32_t[m_iNrOfNeurons]
+	uint64_t 	m_iPositions;			// float[m_iNrOfNeurons * m_iNrOfDims]
+	uint64_t 	m_iEdgeOffsets;			// uint64_t[m_iNrOfNeurons + 1]
+	uint64_t 	m_iDstLayers;			// int32_t[m_iNrOfEdges], layer ID of the destination neurons
+	uint64_t 	m_iDstNeurons;			// int32_t[m_iNrOfEdges], ID of the destination neurons
+	uint64_t 	m_iWeights;				// float[m_iNrOfEdges]
+	uint64_t 	m_iBiasDstLayers;		// int32_t[m_iNrOfBiasEdges]
+	uint64_t 	m_iBiasDstNeurons;		// int32_t[m_iNrOfBiasEdges]
+	uint64_t 	m_iBiasWeights;			// float[m_iNrOfBiasEdges]
+
+	uint32_t 	m_iDenseInputs;			// neurons of the previous layer (width of the dense block)
+	uint32_t 	m_iReserved;
+	uint64_t 	m_iDenseWeights;		// float[m_iNrOfNeurons * m_iDenseInputs], 0 if the layer has no dense block
+	uint64_t 	m_iDenseBias;			// float[m_iNrOfNeurons]
+};
+
+/**
+ * \brief Description of the training set in a raw network file.
+ *
+ * The values of sample i are the entries m_iInputOffsets[i] to m_iInputOffsets[i+1]-1 of the input array (same for the output).
+ */
+struct RawTrainingSetDescr {
+	uint32_t 	m_iNrOfInputs;
+	uint32_t 	m_iNrOfOutputs;
+	uint64_t 	m_iInputOffsets;		// uint64_t[m_iNrOfInputs + 1]
+	uint64_t 	m_iInputs;				// float[m_iInputOffsets[m_iNrOfInputs]]
+	uint64_t 	m_iOutputOffsets;		// uint64_t[m_iNrOfOutputs + 1]
+	uint64_t 	m_iOutputs;				// float[m_iOutputOffsets[m_iNrOfOutputs]]
+};
+
+/**
+ * \brief Read only view of a raw network file (AbsNet::ExpToFS() with ANFormatRaw).
+ *
+ * The file gets mapped into memory and the arrays returned point directly into the mapping.
+ * BPNet::Compile(const NetFile &) runs a back propagation net on the dense blocks without copying the weights,
+ * AbsNet::ImpFromFS() builds the graph from a ConTable instead and copies the weights into the edges.
+ * The pointers are valid until Close() or the destruction of the object.
+ */
+class NetFile {
+private:
+	const char *m_pData;
+	size_t m_iSize;
+	bool m_bMapped;						// m_pData is a mapping (otherwise read into the heap)
+
+	NetFile(const NetFile &);
+	NetFile &operator = (const NetFile &);
+
+	bool InRange(const uint64_t &iOffset, const uint64_t &iBytes) const;
+	bool ValidDestinations(const uint64_t &iLayers, const uint64_t &iNeurons, const uint64_t &iEdges) const;
+	bool Validate() const;
+
+public:
+	NetFile();
+	virtual ~NetFile();
+
+	/**
+	 * Maps a raw network file into memory and checks the header and all offsets.
+	 * @param sPath Path of the file.
+	 * @return Returns false if the file does not exist, is no raw network file or is corrupt.
+	 */
+	bool Open(const std::string &sPath);
+	/**
+	 * Unmaps the file.
+	 */
+	void Close();
+	/**
+	 * @return Returns true if a file is opened.
+	 */
+	bool IsOpen() const;
+
+	/**
+	 * Checks the magic number only.
+	 * @return Returns true if the file at sPath is a raw network file.
+	 */
+	static bool IsRawFile(const std::string &sPath);
+
+	const RawNetHeader &GetHeader() const;
+	/**
+	 * @param iLayer Index of the layer (position in the file).
+	 */
+	const RawLayerDescr &GetLayer(const unsigned int &iLayer) const;
+	/**
+	 * @return Returns NULL if the file contains no training set.
+	 */
+	const RawTrainingSetDescr *GetTrainingSet() const;
+
+	/**
+	 * @return Returns a pointer to the array at iOffset (one of the offsets in the descriptions).
+	 */
+	template <class Type>
+	const Type *GetArray(const uint64_t &iOffset) const {
+		return reinterpret_cast<const Type*>(m_pData + iOffset);
+	}
+
+	const int32_t *GetNeuronIDs(const unsigned int &iLayer) const;
+	const float *GetPositions(const unsigned int &iLayer) const;
+	const uint64_t *GetEdgeOffsets(const unsigned int &iLayer) const;
+	const int32_t *GetDstLayers(const unsigned int &iLayer) const;
+	const int32_t *GetDstNeurons(const unsigned int &iLayer) const;
+	const float *GetWeights(const unsigned int &iLayer) const;
+	const int32_t *GetBiasDstLayers(const unsigned int &iLayer) const;
+	const int32_t *GetBiasDstNeurons(const unsigned int &iLayer) const;
+	const float *GetBiasWeights(const unsigned int &iLayer) const;
+	/**
+	 * @return Returns NULL if the layer has no dense block.
+	 */
+	const float *GetDenseWeights(const unsigned int &iLayer) const;
+	const float *GetDenseBias(const unsigned int &iLayer) const;
+};
+
+}
+
+#endif /* ANNETFILE_H_ */
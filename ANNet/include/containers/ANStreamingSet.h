@@ -0,0 +1,152 @@
+/*
+#-------------------------------------------------------------------------------
+# Copyright (c) 2012 Daniel <dgrat> Frenzel.
+# All rights reserved. This program and the accompanying materials
+# are made available under the terms of the GNU Lesser Public License v2.1
+# which accompanies this distribution, and is available at
+# http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+#
+# Contributors:
+#     Daniel <dgrat> Frenzel - initial API and implementation
+#-------------------------------------------------------------------------------
+*/
+
+#ifndef ANSTREAMINGSET_H_
+#define ANSTREAMINGSET_H_
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <stdint.h>
+#ifndef WIN32
+	#include <pthread.h>
+#endif /*WIN32*/
+
+#include <containers/ANTrainingSet.h>
+
+namespace ANN {
+
+/* magic number and version of the sample file format */
+#define ANSMP_MAGIC 	"ANNETSMP"
+#define ANSMP_VERSION 	1
+
+
+/**
+ * \brief Header at the beginning of a sample file (StreamingSet::ExpToFS()).
+ *
+ * The header is followed by m_iNrOfSamples rows, each row holds the m_iInputSize values of the input
+ * and then the m_iOutputSize values of the output of one sample (floats in the byte order of the machine which wrote the file).
+ */
+struct RawSampleHeader {
+	char 		m_cMagic[8];			// ANSMP_MAGIC, not null terminated
+	uint32_t 	m_iVersion;				// ANSMP_VERSION
+	uint32_t 	m_iInputSize;
+	uint32_t 	m_iOutputSize;			// zero if the samples have no outputs (e.g. for SOMs)
+	uint32_t 	m_iReserved;
+	uint64_t 	m_iNrOfSamples;
+};
+
+/**
+ * \brief Training data which is read from disk chunk by chunk instead of being held in memory.
+ *
+ * The samples are handed out as TrainingSet chunks of a fixed number of samples.
+ * While the net trains on one chunk a background thread already reads the next one into a second buffer (double buffering),
+ * so at most two chunks are in memory. On WIN32 the chunks are read when requested.
+ * With shuffling, the order of the chunks and the order of the samples within a chunk are randomized every epoch.
+ *
+ * Usage: AbsNet::SetTrainingStream() or SOMNet::SetTrainingStream(), or directly:
+ * Rewind() at the beginning of an epoch, then NextChunk() until it returns NULL.
+ *
+ * All samples of a file must have the same size.
+ */
+class StreamingSet {
+private:
+	FILE *m_pFile;
+	RawSampleHeader m_Header;
+
+	unsigned int m_iChunkSize;				// nr. of samples per chunk
+	bool m_bShuffle;
+
+	TrainingSet m_Chunks[2];				// double buffer: one is handed out, the other one gets loaded
+	std::vector<float> m_vRows[2];			// rows read from the file before splitting into inputs and outputs
+	std::vector<unsigned int> m_vOrder[2];	// order of the samples within the chunk being loaded
+	unsigned int m_iCurrent;				// index of the chunk handed out last
+
+	std::vector<unsigned int> m_vChunkOrder;	// order of the chunks in the current epoch
+	unsigned int m_iNextChunk;				// position in m_vChunkOrder of the chunk being loaded
+	unsigned int m_iLoadChunk;				// index of the chunk being loaded (file position)
+	bool m_bLoading;						// a chunk is being loaded into m_Chunks[1-m_iCurrent]
+	bool m_bLoadError;						// reading the chunk being loaded failed
+	bool m_bThread;							// the chunk is loaded by m_Thread, which must get joined
+#ifndef WIN32
+	pthread_t m_Thread;
+#endif /*WIN32*/
+
+	StreamingSet(const StreamingSet &);
+	StreamingSet &operator = (const StreamingSet &);
+
+	/**
+	 * Reads chunk m_iLoadChunk into m_Chunks[1-m_iCurrent]. Runs in the background thread.
+	 */
+	void Load();
+	static void *LoadThread(void *pSet);
+
+	/**
+	 * Starts loading the chunk at position m_iNextChunk in m_vChunkOrder (if any).
+	 */
+	void StartLoading();
+	/**
+	 * Waits until the chunk being loaded is available.
+	 */
+	void WaitLoading();
+
+public:
+	/**
+	 * @param iChunkSize Number of samples which are held in memory at once (per buffer).
+	 * @param bShuffle Randomize the order of the chunks and of the samples within a chunk every epoch.
+	 */
+	StreamingSet(const unsigned int &iChunkSize = 4096, const bool &bShuffle = false);
+	virtual ~StreamingSet();
+
+	/**
+	 * Opens a sample file and checks the header.
+	 * @return Returns false if the file does not exist, is no sample file or has more chunks than fit into an unsigned int.
+	 */
+	bool Open(const std::string &sPath);
+	void Close();
+	bool IsOpen() const;
+
+	/**
+	 * Starts a new epoch: the order of the chunks gets randomized (if shuffling) and the first chunk gets prefetched.
+	 */
+	void Rewind();
+	/**
+	 * Hands out the next chunk of the epoch and starts prefetching the following one.
+	 * The chunk stays valid until the next call of NextChunk(), Rewind() or Close().
+	 * @return Returns NULL at the end of the epoch.
+	 */
+	TrainingSet *NextChunk();
+
+	uint64_t GetNrElements() const;
+	unsigned int GetNrOfChunks() const;
+	unsigned int GetChunkSize() const;
+	unsigned int GetInputSize() const;
+	unsigned int GetOutputSize() const;
+
+	void SetShuffle(const bool &bShuffle);
+	bool GetShuffle() const;
+
+	/**
+	 * Writes the samples of a training set to a sample file.
+	 * Calling it several times with bAppend set allows to build files which do not fit into memory.
+	 * @param sPath Path of the file.
+	 * @param Set All inputs (and all outputs) must have the same size. The set must have as many outputs as inputs or none.
+	 * @param bAppend Append the samples to an existing file with the same sample sizes.
+	 * @return Returns false if the file could not be written or the sizes do not match.
+	 */
+	static bool ExpToFS(const std::string &sPath, const TrainingSet &Set, const bool &bAppend = false);
+};
+
+}
+
+#endif /* ANSTREAMINGSET_H_ */
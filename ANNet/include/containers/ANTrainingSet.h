@@ -16,24 +16,71 @@
 
 #include <utility>
 #include <vector>
+#include <cassert>
+#include <cstddef>
 
 #include <bzlib.h>
 
 namespace ANN {
 
 
+/**
+ * \brief Non-owning, read only view of one sample of a TrainingSet.
+ *
+ * Points directly into the storage of the training set, so it is valid until the set gets changed.
+ * Converts implicitly to std::vector<float> (copy) for code which still needs a vector.
+ */
+class SampleView {
+private:
+	const float *m_pData;
+	unsigned int m_iSize;
+
+public:
+	SampleView(const float *pData = NULL, const unsigned int &iSize = 0) : m_pData(pData), m_iSize(iSize) {}
+
+	const float *GetData() const {
+		return m_pData;
+	}
+	unsigned int size() const {
+		return m_iSize;
+	}
+	bool empty() const {
+		return m_iSize == 0;
+	}
+	const float &operator[] (const unsigned int &iID) const {
+		assert(iID < m_iSize);
+		return m_pData[iID];
+	}
+	const float *begin() const {
+		return m_pData;
+	}
+	const float *end() const {
+		return m_pData + m_iSize;
+	}
+
+	operator std::vector<float>() const {
+		return std::vector<float>(begin(), end() );
+	}
+};
+
+
 /**
  * \brief Storage of simple input/output samples usable for training.
  *
  * Data must get converted to simple float arrays to get used with this storage format.
+ * All inputs are stored one after another in one contiguous row-major buffer, all outputs in a second one.
+ * Sample i covers the entries m_vInputOffsets[i] to m_vInputOffsets[i+1]-1,
+ * so samples may differ in size, but there is no allocation per sample.
  *
  * @author Daniel "dgrat" Frenzel
  */
 
 class TrainingSet {
 private:
-	std::vector<std::vector<float> > m_vInputList;
-	std::vector<std::vector<float> > m_vOutputList;
+	std::vector<float> m_vInputs;
+	std::vector<float> m_vOutputs;
+	std::vector<size_t> m_vInputOffsets;		// nr. of inputs + 1 entries, starts with 0; the buffers may exceed 2^32 values
+	std::vector<size_t> m_vOutputOffsets;		// nr. of outputs + 1 entries, starts with 0
 
 public:
 	TrainingSet();
@@ -41,13 +88,55 @@ public:
 
 	void AddInput(const std::vector<float> &vIn);
 	void AddOutput(const std::vector<float> &vOut);
-	void AddInput(float *pIn, const unsigned int &iSize);
-	void AddOutput(float *pOut, const unsigned int &iSize);
+	void AddInput(const float *pIn, const unsigned int &iSize);
+	void AddOutput(const float *pOut, const unsigned int &iSize);
+
+	/**
+	 * Appends several input samples of the same size at once.
+	 * @param pIn Row-major array of iSamples * iSize values.
+	 */
+	void AddInputs(const float *pIn, const unsigned int &iSamples, const unsigned int &iSize);
+	/**
+	 * Appends several output samples of the same size at once.
+	 * @param pOut Row-major array of iSamples * iSize values.
+	 */
+	void AddOutputs(const float *pOut, const unsigned int &iSamples, const unsigned int &iSize);
+
+	/**
+	 * Reserves memory, so adding the samples afterwards does not reallocate.
+	 * @param iSamples Number of samples.
+	 * @param iInputSize Size of an input sample.
+	 * @param iOutputSize Size of an output sample (zero if the set has no outputs).
+	 */
+	void Reserve(const unsigned int &iSamples, const unsigned int &iInputSize, const unsigned int &iOutputSize = 0);
 
 	unsigned int GetNrElements() const;
+	/**
+	 * @return Returns the number of input samples (like GetNrElements()).
+	 */
+	unsigned int GetNrInputs() const;
+	/**
+	 * @return Returns the number of output samples (may be zero, e.g. for Hopfield nets).
+	 */
+	unsigned int GetNrOutputs() const;
+
+	/**
+	 * @return Returns a view of the input sample iID. It is invalidated by adding samples or Clear().
+	 */
+	SampleView GetInput(const unsigned int &iID) const;
+	/**
+	 * @return Returns a view of the output sample iID. It is invalidated by adding samples or Clear().
+	 */
+	SampleView GetOutput(const unsigned int &iID) const;
 
-	std::vector<float> GetInput(const unsigned int &iID) const;
-	std::vector<float> GetOutput(const unsigned int &iID) const;
+	/**
+	 * @return Returns the buffer with all input samples, one after another (NULL if empty).
+	 */
+	const float *GetInputBuffer() const;
+	/**
+	 * @return Returns the buffer with all output samples, one after another (NULL if empty).
+	 */
+	const float *GetOutputBuffer() const;
 
 	void Clear();
 
@@ -35,6 +35,12 @@ public:
 
 	std::vector<float> GetCurrentInput();
 
+protected:
+	/*
+	 * Mini-batches are not supported on the device yet, samples get propagated one by one
+	 */
+	virtual float TrainBatch(const unsigned int &iStart, const unsigned int &iSize);
+
 public:
 	BPNetGPU();
 	virtual ~BPNetGPU();
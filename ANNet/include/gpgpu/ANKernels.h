@@ -28,11 +28,15 @@ std::vector<float>
 hostBPCalcDelta(const thrust::device_vector<float> &vNeurOut,
 		const std::vector<float> &vTrainOut );
 
-std::vector<thrust::device_vector<float> >
+/*
+ * vNeuronValues: one buffer per layer, resized only if the sizes of the layers changed
+ */
+void
 hostBPPropagateFW(const std::vector<ANN::Matrix> &vEdgeMatrices,
 		const std::vector<ANN::Matrix> &vBiasEdgeMatrices,
 		const std::vector<float> &vInput,
-		const ANN::TransfFunction &function);
+		const ANN::TransfFunction &function,
+		std::vector<thrust::device_vector<float> > &vNeuronValues);
 
 void
 hostBPPropagateBW(std::vector<ANN::Matrix> &dvEdgeMatricesI,
@@ -51,27 +55,66 @@ hostBPPropagateBW(std::vector<ANN::Matrix> &dvEdgeMatricesI,
 float hostGetMax(const thrust::device_vector<float>& vec, unsigned int &ID);
 float hostGetMin(const thrust::device_vector<float>& vec, unsigned int &ID);
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+namespace ANN {
+
+/**
+ * \brief Device memory of the SOM training.
+ *
+ * Holds all inputs of the training set and the buffers of the training cycles.
+ * Everything gets allocated before the first cycle, a cycle itself neither allocates
+ * nor copies vectors between host and device.
+ */
+class SOMWorkspace {
+public:
+	thrust::device_vector<float> m_dvInputs;	// all input samples one after another
+	thrust::device_vector<float> m_dvDist;		// (conscience corrected) distance of each neuron to the current input
+	unsigned int m_iInputs;
+	unsigned int m_iInputSize;
+
+	SOMWorkspace();
+
+	/**
+	 * Uploads all inputs of the training set at once.
+	 * @param InputSet Training set, all inputs must have the size iInputSize.
+	 * @param iInputSize Size of an input sample (nr. of neurons in the input layer).
+	 */
+	void SetInputs(const ANN::TrainingSet &InputSet, const unsigned int &iInputSize);
+	/**
+	 * Allocates the buffers for a map with iNeurons neurons.
+	 */
+	void Resize(const unsigned int &iNeurons);
+	/**
+	 * @return Returns a device pointer to the input sample iID.
+	 */
+	const float *GetInput(const unsigned int &iID) const;
+};
+
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 unsigned int
-hostSOMFindBMNeuronID(thrust::device_vector<float> &ConscienceVector,
+hostSOMFindBMNeuronID(ANN::SOMWorkspace &Workspace,
+		thrust::device_vector<float> &ConscienceVector,
 		const ANN::Matrix &SOMEdgeMatrix,
-		const thrust::device_vector<float> &InputVector,
+		const unsigned int &iInput,
 		const float &fConscienceRate);
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 void
 hostSOMPropagateBW(ANN::Matrix &SOMEdgeMatrix,
 		const ANN::Matrix &SOMPositionMatrix,
-		const thrust::device_vector<float> &dvInputVector,
+		const ANN::SOMWorkspace &Workspace,
+		const unsigned int &iInput,
 		const unsigned int BMUID,
 		const float &fSigmaT,
 		const float &fLearningRate );
 
 void
-hostSOMTraining( thrust::device_vector<float> &ConscienceVector,
+hostSOMTraining( ANN::SOMWorkspace &Workspace,
+		thrust::device_vector<float> &ConscienceVector,
 		ANN::Matrix &SOMEdgeMatrix,
 		const ANN::Matrix &SOMPositionMatrix,
-		const ANN::TrainingSet &InputSet,
 		const unsigned int &iCycles,
 		const float &fSigma0,
 		const float &fLearningRate0,
@@ -25,6 +25,7 @@ class SOMNetGPU : public SOMNet {
 private:
 	ANN::Matrix m_EdgeMat;
 	ANN::Matrix m_PosiMat;
+	ANN::SOMWorkspace m_Workspace;	// training set and buffers on the device
 
 public:
 	SOMNetGPU();
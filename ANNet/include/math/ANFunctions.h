@@ -18,6 +18,19 @@
 #include <stdio.h>
 #include <string.h>
 
+/*
+ * Host backend of thrust (ANN_THRUST_HOST): the code gets compiled without nvcc,
+ * so the CUDA function qualifiers must vanish
+ */
+#if defined(ANN_THRUST_HOST) && !defined(__CUDACC__)
+	#ifndef __host__
+		#define __host__
+	#endif
+	#ifndef __device__
+		#define __device__
+	#endif
+#endif
+
 namespace ANN {
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -100,7 +113,7 @@ fcn_binary_derivate (const float& in, const float& theta) {
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-#ifdef __CUDACC__
+#if defined(__CUDACC__) || defined(ANN_THRUST_HOST)
 	struct tanTransferFcn {
 		__host__ __device__
 		float operator()(const float& fVal, const float& fBias) const {
@@ -0,0 +1,137 @@
+/*
+#-------------------------------------------------------------------------------
+# Copyright (c) 2012 Daniel <dgrat> Frenzel.
+# All rights reserved. This program and the accompanying materials
+# are made available under the terms of the GNU Lesser Public License v2.1
+# which accompanies this distribution, and is available at
+# http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+#
+# Contributors:
+#     Daniel <dgrat> Frenzel - initial API and implementation
+#-------------------------------------------------------------------------------
+*/
+
+#ifndef ANCPUKERNELS_H_
+#define ANCPUKERNELS_H_
+
+#include <stdint.h>
+
+namespace ANN {
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+/** \brief Set of vectorized linear algebra kernels for the CPU.
+  *
+  * All arrays are contiguous floats (or bitsets packed into 64 bit words), no alignment is required.
+  * Every instruction set (scalar, AVX2, AVX-512) provides its own set,
+  * the fastest one supported by the processor gets chosen at runtime.
+  */
+class CPUKernels {
+public:
+	/** \brief The symbolic name of the instruction set. */
+	char * name;
+
+	/** \brief Dot product of two vectors.
+	  *
+	  * \f$ \sum_{i} x_{i} y_{i} \f$
+	  */
+	float (* dot)(const float *pX, const float *pY, const unsigned int &iSize);
+
+	/** \brief Matrix-vector product of a row-major matrix.
+	  *
+	  * \f$ y = A x \f$ with A of size iRows * iCols.
+	  */
+	void (* gemv)(const float *pA, const float *pX, float *pY, const unsigned int &iRows, const unsigned int &iCols);
+
+	/** \brief Scaled vector addition.
+	  *
+	  * \f$ y = y + \alpha x \f$
+	  */
+	void (* axpy)(const float &fAlpha, const float *pX, float *pY, const unsigned int &iSize);
+
+	/** \brief Back propagation step for one row of a weight matrix (outer-product update).
+	  *
+	  * Accumulates the error signal with the weights before the adaption: \f$ e_{i} = e_{i} + \delta w_{i} \f$ \n
+	  * and adapts the weights with weight decay and momentum term: \n
+	  * \f$ \Delta w_{i} = \eta\delta x_{i} - \lambda w_{i} + \alpha m_{i}, \quad m_{i} = \Delta w_{i}, \quad w_{i} = w_{i} + \Delta w_{i} \f$ \n
+	  * fRate is \f$ \eta\delta \f$. Elements with pMask[i] == 0 are not adapted; pMask may be NULL.
+	  */
+	void (* adapt)(const float &fDelta, const float &fRate, const float &fDecay, const float &fMomentum,
+			const float *pX, const float *pMask, float *pW, float *pM, float *pErr, const unsigned int &iSize);
+
+	/** \brief Weight update from an accumulated gradient.
+	  *
+	  * \f$ \Delta w_{i} = \eta g_{i} - \lambda w_{i} + \alpha m_{i}, \quad m_{i} = \Delta w_{i}, \quad w_{i} = w_{i} + \Delta w_{i} \f$ \n
+	  * Elements with pMask[i] == 0 are not adapted; pMask may be NULL.
+	  */
+	void (* update)(const float &fRate, const float &fDecay, const float &fMomentum,
+			const float *pG, const float *pMask, float *pW, float *pM, const unsigned int &iSize);
+
+	/** \brief Matrix-matrix product with the second matrix transposed.
+	  *
+	  * \f$ C = C + A B^{T} \f$ with A of size iM * iK, B of size iN * iK and C of size iM * iN.
+	  * The leading dimensions (row strides) are iLdA, iLdB and iLdC.
+	  */
+	void (* gemm_nt)(const float *pA, const float *pB, float *pC,
+			const unsigned int &iM, const unsigned int &iN, const unsigned int &iK,
+			const unsigned int &iLdA, const unsigned int &iLdB, const unsigned int &iLdC);
+
+	/** \brief Matrix-matrix product.
+	  *
+	  * \f$ C = C + A B \f$ with A of size iM * iK, B of size iK * iN and C of size iM * iN.
+	  */
+	void (* gemm_nn)(const float *pA, const float *pB, float *pC,
+			const unsigned int &iM, const unsigned int &iN, const unsigned int &iK,
+			const unsigned int &iLdA, const unsigned int &iLdB, const unsigned int &iLdC);
+
+	/** \brief Matrix-matrix product with the first matrix transposed.
+	  *
+	  * \f$ C = C + A^{T} B \f$ with A of size iK * iM, B of size iK * iN and C of size iM * iN.
+	  */
+	void (* gemm_tn)(const float *pA, const float *pB, float *pC,
+			const unsigned int &iM, const unsigned int &iN, const unsigned int &iK,
+			const unsigned int &iLdA, const unsigned int &iLdB, const unsigned int &iLdC);
+
+	/** \brief Hamming distance of two bitsets.
+	  *
+	  * Number of set bits of \f$ x \oplus y \f$, whereas both bitsets consist of iWords words.
+	  */
+	unsigned int (* hamming)(const uint64_t *pX, const uint64_t *pY, const unsigned int &iWords);
+
+	/** \brief Sum of the elements selected by a bitset.
+	  *
+	  * \f$ \sum_{i} b_{i} x_{i} \f$, whereas \f$ b_{i} \f$ is bit i%64 of the word pMask[i/64].
+	  */
+	int64_t (* masked_sum)(const uint64_t *pMask, const int32_t *pX, const unsigned int &iSize);
+};
+
+/** \class Kernels
+ ** \brief List of kernel sets available on this machine.
+ */
+class Kernels {
+public:
+	/** \brief Returns the fastest kernel set the processor supports.
+	  *
+	  * The processor features get checked (CPUID) once at the first call.
+	  * The environment variable ANNET_KERNELS ("scalar", "avx2", "avx512") overrides the choice,
+	  * if the processor supports the requested set.
+	  */
+	static const CPUKernels* GetKernels();
+
+	/** \brief Resolve a kernel set by symbolic name.
+	  *
+	  * \param  name The name, as given in the kernel structure.
+	  * \return NULL if unknown or not supported by the processor, pointer to structure on success.
+	  */
+	static const CPUKernels* ResolveKernelsByName(const char *name);
+
+	/** \brief Portable kernels, used if no vector extension is available. */
+	static const CPUKernels fcn_scalar;
+	/** \brief Kernels for processors with AVX2 and FMA (Haswell and later). */
+	static const CPUKernels fcn_avx2;
+	/** \brief Kernels for processors with AVX-512F (Skylake-SP and later). */
+	static const CPUKernels fcn_avx512;
+};
+
+};
+
+#endif /* ANCPUKERNELS_H_ */
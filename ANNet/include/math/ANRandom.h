@@ -17,6 +17,7 @@
 #include <cstdlib>
 #include <cmath>
 #include <ctime>
+#include <stdint.h>
 
 
 #ifdef __linux__
@@ -36,6 +37,7 @@ namespace ANN {
  */
 inline float RandFloat(float begin, float end);
 inline int RandInt(int x,int y);
+inline uint32_t RandXorShift(uint32_t &iState);
 
 inline void InitTime();
 #define INIT_TIME InitTime();
@@ -78,6 +80,17 @@ int RandInt(int x,int y) {
 	return rand()%(y-x+1)+x;
 }
 
+/*
+ * Xorshift generator working on its own state, so it can be used by several threads (unlike rand()).
+ * The state must not be zero.
+ */
+uint32_t RandXorShift(uint32_t &iState) {
+	iState ^= iState << 13;
+	iState ^= iState >> 17;
+	iState ^= iState << 5;
+	return iState;
+}
+
 }
 
 #endif /* RANDOMIZER_H_ */
@@ -0,0 +1,129 @@
+/*
+ * BPNetAllocs.cpp
+ *
+ *  Created on: 17.10.2026
+ *
+ *  Counts the heap allocations and the time of the forward and backward pass of a back propagation net.
+ *  All of them should be zero in steady state.
+ */
+
+#include <ANNet>
+#include <ANContainers>
+#include <ANMath>
+
+#include <ctime>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#ifdef _MSC_VER
+  #include <intrin.h>
+#endif
+
+static unsigned long g_iAllocs = 0;
+
+/*
+ * The examples are built without OpenMP flags, so "#pragma omp atomic" would be ignored.
+ * The counter gets incremented atomically with the builtin of the compiler instead.
+ */
+static void *Allocate(size_t iSize) {
+#ifdef _MSC_VER
+  _InterlockedIncrement(reinterpret_cast<volatile long*>(&g_iAllocs) );
+#else
+  __sync_fetch_and_add(&g_iAllocs, 1);
+#endif
+  void *p = malloc(iSize);
+  if(p == NULL)
+    throw std::bad_alloc();
+  return p;
+}
+
+void *operator new(size_t iSize) {
+  return Allocate(iSize);
+}
+
+void *operator new[](size_t iSize) {
+  return Allocate(iSize);
+}
+
+void operator delete(void *p) throw() {
+  free(p);
+}
+
+void operator delete[](void *p) throw() {
+  free(p);
+}
+
+// sized deallocation (C++14)
+void operator delete(void *p, size_t) throw() {
+  free(p);
+}
+
+void operator delete[](void *p, size_t) throw() {
+  free(p);
+}
+
+int main(int argc, char *argv[]) {
+  const unsigned int iInputs = 64;
+  const unsigned int iHidden = 128;
+  const unsigned int iOutputs = 16;
+  const unsigned int iRuns = 1000;
+
+  ANN::BPNet net;
+  ANN::BPLayer *pLayer1 = new ANN::BPLayer(iInputs, ANN::ANLayerInput);
+  pLayer1->AddFlag(ANN::ANBiasNeuron);
+  ANN::BPLayer *pLayer2 = new ANN::BPLayer(iHidden, ANN::ANLayerHidden);
+  pLayer2->AddFlag(ANN::ANBiasNeuron);
+  ANN::BPLayer *pLayer3 = new ANN::BPLayer(iOutputs, ANN::ANLayerOutput);
+
+  pLayer1->ConnectLayer(pLayer2, true, net.GetEdgeArena());
+  pLayer2->ConnectLayer(pLayer3, true, net.GetEdgeArena());
+
+  net.AddLayer(pLayer1);
+  net.AddLayer(pLayer2);
+  net.AddLayer(pLayer3);
+
+  std::vector<float> vInput(iInputs, 0.5f);
+  std::vector<float> vOutput(iOutputs, 0.25f);
+  std::vector<float> vResult(iRuns*iOutputs);
+  std::vector<float> vBatch(iRuns*iInputs, 0.5f);
+
+  for(int iMode = 0; iMode < 2; iMode++) {
+    if(iMode == 1) {
+      net.Compile();
+    }
+    std::cout<<(iMode == 0 ? "graph mode" : "compiled mode")<<std::endl;
+
+    // warm up (thread pool, buffers)
+    net.SetInput(vInput);
+    net.SetOutput(vOutput);
+    net.PropagateBW();
+    net.PredictBatch(&vBatch[0], &vResult[0], iRuns);
+
+    unsigned long iAllocs = g_iAllocs;
+    clock_t start = clock();
+    for(unsigned int i = 0; i < iRuns; i++) {
+      net.SetInput(vInput);
+      net.PropagateFW();
+    }
+    std::cout<<"  forward pass:  "<<(float)(g_iAllocs-iAllocs)/iRuns<<" allocations, "
+             <<(float)(clock()-start)/CLOCKS_PER_SEC/iRuns*1000000.f<<" us (cpu)"<<std::endl;
+
+    iAllocs = g_iAllocs;
+    start = clock();
+    for(unsigned int i = 0; i < iRuns; i++) {
+      net.SetInput(vInput);
+      net.SetOutput(vOutput);
+      net.PropagateBW();
+    }
+    std::cout<<"  training step: "<<(float)(g_iAllocs-iAllocs)/iRuns<<" allocations, "
+             <<(float)(clock()-start)/CLOCKS_PER_SEC/iRuns*1000000.f<<" us (cpu)"<<std::endl;
+
+    iAllocs = g_iAllocs;
+    start = clock();
+    net.PredictBatch(&vBatch[0], &vResult[0], iRuns);
+    std::cout<<"  PredictBatch:  "<<(float)(g_iAllocs-iAllocs)/iRuns<<" allocations, "
+             <<(float)(clock()-start)/CLOCKS_PER_SEC/iRuns*1000000.f<<" us (cpu) per sample"<<std::endl;
+  }
+
+  return 0;
+}
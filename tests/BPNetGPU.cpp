@@ -0,0 +1,120 @@
+/*
+ * BPNetGPU.cpp
+ *
+ *  Created on: 17.10.2026
+ */
+
+#include <ANNet>
+#include <ANContainers>
+#include <ANMath>
+#include <ANGPGPU>
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+
+static const char *pPath = "BPNetGPU.net";
+
+/*
+ * Largest difference of the outputs of both nets over all samples of the training set
+ */
+static float MaxDiff(ANN::BPNet &cpu, ANN::BPNetGPU &gpu, ANN::TrainingSet &set) {
+	float fMax = 0.f;
+	for(unsigned int i = 0; i < set.GetNrElements(); i++) {
+		cpu.SetInput(set.GetInput(i) );
+		cpu.PropagateFW();
+		gpu.SetInput(set.GetInput(i) );
+		gpu.PropagateFW();
+
+		std::vector<float> vCPU = cpu.GetOutput();
+		std::vector<float> vGPU = gpu.GetOutput();
+		for(unsigned int j = 0; j < vCPU.size(); j++) {
+			fMax = std::max(fMax, std::fabs(vCPU[j] - vGPU[j]) );
+		}
+	}
+	return fMax;
+}
+
+int main() {
+	/*
+	 * Both nets get loaded from the same file:
+	 * only nets created from a ConTable register their bias edges (AbsNeuron::SetBiasEdge()),
+	 * which is the bias convention of the device
+	 */
+	{
+		ANN::BPNet net;
+		// the constructor of the net seeds with the time
+		srand(1);
+		ANN::BPLayer *pInput 	= new ANN::BPLayer(3, ANN::ANLayerInput | ANN::ANBiasNeuron);
+		ANN::BPLayer *pHidden 	= new ANN::BPLayer(16, ANN::ANLayerHidden | ANN::ANBiasNeuron);
+		ANN::BPLayer *pOutput 	= new ANN::BPLayer(4, ANN::ANLayerOutput);
+		pInput->ConnectLayer(pHidden, true, net.GetEdgeArena() );
+		pHidden->ConnectLayer(pOutput, true, net.GetEdgeArena() );
+		net.AddLayer(pInput);
+		net.AddLayer(pHidden);
+		net.AddLayer(pOutput);
+		net.ExpToFS(pPath);
+	}
+
+	ANN::TrainingSet set;
+	for(unsigned int i = 0; i < 8; i++) {
+		float fIn[3];
+		float fOut[4];
+		for(unsigned int j = 0; j < 3; j++) {
+			fIn[j] = static_cast<float>( (i >> j) & 1);
+		}
+		for(unsigned int j = 0; j < 4; j++) {
+			fOut[j] = rand() % 2 ? 0.8f : 0.2f;
+		}
+		set.AddInput(fIn, 3);
+		set.AddOutput(fOut, 4);
+	}
+
+	ANN::BPNet cpu;
+	ANN::BPNetGPU gpu;
+	ANN::BPNetGPU untrained;
+	cpu.ImpFromFS(pPath);
+	gpu.ImpFromFS(pPath);
+	untrained.ImpFromFS(pPath);
+
+	float fDiff = MaxDiff(cpu, gpu, set);
+	if(fDiff > 1.0e-5f) {
+		std::cout<<"forward pass: outputs differ by "<<fDiff<<std::endl;
+		return 1;
+	}
+
+	// the bias neurons of the CPU keep their default learning rate (0.01), so both nets use it
+	cpu.SetLearningRate(0.01f);
+	cpu.SetMomentum(0.f);
+	cpu.SetWeightDecay(0.f);
+	cpu.SetTrainingSet(set);
+	gpu.SetLearningRate(0.01f);
+	gpu.SetMomentum(0.f);
+	gpu.SetWeightDecay(0.f);
+	gpu.SetTrainingSet(set);
+
+	float fProgress = 0.f;
+	std::vector<float> vErrCPU = cpu.TrainFromData(100, 0.f, false, fProgress);
+	std::vector<float> vErrGPU = gpu.TrainFromData(100, 0.f, false, fProgress);
+	if(vErrCPU.back() >= vErrCPU.front() || vErrGPU.back() >= vErrGPU.front() ) {
+		std::cout<<"training: error did not decrease (cpu "<<vErrCPU.front()<<" -> "<<vErrCPU.back()
+				<<", gpu "<<vErrGPU.front()<<" -> "<<vErrGPU.back()<<")"<<std::endl;
+		return 1;
+	}
+
+	/*
+	 * The device sums the deltas in another order and adapts the bias edges separately, the results stay close only:
+	 * both nets have to differ much less from each other than from the untrained net
+	 */
+	fDiff = MaxDiff(cpu, gpu, set);
+	float fMoved = MaxDiff(cpu, untrained, set);
+	if(fDiff > 0.1f * fMoved) {
+		std::cout<<"training: outputs differ by "<<fDiff<<", training changed them by "<<fMoved<<std::endl;
+		return 1;
+	}
+
+	std::cout<<"BPNetGPU trains like BPNet: OK"<<std::endl;
+	return 0;
+}
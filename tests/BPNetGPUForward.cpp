@@ -0,0 +1,125 @@
+/*
+ * BPNetGPUForward.cpp
+ *
+ *  Created on: 17.10.2026
+ */
+
+#include <ANNet>
+#include <ANContainers>
+#include <ANMath>
+#include <ANGPGPU>
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+
+static const char *pPath = "BPNetGPUForward.net";
+
+/*
+ * Writes a net with the given sizes of the layers, all layers except the output layer with a bias neuron if bBias is set.
+ * Both nets get loaded from this file, so they share the bias convention of the device (AbsNeuron::SetBiasEdge()).
+ */
+static void CreateNet(const std::vector<unsigned int> &vSizes, const bool &bBias) {
+	ANN::BPNet net;
+	// the constructor of the net seeds with the time
+	srand(static_cast<unsigned int>(vSizes.size() ) );
+	std::vector<ANN::BPLayer*> vLayers;
+	for(unsigned int i = 0; i < vSizes.size(); i++) {
+		ANN::LayerTypeFlag fType = ANN::ANLayerHidden;
+		if(i == 0) {
+			fType = ANN::ANLayerInput;
+		}
+		else if(i == vSizes.size()-1) {
+			fType = ANN::ANLayerOutput;
+		}
+		if(bBias && i < vSizes.size()-1) {
+			fType |= ANN::ANBiasNeuron;
+		}
+		vLayers.push_back(new ANN::BPLayer(vSizes[i], fType) );
+	}
+	for(unsigned int i = 0; i+1 < vLayers.size(); i++) {
+		vLayers[i]->ConnectLayer(vLayers[i+1], true, net.GetEdgeArena() );
+	}
+	for(unsigned int i = 0; i < vLayers.size(); i++) {
+		net.AddLayer(vLayers[i]);
+	}
+	net.ExpToFS(pPath);
+}
+
+/*
+ * Propagates iSamples random inputs through both nets, every sample reuses the buffers of the last one
+ */
+static bool Compare(ANN::BPNet &cpu, ANN::BPNetGPU &gpu, const unsigned int &iSamples, const char *pStep) {
+	const unsigned int iInputs = cpu.GetIPLayer()->GetNeurons().size();
+	std::vector<float> vInput(iInputs);
+
+	for(unsigned int i = 0; i < iSamples; i++) {
+		for(unsigned int j = 0; j < iInputs; j++) {
+			vInput[j] = rand() / static_cast<float>(RAND_MAX) * 2.f - 1.f;
+		}
+		cpu.SetInput(vInput);
+		cpu.PropagateFW();
+		gpu.SetInput(vInput);
+		gpu.PropagateFW();
+
+		std::vector<float> vCPU = cpu.GetOutput();
+		std::vector<float> vGPU = gpu.GetOutput();
+		if(vCPU.size() != vGPU.size() ) {
+			std::cout<<pStep<<": "<<vGPU.size()<<" outputs instead of "<<vCPU.size()<<std::endl;
+			return false;
+		}
+		for(unsigned int j = 0; j < vCPU.size(); j++) {
+			if(std::fabs(vCPU[j] - vGPU[j]) > 1.0e-5f) {
+				std::cout<<pStep<<": sample "<<i<<", output "<<j<<": "<<vGPU[j]<<" instead of "<<vCPU[j]<<std::endl;
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+int main() {
+	const ANN::TransfFunction *pFunctions[] = {
+		&ANN::Functions::fcn_log,
+		&ANN::Functions::fcn_tanh,
+		&ANN::Functions::fcn_linear
+	};
+
+	std::vector<unsigned int> vSmall;
+	vSmall.push_back(3);
+	vSmall.push_back(16);
+	vSmall.push_back(4);
+
+	std::vector<unsigned int> vDeep;
+	vDeep.push_back(5);
+	vDeep.push_back(40);
+	vDeep.push_back(20);
+	vDeep.push_back(7);
+
+	// the same device net gets reloaded with other sizes, the buffers have to follow
+	ANN::BPNetGPU gpu;
+	for(unsigned int i = 0; i < 2; i++) {
+		const std::vector<unsigned int> &vSizes = i == 0 ? vSmall : vDeep;
+		for(unsigned int iBias = 0; iBias < 2; iBias++) {
+			// no net may be constructed after CreateNet(), the inputs follow the seed of the weights
+			ANN::BPNet cpu;
+			CreateNet(vSizes, iBias == 1);
+			cpu.ImpFromFS(pPath);
+			gpu.ImpFromFS(pPath);
+
+			for(unsigned int j = 0; j < sizeof(pFunctions)/sizeof(pFunctions[0]); j++) {
+				cpu.SetTransfFunction(pFunctions[j]);
+				gpu.SetTransfFunction(pFunctions[j]);
+				if(!Compare(cpu, gpu, 20, pFunctions[j]->name) ) {
+					std::cout<<vSizes.size()<<" layers, bias "<<iBias<<std::endl;
+					return 1;
+				}
+			}
+		}
+	}
+
+	std::cout<<"BPNetGPU forward pass like BPNet: OK"<<std::endl;
+	return 0;
+}
@@ -0,0 +1,185 @@
+/*
+ * BPNetMapped.cpp
+ *
+ *  Created on: 17.10.2026
+ */
+
+#include <ANNet>
+#include <ANContainers>
+#include <ANMath>
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+
+static const char *pPath 		= "BPNetMapped.net";
+static const char *pImported 	= "BPNetMappedImported.net";
+
+/*
+ * Largest difference of the outputs of both nets for iSamples random inputs, one by one and with PredictBatch()
+ */
+static float MaxDiff(ANN::BPNet &graph, ANN::BPNet &mapped, const unsigned int &iSamples) {
+	const unsigned int iInputs 	= graph.GetIPLayer()->GetNeurons().size();
+	const unsigned int iOutputs = graph.GetOPLayer()->GetNeurons().size();
+	std::vector<float> vInputs(iSamples*iInputs);
+	for(unsigned int i = 0; i < vInputs.size(); i++) {
+		vInputs[i] = rand() / static_cast<float>(RAND_MAX) * 2.f - 1.f;
+	}
+
+	float fMax = 0.f;
+	for(unsigned int i = 0; i < iSamples; i++) {
+		std::vector<float> vInput(vInputs.begin() + i*iInputs, vInputs.begin() + (i+1)*iInputs);
+		graph.SetInput(vInput);
+		graph.PropagateFW();
+		mapped.SetInput(vInput);
+		mapped.PropagateFW();
+
+		std::vector<float> vGraph 	= graph.GetOutput();
+		std::vector<float> vMapped 	= mapped.GetOutput();
+		for(unsigned int j = 0; j < iOutputs; j++) {
+			fMax = std::max(fMax, std::fabs(vGraph[j] - vMapped[j]) );
+		}
+	}
+
+	std::vector<float> vGraph(iSamples*iOutputs);
+	std::vector<float> vMapped(iSamples*iOutputs);
+	graph.PredictBatch(&vInputs[0], &vGraph[0], iSamples);
+	mapped.PredictBatch(&vInputs[0], &vMapped[0], iSamples);
+	for(unsigned int i = 0; i < vGraph.size(); i++) {
+		fMax = std::max(fMax, std::fabs(vGraph[i] - vMapped[i]) );
+	}
+	return fMax;
+}
+
+/*
+ * The weights of the mapped net must be the dense blocks of the file, aligned for the kernels
+ */
+static bool CheckBlocks(const ANN::NetFile &File) {
+	for(unsigned int i = 1; i < File.GetHeader().m_iNrOfLayers; i++) {
+		const ANN::RawLayerDescr &Descr = File.GetLayer(i);
+		if(File.GetDenseWeights(i) == NULL || Descr.m_iDenseWeights % ANRAW_ALIGN != 0 || Descr.m_iDenseBias % ANRAW_ALIGN != 0) {
+			std::cout<<"layer "<<i<<" has no aligned dense block"<<std::endl;
+			return false;
+		}
+		if(Descr.m_iDenseInputs != File.GetLayer(i-1).m_iNrOfNeurons) {
+			std::cout<<"layer "<<i<<": dense block has "<<Descr.m_iDenseInputs<<" inputs"<<std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+int main() {
+	{
+		ANN::BPNet net;
+		// the constructor of the net seeds with the time
+		srand(1);
+		ANN::BPLayer *pInput 	= new ANN::BPLayer(5, ANN::ANLayerInput | ANN::ANBiasNeuron);
+		ANN::BPLayer *pHidden 	= new ANN::BPLayer(24, ANN::ANLayerHidden | ANN::ANBiasNeuron);
+		ANN::BPLayer *pOutput 	= new ANN::BPLayer(3, ANN::ANLayerOutput);
+		pInput->ConnectLayer(pHidden, true, net.GetEdgeArena() );
+		pHidden->ConnectLayer(pOutput, true, net.GetEdgeArena() );
+		net.AddLayer(pInput);
+		net.AddLayer(pHidden);
+		net.AddLayer(pOutput);
+		net.ExpToFS(pPath, ANN::ANFormatRaw);
+	}
+	// nets created from a ConTable use the bias edges as threshold (AbsNeuron::SetBiasEdge())
+	{
+		ANN::BPNet net;
+		net.ImpFromFS(pPath);
+		net.ExpToFS(pImported, ANN::ANFormatRaw);
+	}
+
+	ANN::TrainingSet set;
+	for(unsigned int i = 0; i < 8; i++) {
+		float fIn[5];
+		float fOut[3];
+		for(unsigned int j = 0; j < 5; j++) {
+			fIn[j] = static_cast<float>( (i >> (j%3) ) & 1);
+		}
+		for(unsigned int j = 0; j < 3; j++) {
+			fOut[j] = rand() % 2 ? 0.8f : 0.2f;
+		}
+		set.AddInput(fIn, 5);
+		set.AddOutput(fOut, 3);
+	}
+
+	ANN::NetFile File;
+	if(!File.Open(pImported) || !CheckBlocks(File) ) {
+		std::cout<<pImported<<": no valid dense blocks"<<std::endl;
+		return 1;
+	}
+
+	ANN::BPNet graph;
+	ANN::BPNet mapped;
+	graph.ImpFromFS(pImported);
+	if(!mapped.Compile(File) || !mapped.IsMapped() ) {
+		std::cout<<"file could not be mapped"<<std::endl;
+		return 1;
+	}
+	srand(2);
+
+	const ANN::TransfFunction *pFunctions[] = {
+		&ANN::Functions::fcn_log,
+		&ANN::Functions::fcn_tanh
+	};
+	for(unsigned int i = 0; i < sizeof(pFunctions)/sizeof(pFunctions[0]); i++) {
+		graph.SetTransfFunction(pFunctions[i]);
+		mapped.SetTransfFunction(pFunctions[i]);
+		float fDiff = MaxDiff(graph, mapped, 100);
+		if(fDiff > 1.0e-5f) {
+			std::cout<<pFunctions[i]->name<<": mapped outputs differ by "<<fDiff<<std::endl;
+			return 1;
+		}
+	}
+
+	// training switches to graph mode, with the same edges like the import
+	graph.SetTrainingSet(set);
+	mapped.SetTrainingSet(set);
+	float fProgress = 0.f;
+	srand(3);
+	std::vector<float> vErrGraph = graph.TrainFromData(20, 0.f, false, fProgress);
+	srand(3);
+	std::vector<float> vErrMapped = mapped.TrainFromData(20, 0.f, false, fProgress);
+	if(mapped.IsMapped() || vErrMapped.back() != vErrGraph.back() ) {
+		std::cout<<"training: error "<<vErrMapped.back()<<" instead of "<<vErrGraph.back()<<std::endl;
+		return 1;
+	}
+
+	// a file of a net which was not created from a ConTable maps like it gets imported
+	ANN::NetFile Plain;
+	ANN::BPNet plain;
+	if(!Plain.Open(pPath) || !CheckBlocks(Plain) || !plain.Compile(Plain) ) {
+		std::cout<<pPath<<": file could not be mapped"<<std::endl;
+		return 1;
+	}
+	graph.ImpFromFS(pPath);
+	float fDiff = MaxDiff(graph, plain, 100);
+	if(fDiff > 1.0e-5f) {
+		std::cout<<pPath<<": mapped outputs differ by "<<fDiff<<std::endl;
+		return 1;
+	}
+
+	// a training step by hand leaves the mapping with the error deltas of SetOutput()
+	std::vector<float> vInput(5, 0.5f);
+	std::vector<float> vOutput(3, 0.8f);
+	graph.SetInput(vInput);
+	graph.PropagateFW();
+	graph.SetOutput(vOutput);
+	graph.PropagateBW();
+	plain.SetInput(vInput);
+	plain.PropagateFW();
+	plain.SetOutput(vOutput);
+	plain.PropagateBW();
+	fDiff = MaxDiff(graph, plain, 100);
+	if(plain.IsMapped() || fDiff > 1.0e-5f) {
+		std::cout<<"training step: outputs differ by "<<fDiff<<std::endl;
+		return 1;
+	}
+
+	std::cout<<"BPNet propagates from the mapped file: OK"<<std::endl;
+	return 0;
+}
@@ -0,0 +1,143 @@
+/*
+ * HFNetStore.cpp
+ *
+ *  Created on: 17.10.2026
+ */
+
+#include <ANNet>
+#include <ANContainers>
+#include <ANMath>
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+
+static const unsigned int iLength = 256;	// 16x16 neurons
+
+/*
+ * Number of neurons recalling pattern vPattern from a probe with some flipped values
+ */
+static unsigned int Recall(ANN::HFNet &net, const std::vector<float> &vPattern) {
+	std::vector<float> vProbe(vPattern);
+	for(unsigned int i = 0; i < 20; i++) {
+		vProbe[rand() % iLength] *= -1.f;
+	}
+	net.SetInput(vProbe);
+	net.Recall();
+
+	std::vector<float> vOut = net.GetOutput();
+	unsigned int iCorrect = 0;
+	for(unsigned int i = 0; i < iLength; i++) {
+		iCorrect += (vOut[i] == vPattern[i]);
+	}
+	return iCorrect;
+}
+
+static bool RecallAll(ANN::HFNet &net, const std::vector<std::vector<float> > &vPatterns, const char *pStep) {
+	for(unsigned int i = 0; i < vPatterns.size(); i++) {
+		unsigned int iCorrect = Recall(net, vPatterns[i]);
+		if(iCorrect != iLength) {
+			std::cout<<pStep<<": pattern "<<i<<" recalled "<<iCorrect<<"/"<<iLength<<std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+/*
+ * Compares the edges with the hebbian weights of vPatterns
+ */
+static bool CheckWeights(ANN::HFNet &net, const std::vector<std::vector<float> > &vPatterns, const char *pStep) {
+	const ANN::AbsLayer *pLayer = net.GetIPLayer();
+	const std::vector<ANN::AbsNeuron *> &vNeurons = pLayer->GetNeurons();
+	for(unsigned int i = 0; i < iLength; i++) {
+		ANN::AbsNeuron *pNeuron = vNeurons[i];
+		for(unsigned int j = 0; j < pNeuron->GetConsI().size(); j++) {
+			ANN::Edge *pEdge 	= pNeuron->GetConI(j);
+			unsigned int iSrc 	= pEdge->GetDestinationID(pNeuron);
+			float fExpected 	= 0.f;
+			for(unsigned int k = 0; k < vPatterns.size(); k++) {
+				fExpected += vPatterns[k][pNeuron->GetID()] * vPatterns[k][iSrc];
+			}
+			if(pEdge->GetValue() != fExpected) {
+				std::cout<<pStep<<": weight "<<pNeuron->GetID()<<"/"<<iSrc<<" is "<<pEdge->GetValue()<<", expected "<<fExpected<<std::endl;
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+int main(int argc, char *argv[]) {
+	srand(1);
+	std::vector<std::vector<float> > vPatterns(8, std::vector<float>(iLength) );
+	for(unsigned int i = 0; i < vPatterns.size(); i++) {
+		for(unsigned int j = 0; j < iLength; j++) {
+			vPatterns[i][j] = (rand() % 2) ? 1.f : -1.f;
+		}
+	}
+	// 2 patterns in the training set, 6 get stored
+	std::vector<std::vector<float> > vTrained(vPatterns.begin(), vPatterns.begin()+2);
+	std::vector<std::vector<float> > vStored(vPatterns.begin()+2, vPatterns.end() );
+
+	ANN::TrainingSet Set;
+	for(unsigned int i = 0; i < vTrained.size(); i++) {
+		Set.AddInput(vTrained[i]);
+	}
+
+	ANN::HFNet net(16, 16);
+	for(unsigned int i = 0; i < vStored.size(); i++) {
+		net.StorePattern(&vStored[i][0]);
+	}
+	if(!RecallAll(net, vStored, "store") ) {
+		return 1;
+	}
+
+	// store -> compile -> recall
+	if(!net.Compile() ) {
+		std::cout<<"compile: refused"<<std::endl;
+		return 1;
+	}
+	if(!RecallAll(net, vStored, "compile") ) {
+		return 1;
+	}
+
+	// retraining keeps the stored patterns
+	net.SetTrainingSet(Set);
+	net.PropagateBW();
+	if(!RecallAll(net, vPatterns, "compiled retrain") ) {
+		return 1;
+	}
+	net.Decompile();
+	if(!CheckWeights(net, vPatterns, "decompile") ) {
+		return 1;
+	}
+	net.PropagateBW();
+	if(!CheckWeights(net, vPatterns, "retrain") || !RecallAll(net, vPatterns, "retrain") ) {
+		return 1;
+	}
+
+	// a forgotten pattern does not come back with the next training
+	if(!net.ForgetPattern(&vStored.back()[0]) ) {
+		std::cout<<"forget: pattern not found"<<std::endl;
+		return 1;
+	}
+	vPatterns.pop_back();
+	net.PropagateBW();
+	if(!CheckWeights(net, vPatterns, "forget") ) {
+		return 1;
+	}
+
+	// export of a compiled net
+	net.Compile();
+	net.ExpToFS("HFNetStore.net");
+	ANN::HFNet imported;
+	imported.ImpFromFS("HFNetStore.net");
+	if(!CheckWeights(imported, vPatterns, "export") || !RecallAll(imported, vPatterns, "export") ) {
+		return 1;
+	}
+
+	std::cout<<"Store, compile and recall: OK"<<std::endl;
+	return 0;
+}
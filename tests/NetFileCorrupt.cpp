@@ -0,0 +1,83 @@
+/*
+ * NetFileCorrupt.cpp
+ *
+ *  Created on: 17.10.2026
+ */
+
+#include <ANNet>
+#include <ANContainers>
+
+#include <cstdio>
+#include <cstddef>
+#include <iostream>
+
+
+static const char *pPath = "NetFileCorrupt.net";
+
+/*
+ * Overwrites the int32_t at iOffset of the raw file
+ */
+static void Patch(const uint64_t &iOffset, const int32_t &iValue) {
+	FILE *fout = fopen(pPath, "r+b");
+	fseek(fout, iOffset, SEEK_SET);
+	fwrite(&iValue, sizeof(int32_t), 1, fout);
+	fclose(fout);
+}
+
+/*
+ * A raw file with the destination at iOffset set to iValue must be refused by NetFile::Open()
+ */
+static bool Refused(ANN::BPNet &net, const uint64_t &iOffset, const int32_t &iValue, const char *pStep) {
+	net.ExpToFS(pPath, ANN::ANFormatRaw);
+	Patch(iOffset, iValue);
+
+	ANN::NetFile File;
+	if(File.Open(pPath) ) {
+		std::cout<<pStep<<": corrupt file was opened"<<std::endl;
+		return false;
+	}
+	return true;
+}
+
+int main() {
+	ANN::BPNet net;
+	ANN::BPLayer *pInput 	= new ANN::BPLayer(3, ANN::ANLayerInput | ANN::ANBiasNeuron);
+	ANN::BPLayer *pHidden 	= new ANN::BPLayer(4, ANN::ANLayerHidden | ANN::ANBiasNeuron);
+	ANN::BPLayer *pOutput 	= new ANN::BPLayer(2, ANN::ANLayerOutput);
+	pInput->ConnectLayer(pHidden, true);
+	pHidden->ConnectLayer(pOutput, true);
+	net.AddLayer(pInput);
+	net.AddLayer(pHidden);
+	net.AddLayer(pOutput);
+
+	net.ExpToFS(pPath, ANN::ANFormatRaw);
+	ANN::NetFile File;
+	if(!File.Open(pPath) ) {
+		std::cout<<"valid file was refused"<<std::endl;
+		return 1;
+	}
+	const ANN::RawLayerDescr Input 	= File.GetLayer(0);
+	const ANN::RawLayerDescr Hidden = File.GetLayer(1);
+	const uint64_t iHiddenDescr 	= File.GetHeader().m_iLayerTable + sizeof(ANN::RawLayerDescr);
+	File.Close();
+
+	if(	!Refused(net, Input.m_iDstNeurons, 0x40000000, "destination neuron") ||
+		!Refused(net, Input.m_iDstNeurons, -1, "negative destination neuron") ||
+		!Refused(net, Hidden.m_iDstNeurons, 4, "neuron of the wrong layer") ||
+		!Refused(net, Input.m_iDstLayers, 3, "destination layer") ||
+		!Refused(net, Input.m_iBiasDstNeurons, 0x40000000, "bias destination neuron") ||
+		!Refused(net, Input.m_iBiasDstLayers, -2, "bias destination layer") ||
+		!Refused(net, Input.m_iNeuronIDs, 3, "neuron ID") ||
+		!Refused(net, iHiddenDescr + offsetof(ANN::RawLayerDescr, m_iDenseInputs), 4, "width of the dense block") ||
+		!Refused(net, iHiddenDescr + offsetof(ANN::RawLayerDescr, m_iDenseWeights), static_cast<int32_t>(Hidden.m_iDenseWeights) + 4, "unaligned dense block") )
+	{
+		return 1;
+	}
+
+	// the import has to survive it as well
+	ANN::BPNet imported;
+	imported.ImpFromFS(pPath);
+
+	std::cout<<"Corrupt raw files refused: OK"<<std::endl;
+	return 0;
+}
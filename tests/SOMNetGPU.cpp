@@ -0,0 +1,59 @@
+/*
+ * SOMNetGPU.cpp
+ *
+ *  Created on: 17.10.2026
+ */
+
+#include <ANNet>
+#include <ANContainers>
+#include <ANMath>
+#include <ANGPGPU>
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+
+int main() {
+	ANN::SOMNet cpu;
+	// the constructor of the net seeds with the time
+	srand(3);
+
+	ANN::TrainingSet set;
+	for(unsigned int i = 0; i < 20; i++) {
+		float fIn[3];
+		for(unsigned int j = 0; j < 3; j++) {
+			fIn[j] = rand() / static_cast<float>(RAND_MAX);
+		}
+		set.AddInput(fIn, 3);
+	}
+
+	cpu.CreateSOM(3, 1, 8, 8);
+	cpu.SetTrainingSet(set);
+	// same start weights and positions
+	ANN::SOMNetGPU gpu(&cpu);
+	gpu.SetSigma0(cpu.GetSigma0() );
+	gpu.SetLearningRate(cpu.GetLearningRate() );
+
+	// both draw one sample per cycle with RandInt(), the same seed gives the same samples
+	srand(11);
+	cpu.Training(200);
+	srand(11);
+	gpu.Training(200);
+
+	ANN::F2DArray f2dCPU = cpu.GetOPLayer()->ExpEdgesIn();
+	ANN::F2DArray f2dGPU = gpu.GetOPLayer()->ExpEdgesIn();
+	float fMax = 0.f;
+	for(unsigned int y = 0; y < f2dCPU.GetH(); y++) {
+		for(unsigned int x = 0; x < f2dCPU.GetW(); x++) {
+			fMax = std::max(fMax, std::fabs(f2dCPU[y][x] - f2dGPU[y][x]) );
+		}
+	}
+	if(fMax > 1.0e-4f) {
+		std::cout<<"training: weights differ by "<<fMax<<std::endl;
+		return 1;
+	}
+
+	std::cout<<"SOMNetGPU trains like SOMNet: OK"<<std::endl;
+	return 0;
+}